@@ -3,8 +3,33 @@
 #ifndef MATRIX_H
 #define MATRIX_H
 
+#include "Vector.h"
 #include <string>
 #include <iostream>
+#include <stdexcept>
+
+// Конкретный вид хранения матрицы. Используется для двойной диспетчеризации
+// бинарных операций: по виду обоих операндов выбирается ядро, работающее
+// напрямую с их хранилищем. Пользовательские наследники остаются Other
+// и обрабатываются через виртуальный доступ к элементам.
+enum class MatrixKind {
+    Dense,
+    Diagonal,
+    Block,
+    Kronecker,
+    View,
+    Sparse,
+    Banded,
+    Other
+};
+
+template <typename T> class MatrixDense;
+template <typename T> class MatrixDiagonal;
+template <typename T> class MatrixBlock;
+template <typename T> class MatrixKronecker;
+template <typename T> class MatrixView;
+template <typename T> class MatrixSparseCSR;
+template <typename T> class MatrixBanded;
 
 template <typename T = double>
 class Matrix {
@@ -14,6 +39,9 @@ public:
     virtual unsigned rows() const = 0;
     virtual unsigned cols() const = 0;
 
+    // Вид хранения для выбора специализированных ядер
+    virtual MatrixKind kind() const { return MatrixKind::Other; }
+
     // Доступ к элементам
     virtual T operator()(unsigned i, unsigned j) const = 0;
 
@@ -27,12 +55,145 @@ public:
     virtual Matrix<T>* elemDiv(const Matrix<T>& other) const = 0;
     virtual Matrix<T>* transpose() const = 0;
 
+    // Умножение на вектор: y = alpha * A * x + beta * y.
+    // При beta == 0 прежнее содержимое y не читается
+    virtual void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const {
+        checkGemv(x, y);
+        for (unsigned i = 0; i < rows(); ++i) {
+            T sum = T();
+            for (unsigned j = 0; j < cols(); ++j) {
+                sum += (*this)(i, j) * x[j];
+            }
+            y[i] = beta == T() ? alpha * sum : alpha * sum + beta * y[i];
+        }
+    }
+
+    // Умножение сразу на k векторов - столбцов X (cols() x k): Y (rows() x k) = alpha * A * X + beta * Y.
+    // Векторы обрабатываются вместе, поэтому каждый элемент A читается один раз на все k векторов
+    virtual void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const {
+        checkGemvBatch(X, Y);
+        unsigned k = X.cols();
+        for (unsigned i = 0; i < rows(); ++i) {
+            for (unsigned c = 0; c < k; ++c) {
+                Y(i, c) = beta == T() ? T() : beta * Y(i, c);
+            }
+            for (unsigned j = 0; j < cols(); ++j) {
+                T a = alpha * (*this)(i, j);
+                for (unsigned c = 0; c < k; ++c) {
+                    Y(i, c) += a * X(j, c);
+                }
+            }
+        }
+    }
+
+    // Операции с результатом в готовой матрице out того же размера, что и результат:
+    // out = alpha * op(this, other) + beta * out, при beta == 0 прежнее содержимое out
+    // не читается. Память не выделяется, поэтому в циклах out переиспользуется между шагами.
+    // Для поэлементных операций out может совпадать с операндом, для умножения
+    // и транспонирования - нет
+    virtual void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const {
+        checkInto(other, out, rows(), other.cols(), true);
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        for (unsigned i = 0; i < rows(); ++i) {
+            for (unsigned j = 0; j < other.cols(); ++j) {
+                T sum = T();
+                for (unsigned k = 0; k < cols(); ++k) {
+                    sum += (*this)(i, k) * other(k, j);
+                }
+                out(i, j) = beta == T() ? alpha * sum : alpha * sum + beta * out(i, j);
+            }
+        }
+    }
+
+    virtual void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const {
+        elementwiseInto(other, out, alpha, beta, [](T a, T b) { return a + b; });
+    }
+
+    virtual void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const {
+        elementwiseInto(other, out, alpha, beta, [](T a, T b) { return a - b; });
+    }
+
+    virtual void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const {
+        elementwiseInto(other, out, alpha, beta, [](T a, T b) { return a * b; });
+    }
+
+    virtual void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const {
+        checkInto(*this, out, cols(), rows(), true);
+        for (unsigned i = 0; i < cols(); ++i) {
+            for (unsigned j = 0; j < rows(); ++j) {
+                out(i, j) = beta == T() ? alpha * (*this)(j, i) : alpha * (*this)(j, i) + beta * out(i, j);
+            }
+        }
+    }
+
+    // Результат A * x как новый вектор
+    Vector<T> multiply(const Vector<T>& x) const {
+        Vector<T> y(rows());
+        gemv(T(1), x, T(), y);
+        return y;
+    }
+
     // Функции импорта/экспорта
     virtual void importFromFile(const std::string& filename) = 0;
     virtual void exportToFile(const std::string& filename) const = 0;
 
     // Метод для печати матрицы
     virtual void print(std::ostream& os = std::cout) const = 0;
+
+protected:
+    // Размер out должен быть m x n; distinct - out не может совпадать с операндами
+    void checkInto(const Matrix<T>& other, const Matrix<T>& out, unsigned m, unsigned n, bool distinct) const {
+        if (out.rows() != m || out.cols() != n) {
+            throw std::invalid_argument("Размеры матрицы результата не совпадают с размерами результата операции.");
+        }
+        if (distinct && (&out == this || &out == &other)) {
+            throw std::invalid_argument("Матрица результата не может совпадать с операндом.");
+        }
+    }
+
+    // out = alpha * op(this, other) + beta * out через доступ к элементам
+    template <typename Op>
+    void elementwiseInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha, T beta, Op op) const {
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        checkInto(other, out, rows(), cols(), false);
+        for (unsigned i = 0; i < rows(); ++i) {
+            for (unsigned j = 0; j < cols(); ++j) {
+                T value = alpha * op((*this)(i, j), other(i, j));
+                out(i, j) = beta == T() ? value : value + beta * out(i, j);
+            }
+        }
+    }
+
+    void checkGemv(const Vector<T>& x, const Vector<T>& y) const {
+        if (x.size() != cols()) {
+            throw std::invalid_argument("Длина вектора должна совпадать с числом столбцов матрицы.");
+        }
+        if (y.size() != rows()) {
+            throw std::invalid_argument("Длина результата должна совпадать с числом строк матрицы.");
+        }
+        if (&x == &y) {
+            throw std::invalid_argument("Результат умножения на вектор не может совпадать с аргументом.");
+        }
+    }
+
+    void checkGemvBatch(const MatrixDense<T>& X, const MatrixDense<T>& Y) const {
+        if (X.rows() != cols()) {
+            throw std::invalid_argument("Число строк матрицы векторов должно совпадать с числом столбцов матрицы.");
+        }
+        if (Y.rows() != rows() || Y.cols() != X.cols()) {
+            throw std::invalid_argument("Размеры матрицы результатов не согласованы с размерами операндов.");
+        }
+        if (&X == &Y) {
+            throw std::invalid_argument("Результат умножения на вектор не может совпадать с аргументом.");
+        }
+    }
 };
 
+// Реализация gemvBatch по умолчанию обращается к хранилищу MatrixDense
+#include "MatrixDense.h"
+
 #endif 
@@ -0,0 +1,184 @@
+#ifndef MATRIXALLOCATOR_H
+#define MATRIXALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Политика выделения памяти под хранилища матриц:
+// Aligned - каждый буфер выделяется и освобождается напрямую, с выравниванием;
+// Pooled  - освобождённые буферы остаются в пуле по размеру и отдаются
+//           следующему результату той же формы.
+enum class MatrixAllocPolicy {
+    Aligned,
+    Pooled
+};
+
+// Признак конструктора, не обнуляющего хранилище (буфер будет полностью перезаписан)
+struct MatrixUninitialized {};
+
+class MatrixMemory {
+private:
+    struct State {
+        std::mutex mutex;
+        std::unordered_map<size_t, std::vector<void*>> pool;
+        size_t pooledBytes = 0;
+        size_t poolLimit = size_t(1) << 30;
+        MatrixAllocPolicy policy = MatrixAllocPolicy::Pooled;
+        bool hugePages = false;
+    };
+
+    // Состояние не разрушается при завершении программы: хранилища статических
+    // матриц могут освобождаться позже
+    static State& state() {
+        static State* instance = new State;
+        return *instance;
+    }
+
+    static constexpr size_t hugePageSize = size_t(2) << 20;
+
+    static size_t alignmentFor(size_t bytes, bool hugePages) {
+        return hugePages && bytes >= hugePageSize ? hugePageSize : alignment;
+    }
+
+    static void* allocateAligned(size_t bytes, size_t align) {
+        size_t rounded = (bytes + align - 1) / align * align;
+#ifdef _WIN32
+        void* pointer = _aligned_malloc(rounded, align);
+#else
+        void* pointer = std::aligned_alloc(align, rounded);
+#endif
+        if (!pointer) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    static void freeAligned(void* pointer) {
+#ifdef _WIN32
+        _aligned_free(pointer);
+#else
+        std::free(pointer);
+#endif
+    }
+
+public:
+    static constexpr size_t alignment = 64;
+
+    static void setPolicy(MatrixAllocPolicy policy) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.policy = policy;
+    }
+
+    // Крупные буферы выравниваются на 2 МБ и помечаются для прозрачных huge pages
+    static void setHugePages(bool enabled) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.hugePages = enabled;
+    }
+
+    // Ограничение объёма памяти, удерживаемой пулом
+    static void setPoolLimit(size_t bytes) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.poolLimit = bytes;
+    }
+
+    // Возврат всех буферов пула системе
+    static void trim() {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (auto& entry : s.pool) {
+            for (void* pointer : entry.second) {
+                freeAligned(pointer);
+            }
+        }
+        s.pool.clear();
+        s.pooledBytes = 0;
+    }
+
+    static void* allocate(size_t bytes) {
+        if (bytes == 0) {
+            return nullptr;
+        }
+
+        State& s = state();
+        bool hugePages;
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            auto found = s.pool.find(bytes);
+            if (found != s.pool.end() && !found->second.empty()) {
+                void* pointer = found->second.back();
+                found->second.pop_back();
+                s.pooledBytes -= bytes;
+                return pointer;
+            }
+            hugePages = s.hugePages;
+        }
+
+        void* pointer = allocateAligned(bytes, alignmentFor(bytes, hugePages));
+#if defined(MADV_HUGEPAGE)
+        if (hugePages && bytes >= hugePageSize) {
+            madvise(pointer, bytes, MADV_HUGEPAGE);
+        }
+#endif
+        return pointer;
+    }
+
+    static void deallocate(void* pointer, size_t bytes) {
+        if (!pointer) {
+            return;
+        }
+
+        State& s = state();
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            if (s.policy == MatrixAllocPolicy::Pooled && s.pooledBytes + bytes <= s.poolLimit) {
+                s.pool[bytes].push_back(pointer);
+                s.pooledBytes += bytes;
+                return;
+            }
+        }
+        freeAligned(pointer);
+    }
+};
+
+// Выделение хранилища из count элементов типа T. Для типов с нетривиальным
+// конструктором или деструктором используется обычный new[]
+template <typename T>
+struct MatrixStorage {
+    static constexpr bool raw = std::is_trivially_default_constructible<T>::value && std::is_trivially_destructible<T>::value;
+
+    static T* allocate(size_t count, bool zero = true) {
+        if (!raw) {
+            return zero ? new T[count]() : new T[count];
+        }
+        T* pointer = static_cast<T*>(MatrixMemory::allocate(count * sizeof(T)));
+        if (zero && pointer) {
+            std::memset(static_cast<void*>(pointer), 0, count * sizeof(T));
+        }
+        return pointer;
+    }
+
+    static void deallocate(T* pointer, size_t count) {
+        if (!raw) {
+            delete[] pointer;
+            return;
+        }
+        MatrixMemory::deallocate(pointer, count * sizeof(T));
+    }
+};
+
+#endif
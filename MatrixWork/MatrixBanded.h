@@ -0,0 +1,876 @@
+#ifndef MATRIXBANDED_H
+#define MATRIXBANDED_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixDiagonal.h"
+#include "MatrixView.h"
+#include "ThreadPool.h"
+#include "MatrixBinary.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "MatrixSimd.h"
+#include "MatrixAllocator.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// Квадратная ленточная матрица: ненулевыми могут быть только элементы (i, j)
+// с i - lower <= j <= i + upper. Лента хранится построчно по lower + upper + 1
+// элементов на строку, так что хранилище O(n * ширина ленты); позиции ленты
+// за пределами матрицы (углы первых и последних строк) всегда нулевые.
+// MatrixDiagonal - частный случай lower = upper = 0, трёхдиагональная - lower = upper = 1
+template <typename T = double>
+class MatrixBanded : public Matrix<T> {
+private:
+    unsigned _size;
+    unsigned _lower, _upper;
+    T* data; // Строки ленты подряд
+
+    // Начало строки i, сдвинутое так, что элемент (i, j) ленты - row(i)[j]
+    T* row(unsigned i) { return data + static_cast<size_t>(i) * (width() - 1) + _lower; }
+    const T* row(unsigned i) const { return data + static_cast<size_t>(i) * (width() - 1) + _lower; }
+
+    size_t count() const { return static_cast<size_t>(_size) * width(); }
+
+    // Ширина ленты не больше самой матрицы
+    static unsigned clip(unsigned size, unsigned bandwidth) {
+        return size == 0 ? 0 : std::min(bandwidth, size - 1);
+    }
+
+    void checkSize(const Matrix<T>& other, const char* message) const {
+        if (other.rows() != _size || other.cols() != _size) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    // Ширины ленты other: для ленточной и диагональной - их лента, иначе false
+    static bool bandOf(const Matrix<T>& other, unsigned& lower, unsigned& upper) {
+        if (other.kind() == MatrixKind::Banded) {
+            lower = static_cast<const MatrixBanded<T>&>(other)._lower;
+            upper = static_cast<const MatrixBanded<T>&>(other)._upper;
+            return true;
+        }
+        lower = upper = 0;
+        return other.kind() == MatrixKind::Diagonal;
+    }
+
+    // this += factor * other для ленточного или диагонального other, лента которого
+    // лежит внутри ленты this
+    void accumulate(const Matrix<T>& other, T factor) {
+        if (other.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            for (unsigned i = 0; i < _size; ++i) {
+                row(i)[i] += factor * d[i];
+            }
+            return;
+        }
+        const MatrixBanded<T>& band = static_cast<const MatrixBanded<T>&>(other);
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(band.width()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                const T* src = band.row(i);
+                T* dst = row(i);
+                for (unsigned j = band.first(i); j < band.last(i); ++j) {
+                    dst[j] += factor * src[j];
+                }
+            }
+        });
+    }
+
+    // out(i, j) = op(this(i, j), other(i, j)) на ленте this; out - ленточная матрица с той же
+    // лентой, может совпадать с this. При одинаковой ленте other - векторное ядро по всему хранилищу
+    template <typename Op>
+    void combine(const Matrix<T>& other, MatrixBanded<T>& out, Op op) const {
+        ThreadPool& pool = ThreadPool::instance();
+        if (other.kind() == MatrixKind::Banded) {
+            const MatrixBanded<T>& band = static_cast<const MatrixBanded<T>&>(other);
+            if (band._lower == _lower && band._upper == _upper) {
+                pool.parallelFor(0, _size, ThreadPool::rowGrain(width()), [&](size_t from, size_t to) {
+                    for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                        MatrixSimd::apply(op, row(i) + first(i), band.row(i) + first(i), out.row(i) + first(i), last(i) - first(i));
+                    }
+                });
+                return;
+            }
+        }
+        size_t stride = 0;
+        const T* b = MatrixView<T>::rowStorage(other, stride);
+        pool.parallelFor(0, _size, ThreadPool::rowGrain(width()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                const T* a = row(i);
+                T* c = out.row(i);
+                for (unsigned j = first(i); j < last(i); ++j) {
+                    c[j] = op(a[j], b ? b[i * stride + j] : other(i, j));
+                }
+            }
+        });
+    }
+
+    // Плотный out = alpha * (this + sign * other) + beta * out: строки out получают вклад
+    // other, затем к ним добавляется лента this
+    void sumInto(const Matrix<T>& other, MatrixDense<T>& out, T sign, T alpha, T beta) const {
+        checkSize(other, "Размеры матриц должны совпадать для поэлементной операции.");
+        this->checkInto(other, out, _size, _size, false);
+        size_t stride = 0;
+        const T* b = &other == &out ? nullptr : MatrixView<T>::rowStorage(other, stride);
+        T* c = out.rawData();
+        T factor = alpha * sign;
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(_size), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* dst = c + static_cast<size_t>(i) * _size;
+                for (unsigned j = 0; j < _size; ++j) {
+                    T value = factor * (b ? b[i * stride + j] : other(i, j));
+                    dst[j] = beta == T() ? value : value + beta * dst[j];
+                }
+                const T* a = row(i);
+                for (unsigned j = first(i); j < last(i); ++j) {
+                    dst[j] += alpha * a[j];
+                }
+            }
+        });
+    }
+
+    // Плотный out = this + sign * other
+    MatrixDense<T>* denseSum(const Matrix<T>& other, T sign) const {
+        MatrixDense<T>* result = new MatrixDense<T>(_size, _size, MatrixUninitialized());
+        sumInto(other, *result, sign, T(1), T());
+        return result;
+    }
+
+    // Есть ли ненулевые значения в позициях ленты за пределами матрицы
+    bool hasCorners() const {
+        for (unsigned i = 0; i < _size; ++i) {
+            const T* base = data + static_cast<size_t>(i) * width();
+            unsigned before = _lower - (i - first(i));
+            unsigned after = width() - before - (last(i) - first(i));
+            for (unsigned k = 0; k < before; ++k) {
+                if (base[k] != T()) return true;
+            }
+            for (unsigned k = width() - after; k < width(); ++k) {
+                if (base[k] != T()) return true;
+            }
+        }
+        return false;
+    }
+
+    // LU-разложение с выбором ведущего элемента по столбцу (как в LAPACK gbtrf): перестановки
+    // строк расширяют верхнюю ленту U до lower + upper, поэтому строка рабочей ленты i хранит
+    // столбцы i - lower .. i + lower + upper. Множители L остаются в столбце своего шага,
+    // pivots[k] - строка, переставленная со строкой k на шаге k
+    void factorize(std::vector<T>& lu, std::vector<unsigned>& pivots) const {
+        unsigned span = 2 * _lower + _upper + 1;
+        lu.assign(static_cast<size_t>(_size) * span, T());
+        pivots.resize(_size);
+        auto at = [&](unsigned i, unsigned j) -> T& { return lu[static_cast<size_t>(i) * (span - 1) + _lower + j]; };
+        for (unsigned i = 0; i < _size; ++i) {
+            for (unsigned j = first(i); j < last(i); ++j) {
+                at(i, j) = row(i)[j];
+            }
+        }
+
+        for (unsigned k = 0; k < _size; ++k) {
+            unsigned iEnd = static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(k) + _lower + 1));
+            unsigned jEnd = static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(k) + _lower + _upper + 1));
+            unsigned p = k;
+            for (unsigned i = k + 1; i < iEnd; ++i) {
+                if (std::abs(at(i, k)) > std::abs(at(p, k))) {
+                    p = i;
+                }
+            }
+            if (at(p, k) == T()) {
+                throw std::runtime_error("Матрица вырождена: нулевой ведущий элемент.");
+            }
+            pivots[k] = p;
+            if (p != k) {
+                for (unsigned j = k; j < jEnd; ++j) {
+                    std::swap(at(k, j), at(p, j));
+                }
+            }
+            for (unsigned i = k + 1; i < iEnd; ++i) {
+                T l = at(i, k) / at(k, k);
+                at(i, k) = l;
+                if (l == T()) {
+                    continue;
+                }
+                for (unsigned j = k + 1; j < jEnd; ++j) {
+                    at(i, j) -= l * at(k, j);
+                }
+            }
+        }
+    }
+
+    // Решение по разложению factorize для столбцов [from, to) правых частей X (строки с шагом ldx),
+    // результат на месте X
+    void substitute(const std::vector<T>& lu, const std::vector<unsigned>& pivots, T* X, size_t ldx, size_t from, size_t to) const {
+        unsigned span = 2 * _lower + _upper + 1;
+        auto at = [&](unsigned i, unsigned j) { return lu[static_cast<size_t>(i) * (span - 1) + _lower + j]; };
+        for (unsigned k = 0; k < _size; ++k) {
+            T* xk = X + k * ldx;
+            if (pivots[k] != k) {
+                T* xp = X + pivots[k] * ldx;
+                for (size_t c = from; c < to; ++c) {
+                    std::swap(xk[c], xp[c]);
+                }
+            }
+            unsigned iEnd = static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(k) + _lower + 1));
+            for (unsigned i = k + 1; i < iEnd; ++i) {
+                T l = at(i, k);
+                T* xi = X + i * ldx;
+                for (size_t c = from; c < to; ++c) {
+                    xi[c] -= l * xk[c];
+                }
+            }
+        }
+        for (unsigned i = _size; i-- > 0;) {
+            T* xi = X + i * ldx;
+            unsigned jEnd = static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(i) + _lower + _upper + 1));
+            for (unsigned j = i + 1; j < jEnd; ++j) {
+                T u = at(i, j);
+                const T* xj = X + j * ldx;
+                for (size_t c = from; c < to; ++c) {
+                    xi[c] -= u * xj[c];
+                }
+            }
+            T pivot = at(i, i);
+            for (size_t c = from; c < to; ++c) {
+                xi[c] /= pivot;
+            }
+        }
+    }
+
+    // Метод прогонки подходит трёхдиагональной матрице с диагональным преобладанием:
+    // ведущие элементы тогда не обращаются в ноль и перестановки не нужны
+    bool thomasApplicable() const {
+        if (_lower != 1 || _upper != 1) {
+            return false;
+        }
+        for (unsigned i = 0; i < _size; ++i) {
+            T off = T();
+            for (unsigned j = first(i); j < last(i); ++j) {
+                if (j != i) {
+                    off += std::abs(row(i)[j]);
+                }
+            }
+            if (std::abs(row(i)[i]) < off || row(i)[i] == T()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Прямой ход прогонки, общий для всех правых частей: factors[i] - прогоночный
+    // коэффициент c'[i], inverses[i] - обратный ведущий элемент строки i.
+    // false - ведущий элемент обратился в ноль, нужен выбор ведущего элемента
+    bool thomasFactors(std::vector<T>& factors, std::vector<T>& inverses) const {
+        factors.resize(_size);
+        inverses.resize(_size);
+        for (unsigned i = 0; i < _size; ++i) {
+            const T* a = row(i);
+            T denominator = i > 0 ? a[i] - a[i - 1] * factors[i - 1] : a[i];
+            if (denominator == T()) {
+                return false;
+            }
+            inverses[i] = T(1) / denominator;
+            factors[i] = i + 1 < _size ? a[i + 1] * inverses[i] : T();
+        }
+        return true;
+    }
+
+    void thomasSolve(const std::vector<T>& factors, const std::vector<T>& inverses, T* X, size_t ldx, size_t from, size_t to) const {
+        for (unsigned i = 0; i < _size; ++i) {
+            T* xi = X + i * ldx;
+            if (i > 0) {
+                T l = row(i)[i - 1];
+                const T* prev = xi - ldx;
+                for (size_t c = from; c < to; ++c) {
+                    xi[c] = (xi[c] - l * prev[c]) * inverses[i];
+                }
+            } else {
+                for (size_t c = from; c < to; ++c) {
+                    xi[c] *= inverses[i];
+                }
+            }
+        }
+        for (unsigned i = _size; i-- > 1;) {
+            T* prev = X + (i - 1) * ldx;
+            const T* xi = X + i * ldx;
+            for (size_t c = from; c < to; ++c) {
+                prev[c] -= factors[i - 1] * xi[c];
+            }
+        }
+    }
+
+    // Решение A X = B на месте для k правых частей - столбцов X (строки с шагом ldx);
+    // разложение строится один раз, столбцы решаются параллельно
+    void solveInPlace(T* X, size_t ldx, unsigned k) const {
+        MATRIX_TRACE_SCOPE("MatrixBanded::solve", T, (_size, _size, _size, k), 2.0 * _size * (_lower + 1) * (_lower + _upper + 1) * (k + 1.0),
+                           sizeof(T) * (1.0 * count() + 2.0 * _size * k));
+        size_t grain = ThreadPool::rowGrain(static_cast<size_t>(_size) * (2 * _lower + _upper + 1));
+        std::vector<T> factors, inverses;
+        if (thomasApplicable() && thomasFactors(factors, inverses)) {
+            ThreadPool::instance().parallelFor(0, k, grain, [&](size_t from, size_t to) {
+                thomasSolve(factors, inverses, X, ldx, from, to);
+            });
+            return;
+        }
+        std::vector<T> lu;
+        std::vector<unsigned> pivots;
+        factorize(lu, pivots);
+        ThreadPool::instance().parallelFor(0, k, grain, [&](size_t from, size_t to) {
+            substitute(lu, pivots, X, ldx, from, to);
+        });
+    }
+
+public:
+    // Конструктор: нулевая матрица size x size с lower поддиагоналями и upper наддиагоналями
+    MatrixBanded(unsigned size, unsigned lower, unsigned upper)
+        : _size(size), _lower(clip(size, lower)), _upper(clip(size, upper)) {
+        data = MatrixStorage<T>::allocate(count());
+    }
+
+    // Конструктор без обнуления: для результатов, которые будут полностью перезаписаны
+    // вместе с нулевыми углами ленты
+    MatrixBanded(unsigned size, unsigned lower, unsigned upper, MatrixUninitialized)
+        : _size(size), _lower(clip(size, lower)), _upper(clip(size, upper)) {
+        data = MatrixStorage<T>::allocate(count(), false);
+    }
+
+    // Лента любой квадратной матрицы; элементы вне ленты отбрасываются
+    MatrixBanded(const Matrix<T>& matrix, unsigned lower, unsigned upper) : MatrixBanded(matrix.rows(), lower, upper) {
+        if (matrix.rows() != matrix.cols()) {
+            throw std::invalid_argument("Ленточная матрица должна быть квадратной.");
+        }
+        unsigned otherLower, otherUpper;
+        if (bandOf(matrix, otherLower, otherUpper) && otherLower <= _lower && otherUpper <= _upper) {
+            accumulate(matrix, T(1));
+            return;
+        }
+        size_t stride = 0;
+        const T* b = MatrixView<T>::rowStorage(matrix, stride);
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(width()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = first(i); j < last(i); ++j) {
+                    row(i)[j] = b ? b[i * stride + j] : matrix(i, j);
+                }
+            }
+        });
+    }
+
+    // Конструктор копирования
+    MatrixBanded(const MatrixBanded<T>& other) : _size(other._size), _lower(other._lower), _upper(other._upper) {
+        data = MatrixStorage<T>::allocate(count(), false);
+        std::copy(other.data, other.data + count(), data);
+    }
+
+    // Конструктор перемещения
+    MatrixBanded(MatrixBanded<T>&& other) noexcept : _size(other._size), _lower(other._lower), _upper(other._upper), data(other.data) {
+        other.data = nullptr;
+        other._size = other._lower = other._upper = 0;
+    }
+
+    // Деструктор
+    ~MatrixBanded() {
+        MatrixStorage<T>::deallocate(data, count());
+    }
+
+    // Оператор присваивания
+    MatrixBanded<T>& operator=(const MatrixBanded<T>& other) {
+        if (this != &other) {
+            // Хранилище того же размера переиспользуется
+            if (count() != other.count()) {
+                MatrixStorage<T>::deallocate(data, count());
+                data = MatrixStorage<T>::allocate(other.count(), false);
+            }
+            _size = other._size;
+            _lower = other._lower;
+            _upper = other._upper;
+            std::copy(other.data, other.data + count(), data);
+        }
+        return *this;
+    }
+
+    // Оператор перемещающего присваивания
+    MatrixBanded<T>& operator=(MatrixBanded<T>&& other) noexcept {
+        if (this != &other) {
+            MatrixStorage<T>::deallocate(data, count());
+            _size = other._size;
+            _lower = other._lower;
+            _upper = other._upper;
+            data = other.data;
+            other.data = nullptr;
+            other._size = other._lower = other._upper = 0;
+        }
+        return *this;
+    }
+
+    unsigned rows() const override { return _size; }
+    unsigned cols() const override { return _size; }
+
+    MatrixKind kind() const override { return MatrixKind::Banded; }
+
+    // Число поддиагоналей и наддиагоналей ленты
+    unsigned lower() const { return _lower; }
+    unsigned upper() const { return _upper; }
+    unsigned width() const { return _lower + _upper + 1; }
+
+    // Столбцы ленты в строке i: [first(i), last(i))
+    unsigned first(unsigned i) const { return i > _lower ? i - _lower : 0; }
+    unsigned last(unsigned i) const { return static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(i) + _upper + 1)); }
+
+    // Непосредственный доступ к хранилищу: rows() строк по width() элементов,
+    // элемент (i, j) ленты - rawData()[i * width() + j - i + lower()]
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+
+    // Доступ к элементам; изменять можно только элементы ленты
+    T& operator()(unsigned i, unsigned j) {
+        if (j < first(i) || j >= last(i)) {
+            throw std::out_of_range("Элемент вне ленты матрицы.");
+        }
+        return row(i)[j];
+    }
+
+    T operator()(unsigned i, unsigned j) const override {
+        if (j < first(i) || j >= last(i)) return T();
+        return row(i)[j];
+    }
+
+    // Есть ли нули среди элементов: вне ленты (если лента не покрывает матрицу) или в ней
+    bool hasZero() const {
+        if (_size > 1 && (_lower + 1 < _size || _upper + 1 < _size)) {
+            return true;
+        }
+        for (unsigned i = 0; i < _size; ++i) {
+            if (MatrixSimd::hasZero(row(i) + first(i), last(i) - first(i))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Сложение на месте выполняется на ленте this: элементы other вне неё не учитываются,
+    // как и у MatrixDiagonal
+    Matrix<T>& operator+=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::operator+=", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        combine(other, *this, MatrixSimdAdd());
+        return *this;
+    }
+
+    // Вычитание
+    Matrix<T>& operator-=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::operator-=", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        combine(other, *this, MatrixSimdSub());
+        return *this;
+    }
+
+    // Оператор сложения: с ленточной и диагональной матрицей результат ленточный
+    // с объединённой лентой, с остальными - плотный
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::operator+", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        unsigned lower, upper;
+        if (bandOf(other, lower, upper)) {
+            MatrixBanded<T>* result = new MatrixBanded<T>(_size, std::max(_lower, lower), std::max(_upper, upper));
+            result->accumulate(*this, T(1));
+            result->accumulate(other, T(1));
+            return result;
+        }
+        return denseSum(other, T(1));
+    }
+
+    // Оператор вычитания
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::operator-", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        unsigned lower, upper;
+        if (bandOf(other, lower, upper)) {
+            MatrixBanded<T>* result = new MatrixBanded<T>(_size, std::max(_lower, lower), std::max(_upper, upper));
+            result->accumulate(*this, T(1));
+            result->accumulate(other, T(-1));
+            return result;
+        }
+        return denseSum(other, T(-1));
+    }
+
+    // Умножение на вектор из Matrix<T> не скрывается перегрузкой ниже
+    using Matrix<T>::multiply;
+
+    // Произведение ленточных матриц - ленточная матрица с суммой лент: к строке результата
+    // добавляются строки ленты other с весами из строки this
+    MatrixBanded<T> multiply(const MatrixBanded<T>& other) const {
+        MATRIX_TRACE_SCOPE("MatrixBanded::multiply", T, (_size, _size, other._size, other._size), 2.0 * _size * width() * other.width(),
+                           sizeof(T) * (count() + other.count() + 1.0 * _size * (width() + other.width())));
+        if (_size != other._size) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        MatrixBanded<T> result(_size, _lower + other._lower, _upper + other._upper);
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(static_cast<size_t>(width()) * other.width()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                const T* a = row(i);
+                T* c = result.row(i);
+                for (unsigned k = first(i); k < last(i); ++k) {
+                    T weight = a[k];
+                    const T* b = other.row(k);
+                    for (unsigned j = other.first(k); j < other.last(k); ++j) {
+                        c[j] += weight * b[j];
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    // diag(d) * this и this * diag(d): масштабирование строк и столбцов ленты
+    MatrixBanded<T> scaleRows(const T* d) const {
+        MatrixBanded<T> result(*this);
+        for (unsigned i = 0; i < _size; ++i) {
+            MatrixSimd::scale(row(i) + first(i), d[i], result.row(i) + first(i), last(i) - first(i));
+        }
+        return result;
+    }
+
+    MatrixBanded<T> scaleColumns(const T* d) const {
+        MatrixBanded<T> result(*this);
+        for (unsigned i = 0; i < _size; ++i) {
+            MatrixSimd::apply(MatrixSimdMul(), row(i) + first(i), d + first(i), result.row(i) + first(i), last(i) - first(i));
+        }
+        return result;
+    }
+
+    // C = alpha * this * B + beta * C для построчно хранимых B (size x p, шаг ldb)
+    // и C (size x p, шаг ldc): строка C накапливает строки B в пределах ленты
+    void multiplyRows(const T* B, size_t ldb, unsigned p, T alpha, T beta, T* C, size_t ldc) const {
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(static_cast<size_t>(width()) * p), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* c = C + i * ldc;
+                if (beta == T()) {
+                    std::fill(c, c + p, T());
+                } else if (beta != T(1)) {
+                    MatrixSimd::scale(c, beta, c, p);
+                }
+                const T* a = row(i);
+                for (unsigned k = first(i); k < last(i); ++k) {
+                    T weight = alpha * a[k];
+                    const T* b = B + k * ldb;
+                    for (unsigned j = 0; j < p; ++j) {
+                        c[j] += weight * b[j];
+                    }
+                }
+            }
+        });
+    }
+
+    // C = alpha * A * this + beta * C для построчно хранимых A (m x size, шаг lda)
+    // и C (m x size, шаг ldc): к строке C добавляются строки ленты с весами из строки A
+    void multiplyLeft(const T* A, size_t lda, unsigned m, T alpha, T beta, T* C, size_t ldc) const {
+        ThreadPool::instance().parallelFor(0, m, ThreadPool::rowGrain(count()), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                const T* a = A + i * lda;
+                T* c = C + i * ldc;
+                if (beta == T()) {
+                    std::fill(c, c + _size, T());
+                } else if (beta != T(1)) {
+                    MatrixSimd::scale(c, beta, c, _size);
+                }
+                for (unsigned k = 0; k < _size; ++k) {
+                    T weight = alpha * a[k];
+                    if (weight == T()) {
+                        continue;
+                    }
+                    const T* b = row(k);
+                    for (unsigned j = first(k); j < last(k); ++j) {
+                        c[j] += weight * b[j];
+                    }
+                }
+            }
+        });
+    }
+
+    // Матричное умножение: с ленточной и диагональной матрицей результат ленточный
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        if (_size != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (other.kind() == MatrixKind::Banded) {
+            return new MatrixBanded<T>(multiply(static_cast<const MatrixBanded<T>&>(other)));
+        }
+        if (other.kind() == MatrixKind::Diagonal) {
+            return new MatrixBanded<T>(scaleColumns(static_cast<const MatrixDiagonal<T>&>(other).rawData()));
+        }
+        MatrixDense<T>* result = new MatrixDense<T>(_size, other.cols(), MatrixUninitialized());
+        multiplyInto(other, *result);
+        return result;
+    }
+
+    // Почленное умножение: вне ленты this результат нулевой, поэтому лента сохраняется
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::elemMult", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для почленного умножения.");
+        MatrixBanded<T>* result = new MatrixBanded<T>(_size, _lower, _upper);
+        combine(other, *result, MatrixSimdMul());
+        return result;
+    }
+
+    // Почленное деление: нули other вне ленты тоже считаются делением на ноль
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::elemDiv", T, (_size, _size, other.rows(), other.cols()), 1.0 * count(), 3.0 * sizeof(T) * count());
+        checkSize(other, "Размеры матриц должны совпадать для почленного деления.");
+        if (hasZeroElement(other)) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+        }
+        MatrixBanded<T>* result = new MatrixBanded<T>(_size, _lower, _upper);
+        combine(other, *result, MatrixSimdDiv());
+        return result;
+    }
+
+    // Транспонирование: поддиагонали и наддиагонали меняются местами
+    MatrixBanded<T>* transpose() const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::transpose", T, (_size, _size), 0, 2.0 * sizeof(T) * count());
+        MatrixBanded<T>* result = new MatrixBanded<T>(_size, _upper, _lower);
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(width()), [&](size_t from, size_t to) {
+            for (unsigned j = static_cast<unsigned>(from); j < to; ++j) {
+                T* dst = result->row(j);
+                for (unsigned i = result->first(j); i < result->last(j); ++i) {
+                    dst[i] = row(i)[j];
+                }
+            }
+        });
+        return result;
+    }
+
+    // Операции с результатом в готовой матрице (см. Matrix<T>::multiplyInto)
+
+    // Построчно хранимый other - накопление его строк в пределах ленты, иначе доступ к элементам
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::multiplyInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * count() * other.cols(),
+                           sizeof(T) * (1.0 * count() + 1.0 * other.rows() * other.cols() + 2.0 * _size * other.cols()));
+        if (_size != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, _size, other.cols(), true);
+        unsigned p = other.cols();
+        size_t stride = 0;
+        if (const T* b = MatrixView<T>::rowStorage(other, stride)) {
+            multiplyRows(b, stride, p, alpha, beta, out.rawData(), p);
+            return;
+        }
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(static_cast<size_t>(width()) * p), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* dst = c + static_cast<size_t>(i) * p;
+                for (unsigned j = 0; j < p; ++j) {
+                    dst[j] = beta == T() ? T() : beta * dst[j];
+                }
+                for (unsigned k = first(i); k < last(i); ++k) {
+                    T weight = alpha * row(i)[k];
+                    for (unsigned j = 0; j < p; ++j) {
+                        dst[j] += weight * other(k, j);
+                    }
+                }
+            }
+        });
+    }
+
+    void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::addInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size * _size, 3.0 * sizeof(T) * _size * _size);
+        sumInto(other, out, T(1), alpha, beta);
+    }
+
+    void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::subtractInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size * _size, 3.0 * sizeof(T) * _size * _size);
+        sumInto(other, out, T(-1), alpha, beta);
+    }
+
+    // Вне ленты результат нулевой: out там только масштабируется на beta
+    void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::elemMultInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * count(), sizeof(T) * (2.0 * count() + 1.0 * _size * _size));
+        checkSize(other, "Размеры матриц должны совпадать для поэлементной операции.");
+        this->checkInto(other, out, _size, _size, false);
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(_size), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* dst = c + static_cast<size_t>(i) * _size;
+                // Значения читаются до того, как out (возможно, это other) будет изменён
+                for (unsigned j = 0; j < _size; ++j) {
+                    T value = j >= first(i) && j < last(i) ? alpha * row(i)[j] * other(i, j) : T();
+                    dst[j] = beta == T() ? value : value + beta * dst[j];
+                }
+            }
+        });
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::transposeInto", T, (_size, _size), 0, sizeof(T) * (1.0 * count() + 1.0 * _size * _size));
+        this->checkInto(*this, out, _size, _size, true);
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(_size), [&](size_t from, size_t to) {
+            for (unsigned j = static_cast<unsigned>(from); j < to; ++j) {
+                T* dst = c + static_cast<size_t>(j) * _size;
+                if (beta == T()) {
+                    std::fill(dst, dst + _size, T());
+                } else {
+                    MatrixSimd::scale(dst, beta, dst, _size);
+                }
+                // Столбец j ленты: строки i, в ленту которых входит j
+                unsigned iFrom = j > _upper ? j - _upper : 0;
+                unsigned iTo = static_cast<unsigned>(std::min<size_t>(_size, static_cast<size_t>(j) + _lower + 1));
+                for (unsigned i = iFrom; i < iTo; ++i) {
+                    dst[i] += alpha * row(i)[j];
+                }
+            }
+        });
+    }
+
+    // y = alpha * A * x + beta * y: скалярное произведение строки ленты с частью x
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::gemv", T, (_size, _size, x.size(), 1), 2.0 * count(), sizeof(T) * (1.0 * count() + 3.0 * _size));
+        this->checkGemv(x, y);
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(width()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T value = alpha * MatrixSimd::dot(row(i) + first(i), xs + first(i), last(i) - first(i));
+                ys[i] = beta == T() ? value : value + beta * ys[i];
+            }
+        });
+    }
+
+    // Y = alpha * A * X + beta * Y: строка Y накапливает строки X в пределах ленты
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::gemvBatch", T, (_size, _size, X.rows(), X.cols()), 2.0 * count() * X.cols(),
+                           sizeof(T) * (1.0 * count() + 2.0 * X.rows() * X.cols()));
+        this->checkGemvBatch(X, Y);
+        multiplyRows(X.rawData(), X.cols(), X.cols(), alpha, beta, Y.rawData(), Y.cols());
+    }
+
+    // Решение A x = b за O(n * lower * (lower + upper)): трёхдиагональная матрица
+    // с диагональным преобладанием - методом прогонки, иначе ленточным LU-разложением
+    // с выбором ведущего элемента. x может совпадать с b
+    void solve(const Vector<T>& b, Vector<T>& x) const {
+        if (b.size() != _size || x.size() != _size) {
+            throw std::invalid_argument("Длина вектора должна совпадать с размером матрицы.");
+        }
+        if (&x != &b) {
+            std::copy(b.rawData(), b.rawData() + _size, x.rawData());
+        }
+        solveInPlace(x.rawData(), 1, 1);
+    }
+
+    // Решение A X = B для правых частей - столбцов B; разложение общее для всех столбцов.
+    // X может совпадать с B
+    void solveBatch(const MatrixDense<T>& B, MatrixDense<T>& X) const {
+        if (B.rows() != _size || X.rows() != _size || X.cols() != B.cols()) {
+            throw std::invalid_argument("Размеры матрицы правых частей не согласованы с размером матрицы.");
+        }
+        if (&X != &B) {
+            std::copy(B.rawData(), B.rawData() + static_cast<size_t>(_size) * B.cols(), X.rawData());
+        }
+        solveInPlace(X.rawData(), X.cols(), X.cols());
+    }
+
+    // Импорт из файла
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
+
+        if (reader.line() != "MatrixBanded") {
+            throw std::runtime_error("Файл не содержит данные MatrixBanded.");
+        }
+
+        unsigned size = reader.value<unsigned>();
+        unsigned lower = reader.value<unsigned>();
+        unsigned upper = reader.value<unsigned>();
+        if (size > 0 && (lower >= size || upper >= size)) {
+            throw std::runtime_error("Повреждённый текстовый файл MatrixBanded.");
+        }
+
+        MatrixBanded<T> loaded(size, lower, upper, MatrixUninitialized());
+        reader.values(loaded.data, loaded.count());
+        if (loaded.hasCorners()) {
+            throw std::runtime_error("Повреждённый текстовый файл MatrixBanded.");
+        }
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((_size, _size), 0, sizeof(T) * count());
+    }
+
+    // Экспорт в файл: размер и ширины ленты, затем лента построчно одной строкой,
+    // включая нулевые углы
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixBanded::exportToFile", T, (_size, _size), 0, sizeof(T) * count());
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixBanded\n" + std::to_string(_size) + " " + std::to_string(_lower) + " " + std::to_string(_upper) + "\n");
+        writer.values(data, count());
+        writer.text("\n");
+
+        writer.close();
+    }
+
+    // Импорт из двоичного файла
+    void importFromBinary(const std::string& filename) {
+        MATRIX_TRACE_SCOPE("MatrixBanded::importFromBinary", T, (0, 0), 0, 0);
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+
+        MatrixBinaryHeader header = MatrixBinary::readHeader(infile);
+        bool swap = MatrixBinary::checkHeader<T>(header, MatrixClassTag::Banded, "MatrixBanded");
+        unsigned size = static_cast<unsigned>(header.dims[0]);
+        if (size > 0 && (header.dims[1] >= size || header.dims[2] >= size)) {
+            throw std::runtime_error("Повреждённый двоичный файл MatrixBanded.");
+        }
+
+        MatrixBanded<T> loaded(size, static_cast<unsigned>(header.dims[1]), static_cast<unsigned>(header.dims[2]), MatrixUninitialized());
+        infile.seekg(static_cast<std::streamoff>(header.dataOffset));
+        if (!infile.read(reinterpret_cast<char*>(loaded.data), static_cast<std::streamsize>(loaded.count() * sizeof(T)))) {
+            throw std::runtime_error("Повреждённый двоичный файл MatrixBanded.");
+        }
+        if (swap) {
+            MatrixBinary::swapBytes(loaded.data, loaded.count());
+        }
+        if (loaded.hasCorners()) {
+            throw std::runtime_error("Повреждённый двоичный файл MatrixBanded.");
+        }
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((_size, _size), 0, sizeof(T) * count());
+    }
+
+    // Экспорт в двоичный файл
+    void exportToBinary(const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixBanded::exportToBinary", T, (_size, _size), 0, sizeof(T) * count());
+        std::ofstream outfile(filename, std::ios::binary);
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+
+        MatrixBinary::writeHeader(outfile, MatrixBinary::makeHeader<T>(MatrixClassTag::Banded, _size, _lower, _upper));
+        outfile.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count() * sizeof(T)));
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
+        }
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        for (unsigned i = 0; i < _size; ++i) {
+            for (unsigned j = 0; j < _size; ++j) {
+                if (j >= first(i) && j < last(i)) {
+                    os << row(i)[j] << "\t"; // Элемент ленты
+                } else {
+                    os << "0\t"; // Вне ленты элементы нулевые
+                }
+            }
+            os << "\n";
+        }
+    }
+
+};
+
+#endif
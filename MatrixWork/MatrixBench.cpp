@@ -0,0 +1,393 @@
+#include "MatrixDense.h"
+#include "MatrixDiagonal.h"
+#include "MatrixBlock.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Замеры всех операций MatrixDense, MatrixDiagonal и MatrixBlock.
+// Параметры командной строки (все необязательны):
+//   --sizes 256,512,1024    размеры квадратных матриц
+//   --types double,float,int
+//   --blocks 32,64          размеры блоков MatrixBlock
+//   --threads 1,4           число потоков пула
+//   --density 0.3           доля присутствующих блоков
+//   --reps 3                число повторов (берётся лучшее время)
+//   --json results.json     вывод результатов в JSON
+//   --trace trace.json      события операций в формате Chrome trace
+//                           (сборка с MATRIX_ENABLE_TRACE)
+
+struct BenchConfig {
+    std::vector<unsigned> sizes = {256, 512, 1024};
+    std::vector<std::string> types = {"double", "float", "int"};
+    std::vector<unsigned> blockSizes = {32, 64};
+    std::vector<unsigned> threads = std::thread::hardware_concurrency() > 1
+        ? std::vector<unsigned>{1, std::thread::hardware_concurrency()}
+        : std::vector<unsigned>{1};
+    double density = 0.3;
+    unsigned reps = 3;
+    std::string json;
+    std::string trace;
+};
+
+struct BenchResult {
+    std::string matrix;
+    std::string operation;
+    std::string type;
+    unsigned size;
+    unsigned blockSize;
+    unsigned threads;
+    double seconds;
+    double gflops;
+    double gbytes;
+};
+
+static std::vector<unsigned> parseList(const std::string& text) {
+    std::vector<unsigned> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(static_cast<unsigned>(std::stoul(item)));
+    }
+    return values;
+}
+
+static std::vector<std::string> parseNames(const std::string& text) {
+    std::vector<std::string> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(item);
+    }
+    return values;
+}
+
+static BenchConfig parseArguments(int argc, char** argv) {
+    BenchConfig config;
+    for (int k = 1; k + 1 < argc; k += 2) {
+        std::string key = argv[k];
+        std::string value = argv[k + 1];
+        if (key == "--sizes") {
+            config.sizes = parseList(value);
+        } else if (key == "--types") {
+            config.types = parseNames(value);
+        } else if (key == "--blocks") {
+            config.blockSizes = parseList(value);
+        } else if (key == "--threads") {
+            config.threads = parseList(value);
+        } else if (key == "--density") {
+            config.density = std::stod(value);
+        } else if (key == "--reps") {
+            config.reps = static_cast<unsigned>(std::stoul(value));
+        } else if (key == "--json") {
+            config.json = value;
+        } else if (key == "--trace") {
+            config.trace = value;
+        } else {
+            throw std::invalid_argument("Неизвестный параметр " + key);
+        }
+    }
+    return config;
+}
+
+// Лучшее время из reps запусков
+static double measure(unsigned reps, const std::function<void()>& operation) {
+    double best = 0;
+    for (unsigned r = 0; r < std::max(1u, reps); ++r) {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+class Bench {
+private:
+    BenchConfig config;
+    std::vector<BenchResult> results;
+    std::mt19937 gen{42};
+
+    template <typename T>
+    T randomValue() {
+        std::uniform_int_distribution<> dis(1, 9);
+        return static_cast<T>(dis(gen));
+    }
+
+    void record(const std::string& matrix, const std::string& operation, const std::string& type,
+                unsigned size, unsigned blockSize, unsigned threads, double seconds, double flops, double bytes) {
+        BenchResult result{matrix, operation, type, size, blockSize, threads, seconds,
+                           seconds > 0 ? flops / seconds * 1e-9 : 0, seconds > 0 ? bytes / seconds * 1e-9 : 0};
+        std::printf("%-15s %-10s %-7s n=%-6u bs=%-4u t=%-3u %10.6f s %9.3f GFLOP/s %9.3f GB/s\n",
+                    matrix.c_str(), operation.c_str(), type.c_str(), size, blockSize, threads,
+                    seconds, result.gflops, result.gbytes);
+        results.push_back(result);
+    }
+
+    // Замер операции, возвращающей новую матрицу
+    template <typename T, typename Make>
+    void timeResult(const std::string& matrix, const std::string& operation, const std::string& type,
+                    unsigned size, unsigned blockSize, unsigned threads, double flops, double bytes, Make make) {
+        double seconds = measure(config.reps, [&]() {
+            std::unique_ptr<Matrix<T>> result(make());
+        });
+        record(matrix, operation, type, size, blockSize, threads, seconds, flops, bytes);
+    }
+
+    // Замер gemv и gemvBatch на Batch векторах; flops и bytes - для одного вектора без учёта самих векторов
+    template <typename T>
+    void timeGemv(const std::string& matrix, const Matrix<T>& A, const std::string& type,
+                  unsigned size, unsigned blockSize, unsigned threads, double flops, double bytes) {
+        const unsigned Batch = 8;
+        double vectorBytes = static_cast<double>(A.rows() + A.cols()) * sizeof(T);
+
+        Vector<T> x(A.cols(), T(1)), y(A.rows());
+        double seconds = measure(config.reps, [&]() { A.gemv(T(1), x, T(), y); });
+        record(matrix, "gemv", type, size, blockSize, threads, seconds, flops, bytes + vectorBytes);
+
+        MatrixDense<T> X(A.cols(), Batch), Y(A.rows(), Batch);
+        for (unsigned i = 0; i < A.cols(); ++i) {
+            for (unsigned c = 0; c < Batch; ++c) {
+                X(i, c) = randomValue<T>();
+            }
+        }
+        seconds = measure(config.reps, [&]() { A.gemvBatch(T(1), X, T(), Y); });
+        record(matrix, "gemvBatch", type, size, blockSize, threads, seconds, Batch * flops, bytes + Batch * vectorBytes);
+    }
+
+    template <typename T>
+    void benchDense(const std::string& type, unsigned n, unsigned threads) {
+        MatrixDense<T> A(n, n), B(n, n);
+        for (unsigned i = 0; i < n; ++i) {
+            for (unsigned j = 0; j < n; ++j) {
+                A(i, j) = randomValue<T>();
+                B(i, j) = randomValue<T>();
+            }
+        }
+
+        double elements = static_cast<double>(n) * n;
+        double bytes = elements * sizeof(T);
+        const char* name = "MatrixDense";
+
+        timeResult<T>(name, "mult", type, n, 0, threads, 2.0 * elements * n, 3 * bytes, [&]() { return A * B; });
+        timeResult<T>(name, "add", type, n, 0, threads, elements, 3 * bytes, [&]() { return A + B; });
+        timeResult<T>(name, "sub", type, n, 0, threads, elements, 3 * bytes, [&]() { return A - B; });
+        timeResult<T>(name, "elemMult", type, n, 0, threads, elements, 3 * bytes, [&]() { return A.elemMult(B); });
+        timeResult<T>(name, "elemDiv", type, n, 0, threads, elements, 3 * bytes, [&]() { return A.elemDiv(B); });
+        timeResult<T>(name, "transpose", type, n, 0, threads, 0, 2 * bytes, [&]() { return A.transpose(); });
+        timeGemv<T>(name, A, type, n, 0, threads, 2 * elements, bytes);
+
+        MatrixDense<T> C(A);
+        double seconds = measure(config.reps, [&]() { C += B; });
+        record(name, "addAssign", type, n, 0, threads, seconds, elements, 3 * bytes);
+        seconds = measure(config.reps, [&]() { C -= B; });
+        record(name, "subAssign", type, n, 0, threads, seconds, elements, 3 * bytes);
+    }
+
+    template <typename T>
+    void benchDiagonal(const std::string& type, unsigned n, unsigned threads) {
+        MatrixDiagonal<T> A(n), B(n);
+        MatrixDense<T> D(n, n);
+        for (unsigned i = 0; i < n; ++i) {
+            A(i, i) = randomValue<T>();
+            B(i, i) = randomValue<T>();
+            for (unsigned j = 0; j < n; ++j) {
+                D(i, j) = randomValue<T>();
+            }
+        }
+
+        double elements = n;
+        double bytes = elements * sizeof(T);
+        double denseBytes = static_cast<double>(n) * n * sizeof(T);
+        const char* name = "MatrixDiagonal";
+
+        timeResult<T>(name, "mult", type, n, 0, threads, elements, 2 * bytes + denseBytes, [&]() { return A * B; });
+        timeResult<T>(name, "multDense", type, n, 0, threads, static_cast<double>(n) * n, 2 * denseBytes, [&]() { return A * D; });
+        timeResult<T>(name, "add", type, n, 0, threads, elements, 3 * bytes, [&]() { return A + B; });
+        timeResult<T>(name, "sub", type, n, 0, threads, elements, 3 * bytes, [&]() { return A - B; });
+        timeResult<T>(name, "elemMult", type, n, 0, threads, elements, 3 * bytes, [&]() { return A.elemMult(B); });
+        timeResult<T>(name, "elemDiv", type, n, 0, threads, elements, 3 * bytes, [&]() { return A.elemDiv(B); });
+        timeResult<T>(name, "transpose", type, n, 0, threads, 0, 2 * bytes, [&]() { return A.transpose(); });
+        timeGemv<T>(name, A, type, n, 0, threads, 2 * elements, bytes);
+
+        MatrixDiagonal<T> C(A);
+        double seconds = measure(config.reps, [&]() { C += B; });
+        record(name, "addAssign", type, n, 0, threads, seconds, elements, 3 * bytes);
+        seconds = measure(config.reps, [&]() { C -= B; });
+        record(name, "subAssign", type, n, 0, threads, seconds, elements, 3 * bytes);
+    }
+
+    template <typename T>
+    void fillBlocks(MatrixBlock<T>& matrix, unsigned grid, unsigned blockSize, double density, unsigned& present) {
+        std::bernoulli_distribution keep(density);
+        present = 0;
+        for (unsigned i = 0; i < grid; ++i) {
+            for (unsigned j = 0; j < grid; ++j) {
+                if (!keep(gen)) {
+                    continue;
+                }
+                auto block = std::make_shared<MatrixDense<T>>(blockSize, blockSize);
+                for (unsigned m = 0; m < blockSize; ++m) {
+                    for (unsigned k = 0; k < blockSize; ++k) {
+                        (*block)(m, k) = randomValue<T>();
+                    }
+                }
+                matrix.setBlock(i, j, block);
+                ++present;
+            }
+        }
+    }
+
+    template <typename T>
+    void benchBlock(const std::string& type, unsigned n, unsigned blockSize, unsigned threads) {
+        unsigned grid = n / blockSize;
+        if (grid == 0) {
+            return;
+        }
+        unsigned size = grid * blockSize;
+
+        MatrixBlock<T> A(grid, grid, blockSize, blockSize), B(grid, grid, blockSize, blockSize);
+        unsigned presentA, presentB;
+        fillBlocks(A, grid, blockSize, config.density, presentA);
+        fillBlocks(B, grid, blockSize, config.density, presentB);
+
+        // Число пар присутствующих блоков A(i, k), B(k, j)
+        double pairs = 0;
+        for (unsigned i = 0; i < grid; ++i) {
+            for (unsigned j = 0; j < grid; ++j) {
+                for (unsigned k = 0; k < grid; ++k) {
+                    if (A.block(i, k) && B.block(k, j)) {
+                        pairs += 1;
+                    }
+                }
+            }
+        }
+
+        double blockElements = static_cast<double>(blockSize) * blockSize;
+        double elements = blockElements * (presentA + presentB);
+        double bytes = elements * sizeof(T);
+        const char* name = "MatrixBlock";
+
+        timeResult<T>(name, "mult", type, size, blockSize, threads, 2.0 * blockElements * blockSize * pairs, 2 * bytes, [&]() { return A * B; });
+        timeResult<T>(name, "add", type, size, blockSize, threads, elements, 2 * bytes, [&]() { return A + B; });
+        timeResult<T>(name, "sub", type, size, blockSize, threads, elements, 2 * bytes, [&]() { return A - B; });
+        timeResult<T>(name, "elemMult", type, size, blockSize, threads, elements, 2 * bytes, [&]() { return A.elemMult(B); });
+        timeResult<T>(name, "transpose", type, size, blockSize, threads, 0, 2 * blockElements * presentA * sizeof(T), [&]() { return A.transpose(); });
+        timeGemv<T>(name, A, type, size, blockSize, threads, 2 * blockElements * presentA, blockElements * presentA * sizeof(T));
+
+        MatrixBlock<T> C(A);
+        double seconds = measure(config.reps, [&]() { C += B; });
+        record(name, "addAssign", type, size, blockSize, threads, seconds, elements, 2 * bytes);
+        seconds = measure(config.reps, [&]() { C -= B; });
+        record(name, "subAssign", type, size, blockSize, threads, seconds, elements, 2 * bytes);
+
+        // Делитель без нулей: все блоки присутствуют
+        MatrixBlock<T> full(grid, grid, blockSize, blockSize);
+        unsigned presentFull;
+        fillBlocks(full, grid, blockSize, 1.0, presentFull);
+        double fullBytes = blockElements * (presentA + presentFull) * sizeof(T);
+        timeResult<T>(name, "elemDiv", type, size, blockSize, threads, blockElements * presentA, fullBytes, [&]() { return A.elemDiv(full); });
+    }
+
+    template <typename T>
+    void benchType(const std::string& type) {
+        for (unsigned threads : config.threads) {
+            ThreadPool::setThreadCount(threads);
+            for (unsigned n : config.sizes) {
+                benchDense<T>(type, n, threads);
+                benchDiagonal<T>(type, n, threads);
+                for (unsigned blockSize : config.blockSizes) {
+                    benchBlock<T>(type, n, blockSize, threads);
+                }
+            }
+        }
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+public:
+    explicit Bench(const BenchConfig& benchConfig) : config(benchConfig) {}
+
+    void run() {
+        for (const std::string& type : config.types) {
+            if (type == "double") {
+                benchType<double>(type);
+            } else if (type == "float") {
+                benchType<float>(type);
+            } else if (type == "int") {
+                benchType<int>(type);
+            } else {
+                throw std::invalid_argument("Неподдерживаемый тип элементов " + type);
+            }
+        }
+    }
+
+    void exportJson(const std::string& filename) const {
+        std::ofstream outfile(filename);
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл " + filename + " для записи.");
+        }
+
+        outfile << "{\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency()
+                << ",\n  \"reps\": " << config.reps << ",\n  \"density\": " << config.density
+                << ",\n  \"results\": [\n";
+        for (size_t k = 0; k < results.size(); ++k) {
+            const BenchResult& r = results[k];
+            outfile << "    {\"matrix\": \"" << escape(r.matrix) << "\", \"operation\": \"" << escape(r.operation)
+                    << "\", \"type\": \"" << escape(r.type) << "\", \"size\": " << r.size
+                    << ", \"block_size\": " << r.blockSize << ", \"threads\": " << r.threads
+                    << ", \"seconds\": " << r.seconds << ", \"gflops\": " << r.gflops
+                    << ", \"gbytes_per_second\": " << r.gbytes << "}"
+                    << (k + 1 < results.size() ? ",\n" : "\n");
+        }
+        outfile << "  ]\n}\n";
+    }
+};
+
+int main(int argc, char** argv) {
+    try {
+        BenchConfig config = parseArguments(argc, argv);
+#ifndef MATRIX_ENABLE_TRACE
+        if (!config.trace.empty()) {
+            throw std::invalid_argument("Трассировка недоступна: сборка без MATRIX_ENABLE_TRACE");
+        }
+#endif
+        Bench bench(config);
+        bench.run();
+        if (!config.json.empty()) {
+            bench.exportJson(config.json);
+            std::cout << "Результаты сохранены в " << config.json << "\n";
+        }
+#ifdef MATRIX_ENABLE_TRACE
+        if (!config.trace.empty()) {
+            MatrixTrace::dump(config.trace);
+            std::cout << "Трасса сохранена в " << config.trace << "\n";
+        }
+#endif
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
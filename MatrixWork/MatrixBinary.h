@@ -0,0 +1,229 @@
+#ifndef MATRIXBINARY_H
+#define MATRIXBINARY_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Двоичный формат матриц:
+// [заголовок 64 байта][выравнивание до dataOffset][данные]
+// Dense    - dims = {m, n}, данные построчно;
+// Diagonal - dims = {size}, диагональные элементы;
+// Block    - dims = {blockRows, blockCols, blockSizeM, blockSizeN}, данные -
+//            байт присутствия для каждого блока, выравнивание, затем присутствующие
+//            блоки построчно в порядке обхода по блочным строкам.
+// BlockStore - dims как у Block, данные - таблица смещений блоков от начала файла
+//            (uint64 на блок построчно, 0 - нулевой блок), выравнивание, затем блоки
+//            в произвольном порядке, каждый с выравниванием (см. MatrixBlockStore).
+// Banded   - dims = {size, lower, upper}, лента построчно по lower + upper + 1
+//            элементов (см. MatrixBanded).
+enum class MatrixClassTag : uint8_t {
+    Dense = 1,
+    Diagonal = 2,
+    Block = 3,
+    BlockStore = 4,
+    Banded = 5
+};
+
+enum class MatrixEndianness : uint8_t {
+    Little = 1,
+    Big = 2
+};
+
+struct MatrixBinaryHeader {
+    char magic[4];
+    uint16_t version;
+    uint8_t classTag;
+    uint8_t elementType;
+    uint8_t elementSize;
+    uint8_t endianness;
+    uint16_t alignment;
+    uint32_t reserved;
+    uint64_t dims[4];
+    uint64_t dataOffset;
+    uint64_t reserved2;
+};
+
+static_assert(sizeof(MatrixBinaryHeader) == 64, "Заголовок двоичного формата должен занимать 64 байта.");
+
+// Коды типов элементов
+template <typename T> struct MatrixElementCode { static constexpr uint8_t value = 0; };
+template <> struct MatrixElementCode<int8_t> { static constexpr uint8_t value = 1; };
+template <> struct MatrixElementCode<uint8_t> { static constexpr uint8_t value = 2; };
+template <> struct MatrixElementCode<int16_t> { static constexpr uint8_t value = 3; };
+template <> struct MatrixElementCode<uint16_t> { static constexpr uint8_t value = 4; };
+template <> struct MatrixElementCode<int32_t> { static constexpr uint8_t value = 5; };
+template <> struct MatrixElementCode<uint32_t> { static constexpr uint8_t value = 6; };
+template <> struct MatrixElementCode<int64_t> { static constexpr uint8_t value = 7; };
+template <> struct MatrixElementCode<uint64_t> { static constexpr uint8_t value = 8; };
+template <> struct MatrixElementCode<float> { static constexpr uint8_t value = 9; };
+template <> struct MatrixElementCode<double> { static constexpr uint8_t value = 10; };
+
+class MatrixBinary {
+public:
+    static constexpr uint16_t version = 1;
+    static constexpr uint16_t alignment = 64;
+
+    static MatrixEndianness hostEndianness() {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1 ? MatrixEndianness::Little : MatrixEndianness::Big;
+    }
+
+    static uint64_t alignUp(uint64_t value) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template <typename T>
+    static MatrixBinaryHeader makeHeader(MatrixClassTag tag, uint64_t d0, uint64_t d1 = 0, uint64_t d2 = 0, uint64_t d3 = 0) {
+        static_assert(std::is_trivially_copyable<T>::value, "Двоичный формат поддерживает только тривиально копируемые элементы.");
+
+        MatrixBinaryHeader header = {};
+        std::memcpy(header.magic, "MTXB", 4);
+        header.version = version;
+        header.classTag = static_cast<uint8_t>(tag);
+        header.elementType = MatrixElementCode<T>::value;
+        header.elementSize = static_cast<uint8_t>(sizeof(T));
+        header.endianness = static_cast<uint8_t>(hostEndianness());
+        header.alignment = alignment;
+        header.dims[0] = d0;
+        header.dims[1] = d1;
+        header.dims[2] = d2;
+        header.dims[3] = d3;
+        header.dataOffset = alignUp(sizeof(MatrixBinaryHeader));
+        return header;
+    }
+
+    // Проверка заголовка; возвращает true, если порядок байтов файла отличается от текущего
+    template <typename T>
+    static bool checkHeader(const MatrixBinaryHeader& header, MatrixClassTag tag, const std::string& className) {
+        if (std::memcmp(header.magic, "MTXB", 4) != 0) {
+            throw std::runtime_error("Файл не является двоичным файлом матрицы.");
+        }
+        if (header.version != version) {
+            throw std::runtime_error("Неподдерживаемая версия двоичного формата матрицы.");
+        }
+        if (header.classTag != static_cast<uint8_t>(tag)) {
+            throw std::runtime_error("Файл не содержит данные " + className + ".");
+        }
+        if (header.elementType != MatrixElementCode<T>::value || header.elementSize != sizeof(T)) {
+            throw std::runtime_error("Тип элементов в файле не совпадает с типом матрицы.");
+        }
+        if (header.dataOffset < sizeof(MatrixBinaryHeader)) {
+            throw std::runtime_error("Повреждённый заголовок двоичного файла матрицы.");
+        }
+        return header.endianness != static_cast<uint8_t>(hostEndianness());
+    }
+
+    template <typename T>
+    static void swapBytes(T* values, size_t count) {
+        for (size_t k = 0; k < count; ++k) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(values + k);
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+    }
+
+    static void writeHeader(std::ofstream& outfile, const MatrixBinaryHeader& header) {
+        outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        static const char padding[alignment] = {};
+        outfile.write(padding, static_cast<std::streamsize>(header.dataOffset - sizeof(header)));
+    }
+
+    static MatrixBinaryHeader readHeader(std::ifstream& infile) {
+        MatrixBinaryHeader header;
+        if (!infile.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw std::runtime_error("Не удалось прочитать заголовок двоичного файла матрицы.");
+        }
+        return header;
+    }
+};
+
+// Файл, отображённый в память с копированием при записи: страницы подгружаются
+// по первому обращению, изменения не попадают в файл
+class MappedFile {
+private:
+    void* _address = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+        _file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(_file, &size);
+        _size = static_cast<size_t>(size.QuadPart);
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (!_mapping) {
+            CloseHandle(_file);
+            throw std::runtime_error("Не удалось отобразить файл в память.");
+        }
+        _address = MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0);
+        if (!_address) {
+            CloseHandle(_mapping);
+            CloseHandle(_file);
+            throw std::runtime_error("Не удалось отобразить файл в память.");
+        }
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw std::runtime_error("Не удалось определить размер файла.");
+        }
+        _size = static_cast<size_t>(info.st_size);
+        if (_size > 0) {
+            _address = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (_address == MAP_FAILED || _size == 0) {
+            _address = nullptr;
+            throw std::runtime_error("Не удалось отобразить файл в память.");
+        }
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        UnmapViewOfFile(_address);
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+#else
+        munmap(_address, _size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* data() const { return static_cast<char*>(_address); }
+    size_t size() const { return _size; }
+};
+
+#endif
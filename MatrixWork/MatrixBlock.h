@@ -5,6 +5,14 @@
 
 #include "Matrix.h"
 #include "MatrixDense.h"
+#include "MatrixGemm.h"
+#include "ThreadPool.h"
+#include "TaskScheduler.h"
+#include "MatrixBinary.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "MatrixSimd.h"
+#include "MatrixFixed.h"
 #include <vector>
 #include <memory>
 #include <fstream>
@@ -18,36 +26,118 @@ private:
     unsigned _blockSizeM, _blockSizeN;       // Размер каждого блока
     std::vector<std::vector<std::shared_ptr<MatrixDense<T>>>> blocks;
 
+    // Компактный режим: все присутствующие блоки лежат в одном выровненном буфере
+    // (blocks - представления MatrixDense над ним), blockIndex[i * _blockCols + j] -
+    // данные блока или nullptr. Сбрасывается, когда меняется набор блоков
+    bool _compact = false;
+    std::vector<T*> blockIndex;
+
+    // Для размеров блоков - степеней двойки номер блока и позиция в нём
+    // вычисляются сдвигами и масками вместо деления
+    bool _powerOfTwo = false;
+    unsigned _shiftM = 0, _shiftN = 0;
+
+    static bool log2Exact(unsigned n, unsigned& shift) {
+        if (n == 0 || (n & (n - 1)) != 0) {
+            return false;
+        }
+        for (shift = 0; (1u << shift) != n; ++shift) {
+        }
+        return true;
+    }
+
+    void updateShifts() {
+        _powerOfTwo = log2Exact(_blockSizeM, _shiftM) && log2Exact(_blockSizeN, _shiftN);
+    }
+
+    void locate(unsigned i, unsigned j, unsigned& blockRow, unsigned& blockCol, unsigned& localRow, unsigned& localCol) const {
+        if (_powerOfTwo) {
+            blockRow = i >> _shiftM;
+            blockCol = j >> _shiftN;
+            localRow = i & (_blockSizeM - 1);
+            localCol = j & (_blockSizeN - 1);
+        } else {
+            blockRow = i / _blockSizeM;
+            blockCol = j / _blockSizeN;
+            localRow = i % _blockSizeM;
+            localCol = j % _blockSizeN;
+        }
+    }
+
+    size_t blockElements() const {
+        return static_cast<size_t>(_blockSizeM) * _blockSizeN;
+    }
+
+    void invalidateIndex() {
+        _compact = false;
+        blockIndex.clear();
+    }
+
+    // Новые блоки с номерами из list (по возрастанию) подряд в одном общем буфере;
+    // прочие блоки должны отсутствовать. Матрица переходит в компактный режим
+    void allocateArena(const std::vector<size_t>& list, bool zero) {
+        size_t count = blockElements();
+        size_t total = list.size() * count;
+        blockIndex.assign(static_cast<size_t>(_blockRows) * _blockCols, nullptr);
+        _compact = true;
+        if (total == 0) {
+            return;
+        }
+        T* arena = MatrixStorage<T>::allocate(total, zero);
+        std::shared_ptr<void> owner(static_cast<void*>(arena), [total](void* values) {
+            MatrixStorage<T>::deallocate(static_cast<T*>(values), total);
+        });
+        for (size_t k = 0; k < list.size(); ++k) {
+            T* values = arena + k * count;
+            blocks[list[k] / _blockCols][list[k] % _blockCols] =
+                std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN, values, owner);
+            blockIndex[list[k]] = values;
+        }
+    }
+
+    // Копирование при записи: копии матрицы разделяют блоки, общий блок перед
+    // первой записью заменяется собственной копией. Возвращает true, если блок скопирован
+    // (компактный режим после этого нужно снять)
+    bool unshare(unsigned blockRow, unsigned blockCol) {
+        std::shared_ptr<MatrixDense<T>>& block = blocks[blockRow][blockCol];
+        if (!block || block.use_count() == 1) {
+            return false;
+        }
+        block = std::make_shared<MatrixDense<T>>(*block);
+        return true;
+    }
+
+    bool isShared(unsigned blockRow, unsigned blockCol) const {
+        return blocks[blockRow][blockCol] && blocks[blockRow][blockCol].use_count() > 1;
+    }
+
 public:
     // Конструктор
     MatrixBlock(unsigned blockRows, unsigned blockCols, unsigned blockSizeM, unsigned blockSizeN)
         : _blockRows(blockRows), _blockCols(blockCols), _blockSizeM(blockSizeM), _blockSizeN(blockSizeN) {
         blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
+        updateShifts();
     }
 
-    // Конструктор копирования
+    // Конструктор копирования: блоки общие с other до первой записи (см. unshare)
     MatrixBlock(const MatrixBlock<T>& other)
         : _blockRows(other._blockRows), _blockCols(other._blockCols),
-          _blockSizeM(other._blockSizeM), _blockSizeN(other._blockSizeN) {
-        blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
-        for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                if (other.blocks[i][j]) {
-                    blocks[i][j] = std::make_shared<MatrixDense<T>>(*other.blocks[i][j]);
-                }
-            }
-        }
+          _blockSizeM(other._blockSizeM), _blockSizeN(other._blockSizeN),
+          blocks(other.blocks), _compact(other._compact), blockIndex(other.blockIndex) {
+        updateShifts();
     }
 
     // Конструктор перемещения
     MatrixBlock(MatrixBlock<T>&& other) noexcept
         : _blockRows(other._blockRows), _blockCols(other._blockCols),
           _blockSizeM(other._blockSizeM), _blockSizeN(other._blockSizeN),
-          blocks(std::move(other.blocks)) {
+          blocks(std::move(other.blocks)), _compact(other._compact), blockIndex(std::move(other.blockIndex)) {
+        updateShifts();
         other._blockRows = 0;
         other._blockCols = 0;
         other._blockSizeM = 0;
         other._blockSizeN = 0;
+        other.invalidateIndex();
     }
 
     // Деструктор
@@ -62,15 +152,10 @@ public:
             _blockCols = other._blockCols;
             _blockSizeM = other._blockSizeM;
             _blockSizeN = other._blockSizeN;
-
-            blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
-            for (unsigned i = 0; i < _blockRows; ++i) {
-                for (unsigned j = 0; j < _blockCols; ++j) {
-                    if (other.blocks[i][j]) {
-                        blocks[i][j] = std::make_shared<MatrixDense<T>>(*other.blocks[i][j]);
-                    }
-                }
-            }
+            blocks = other.blocks;
+            _compact = other._compact;
+            blockIndex = other.blockIndex;
+            updateShifts();
         }
         return *this;
     }
@@ -83,7 +168,11 @@ public:
             _blockSizeM = other._blockSizeM;
             _blockSizeN = other._blockSizeN;
             blocks = std::move(other.blocks);
+            _compact = other._compact;
+            blockIndex = std::move(other.blockIndex);
+            updateShifts();
 
+            other.invalidateIndex();
             other._blockRows = 0;
             other._blockCols = 0;
             other._blockSizeM = 0;
@@ -95,21 +184,128 @@ public:
     unsigned rows() const override { return _blockRows * _blockSizeM; }
     unsigned cols() const override { return _blockCols * _blockSizeN; }
 
+    MatrixKind kind() const override { return MatrixKind::Block; }
+
+    unsigned blockRows() const { return _blockRows; }
+    unsigned blockCols() const { return _blockCols; }
+    unsigned blockSizeM() const { return _blockSizeM; }
+    unsigned blockSizeN() const { return _blockSizeN; }
+
+    // Блок (blockRow, blockCol) или nullptr для нулевого блока
+    const MatrixDense<T>* block(unsigned blockRow, unsigned blockCol) const {
+        return blocks[blockRow][blockCol].get();
+    }
+
+    // Есть ли нулевые элементы (отсутствующий блок целиком нулевой)
+    bool hasZero() const {
+        for (unsigned i = 0; i < _blockRows; ++i) {
+            for (unsigned j = 0; j < _blockCols; ++j) {
+                if (!blocks[i][j]) {
+                    return true;
+                }
+                if (MatrixSimd::hasZero(blocks[i][j]->rawData(), static_cast<size_t>(_blockSizeM) * _blockSizeN)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
     // Установка блока
     void setBlock(unsigned blockRow, unsigned blockCol, std::shared_ptr<MatrixDense<T>> block) {
         if (block->rows() != _blockSizeM || block->cols() != _blockSizeN) {
             throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
         }
         blocks[blockRow][blockCol] = block;
+        if (_compact) {
+            invalidateIndex();
+        }
+    }
+
+    // Установка блока из представления: если элементы представления лежат подряд
+    // (например, полоса строк плотной матрицы шириной в блок), блок использует память
+    // источника без копирования - источник должен жить дольше блока, а запись в блок
+    // изменяет источник; иначе элементы копируются в новый блок
+    void setBlock(unsigned blockRow, unsigned blockCol, MatrixView<T> view) {
+        if (view.rows() != _blockSizeM || view.cols() != _blockSizeN) {
+            throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
+        }
+        std::shared_ptr<MatrixDense<T>> block;
+        if (view.isContiguous()) {
+            T* values = view.rawData();
+            block = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN, values, std::shared_ptr<void>(values, [](void*) {}));
+        } else {
+            block = std::shared_ptr<MatrixDense<T>>(view.materialize());
+        }
+        setBlock(blockRow, blockCol, std::move(block));
+    }
+
+    // Установка блока из матрицы фиксированного размера: присутствующий блок, не общий
+    // с копиями матрицы, перезаписывается на месте (компактный режим сохраняется)
+    template <unsigned M, unsigned N>
+    void setBlock(unsigned blockRow, unsigned blockCol, const MatrixFixed<T, M, N>& block) {
+        if (M != _blockSizeM || N != _blockSizeN) {
+            throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
+        }
+        if (!blocks[blockRow][blockCol]) {
+            if (_compact) {
+                invalidateIndex();
+            }
+            blocks[blockRow][blockCol] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN, MatrixUninitialized());
+        } else if (unshare(blockRow, blockCol) && _compact) {
+            invalidateIndex();
+        }
+        std::copy(block.rawData(), block.rawData() + M * N, blocks[blockRow][blockCol]->rawData());
+    }
+
+    // Копия блока в матрицу фиксированного размера (нулевая для отсутствующего блока)
+    template <unsigned M, unsigned N>
+    MatrixFixed<T, M, N> fixedBlock(unsigned blockRow, unsigned blockCol) const {
+        if (M != _blockSizeM || N != _blockSizeN) {
+            throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
+        }
+        MatrixFixed<T, M, N> result;
+        if (const MatrixDense<T>* source = blocks[blockRow][blockCol].get()) {
+            std::copy(source->rawData(), source->rawData() + M * N, result.rawData());
+        }
+        return result;
+    }
+
+    // Компактный режим: все блоки в одном общем буфере (см. compact())
+    bool isCompact() const { return _compact; }
+
+    // Перенос присутствующих блоков в один выровненный буфер в порядке номеров
+    // i * _blockCols + j: обход блоков становится последовательным чтением памяти,
+    // доступ к элементу - одной выборкой из таблицы блоков. Результаты блочных
+    // операций уже компактны; новые блоки (setBlock, setElement) и блоки, скопированные
+    // при записи, снимают режим
+    void compact() {
+        if (_compact) {
+            return;
+        }
+        std::vector<size_t> list = blockList([&](unsigned i, unsigned j) { return blocks[i][j] != nullptr; });
+        std::vector<std::shared_ptr<MatrixDense<T>>> sources(list.size());
+        for (size_t k = 0; k < list.size(); ++k) {
+            sources[k] = std::move(blocks[list[k] / _blockCols][list[k] % _blockCols]);
+        }
+        allocateArena(list, false);
+        size_t count = blockElements();
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t k = from; k < to; ++k) {
+                std::copy(sources[k]->rawData(), sources[k]->rawData() + count, blockIndex[list[k]]);
+            }
+        });
     }
 
     // Доступ к элементам
     T operator()(unsigned i, unsigned j) const override {
-        unsigned blockRow = i / _blockSizeM;
-        unsigned blockCol = j / _blockSizeN;
-        unsigned localRow = i % _blockSizeM;
-        unsigned localCol = j % _blockSizeN;
+        unsigned blockRow, blockCol, localRow, localCol;
+        locate(i, j, blockRow, blockCol, localRow, localCol);
 
+        if (_compact) {
+            const T* values = blockIndex[static_cast<size_t>(blockRow) * _blockCols + blockCol];
+            return values ? values[static_cast<size_t>(localRow) * _blockSizeN + localCol] : T();
+        }
         if (blocks[blockRow][blockCol]) {
             return (*blocks[blockRow][blockCol])(localRow, localCol);
         } else {
@@ -119,57 +315,513 @@ public:
 
     // Помощник для установки элемента
     void setElement(unsigned i, unsigned j, T value) {
-        unsigned blockRow = i / _blockSizeM;
-        unsigned blockCol = j / _blockSizeN;
-        unsigned localRow = i % _blockSizeM;
-        unsigned localCol = j % _blockSizeN;
+        unsigned blockRow, blockCol, localRow, localCol;
+        locate(i, j, blockRow, blockCol, localRow, localCol);
 
         if (!blocks[blockRow][blockCol]) {
+            if (_compact) {
+                invalidateIndex();
+            }
             blocks[blockRow][blockCol] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+        } else if (unshare(blockRow, blockCol) && _compact) {
+            invalidateIndex();
         }
         (*blocks[blockRow][blockCol])(localRow, localCol) = value;
     }
 
+private:
+    // Число блоков в задаче планировщика: не меньше 32768 элементов на задачу
+    size_t blockGrain() const {
+        return std::max<size_t>(1, 32768 / (static_cast<size_t>(_blockSizeM) * _blockSizeN));
+    }
+
+    // Номера i * _blockCols + j присутствующих блоков, для которых filter(i, j) истинно.
+    // Работа распределяется по этому списку, а не по блочным строкам: при неравномерной
+    // заполненности строк равные отрезки списка требуют равного времени
+    template <typename Filter>
+    std::vector<size_t> blockList(Filter filter) const {
+        std::vector<size_t> list;
+        for (unsigned i = 0; i < _blockRows; ++i) {
+            for (unsigned j = 0; j < _blockCols; ++j) {
+                if (filter(i, j)) {
+                    list.push_back(static_cast<size_t>(i) * _blockCols + j);
+                }
+            }
+        }
+        return list;
+    }
+
+    // Можно ли адресовать участки other, совпадающие с блоками, напрямую в хранилище
+    bool hasDirectRegions(const Matrix<T>& other) const {
+        size_t stride;
+        if (MatrixView<T>::rowStorage(other, stride)) {
+            return true;
+        }
+        if (other.kind() == MatrixKind::Block) {
+            const MatrixBlock<T>& block = static_cast<const MatrixBlock<T>&>(other);
+            return block._blockSizeM == _blockSizeM && block._blockSizeN == _blockSizeN;
+        }
+        return false;
+    }
+
+    // Участок other, совпадающий с блоком (blockRow, blockCol): первый элемент
+    // (nullptr, если участок нулевой) и шаг между строками
+    const T* regionOf(const Matrix<T>& other, unsigned blockRow, unsigned blockCol, size_t& stride) const {
+        if (const T* values = MatrixView<T>::rowStorage(other, stride)) {
+            return values + static_cast<size_t>(blockRow) * _blockSizeM * stride + static_cast<size_t>(blockCol) * _blockSizeN;
+        }
+        const MatrixDense<T>* block = static_cast<const MatrixBlock<T>&>(other).block(blockRow, blockCol);
+        stride = _blockSizeN;
+        return block ? block->rawData() : nullptr;
+    }
+
+    // this = op(this, other) при op(x, 0) == x: затрагиваются только ненулевые участки other
+    template <typename Op>
+    void accumulate(const Matrix<T>& other, Op op) {
+        if (other.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            for (unsigned i = 0; i < rows(); ++i) {
+                if (d[i] != T()) {
+                    setElement(i, i, op((*this)(i, i), d[i]));
+                }
+            }
+            return;
+        }
+
+        // Разбиение по блочным строкам: каждый поток создает блоки только в своей строке.
+        // Новые блоки снимают компактный режим, поэтому он снимается до начала работы.
+        // Нулевые элементы other пропускаются, чтобы не создавать пустые блоки
+        if (other.kind() == MatrixKind::Sparse) {
+            const MatrixSparseCSR<T>& sparse = static_cast<const MatrixSparseCSR<T>&>(other);
+            const size_t* start = sparse.rowStart();
+            const unsigned* columns = sparse.columnIndex();
+            const T* values = sparse.values();
+            invalidateIndex();
+            ThreadPool::instance().parallelFor(0, _blockRows, ThreadPool::rowGrain(sparse.nonZeros() / std::max(1u, _blockRows) + 1), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from) * _blockSizeM; i < to * _blockSizeM; ++i) {
+                    for (size_t k = start[i]; k < start[i + 1]; ++k) {
+                        if (values[k] != T()) {
+                            setElement(i, columns[k], op((*this)(i, columns[k]), values[k]));
+                        }
+                    }
+                }
+            });
+            return;
+        }
+        if (other.kind() == MatrixKind::Banded) {
+            const MatrixBanded<T>& banded = static_cast<const MatrixBanded<T>&>(other);
+            unsigned lower = banded.lower();
+            unsigned upper = banded.upper();
+            invalidateIndex();
+            ThreadPool::instance().parallelFor(0, _blockRows, ThreadPool::rowGrain(static_cast<size_t>(_blockSizeM) * (lower + upper + 1)), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from) * _blockSizeM; i < to * _blockSizeM; ++i) {
+                    // Строка ленты: элемент (i, j) лежит в row[j]
+                    const T* row = banded.rawData() + static_cast<size_t>(i) * (lower + upper) + lower;
+                    unsigned last = std::min(cols(), i + upper + 1);
+                    for (unsigned j = i > lower ? i - lower : 0; j < last; ++j) {
+                        if (row[j] != T()) {
+                            setElement(i, j, op((*this)(i, j), row[j]));
+                        }
+                    }
+                }
+            });
+            return;
+        }
+        if (!hasDirectRegions(other)) {
+            invalidateIndex();
+            ThreadPool::instance().parallelFor(0, _blockRows, ThreadPool::rowGrain(static_cast<size_t>(_blockSizeM) * cols()), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from) * _blockSizeM; i < to * _blockSizeM; ++i) {
+                    for (unsigned j = 0; j < cols(); ++j) {
+                        T value = other(i, j);
+                        if (value != T()) {
+                            setElement(i, j, op((*this)(i, j), value));
+                        }
+                    }
+                }
+            });
+            return;
+        }
+
+        std::vector<size_t> list = blockList([&](unsigned bi, unsigned bj) {
+            size_t stride;
+            return regionOf(other, bi, bj, stride) != nullptr;
+        });
+        // Отсутствующие и общие с копиями блоки заменяются новыми
+        for (size_t key : list) {
+            if (!blocks[key / _blockCols][key % _blockCols] || isShared(key / _blockCols, key % _blockCols)) {
+                invalidateIndex();
+                break;
+            }
+        }
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned bi = static_cast<unsigned>(list[index] / _blockCols);
+                unsigned bj = static_cast<unsigned>(list[index] % _blockCols);
+                size_t stride;
+                const T* src = regionOf(other, bi, bj, stride);
+                // Общий блок не копируется отдельно: результат пишется сразу в новый блок
+                std::shared_ptr<MatrixDense<T>> shared;
+                if (!blocks[bi][bj]) {
+                    blocks[bi][bj] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+                } else if (isShared(bi, bj)) {
+                    shared = std::move(blocks[bi][bj]);
+                    blocks[bi][bj] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN, MatrixUninitialized());
+                }
+                T* dst = blocks[bi][bj]->rawData();
+                const T* own = shared ? shared->rawData() : dst;
+                // Участок блочной матрицы лежит подряд - блок обрабатывается одним проходом
+                if (stride == _blockSizeN) {
+                    MatrixSimd::apply(op, own, src, dst, blockElements());
+                    continue;
+                }
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    size_t row = static_cast<size_t>(r) * _blockSizeN;
+                    MatrixSimd::apply(op, own + row, src + r * stride, dst + row, _blockSizeN);
+                }
+            }
+        });
+    }
+
+    // Новая блочная матрица op(this, other) при op(0, x) == 0: результат содержит
+    // только блоки, присутствующие в this
+    template <typename Op>
+    MatrixBlock<T>* combine(const Matrix<T>& other, Op op) const {
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+
+        if (!hasDirectRegions(other)) {
+            ThreadPool::instance().parallelFor(0, _blockRows, ThreadPool::rowGrain(static_cast<size_t>(_blockSizeM) * cols()), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from) * _blockSizeM; i < to * _blockSizeM; ++i) {
+                    for (unsigned j = 0; j < cols(); ++j) {
+                        T value = op((*this)(i, j), other(i, j));
+                        if (value != T()) {
+                            result->setElement(i, j, value);
+                        }
+                    }
+                }
+            });
+            return result;
+        }
+
+        std::vector<size_t> list = blockList([&](unsigned bi, unsigned bj) {
+            size_t stride;
+            return blocks[bi][bj] && regionOf(other, bi, bj, stride) != nullptr;
+        });
+        result->allocateArena(list, false);
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned bi = static_cast<unsigned>(list[index] / _blockCols);
+                unsigned bj = static_cast<unsigned>(list[index] % _blockCols);
+                size_t stride;
+                const T* src = regionOf(other, bi, bj, stride);
+                const T* own = blocks[bi][bj]->rawData();
+                T* dst = result->blockIndex[list[index]];
+                if (stride == _blockSizeN) {
+                    MatrixSimd::apply(op, own, src, dst, blockElements());
+                    continue;
+                }
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    size_t row = static_cast<size_t>(r) * _blockSizeN;
+                    MatrixSimd::apply(op, own + row, src + r * stride, dst + row, _blockSizeN);
+                }
+            }
+        });
+        return result;
+    }
+
+    // Блочное умножение: перебираются только пары присутствующих блоков A(i, k) * B(k, j),
+    // каждая пара перемножается плотным ядром. Выходные блоки - задачи планировщика:
+    // число пар у блоков может различаться на порядки, свободные потоки забирают работу.
+    // Выходные блоки известны заранее и размещаются в одном буфере результата
+    MatrixBlock<T>* multiplyBlocks(const MatrixBlock<T>& other) const {
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, other._blockCols, _blockSizeM, other._blockSizeN);
+
+        std::vector<size_t> list = result->blockList([&](unsigned i, unsigned j) {
+            for (unsigned k = 0; k < _blockCols; ++k) {
+                if (blocks[i][k] && other.blocks[k][j]) {
+                    return true;
+                }
+            }
+            return false;
+        });
+        result->allocateArena(list, true);
+
+        size_t pairFlops = 2 * static_cast<size_t>(_blockSizeM) * _blockSizeN * other._blockSizeN;
+        size_t grain = std::max<size_t>(1, 65536 / pairFlops);
+        TaskScheduler::parallelFor(0, list.size(), grain, [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned i = static_cast<unsigned>(list[index] / other._blockCols);
+                unsigned j = static_cast<unsigned>(list[index] % other._blockCols);
+                T* target = result->blockIndex[list[index]];
+
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    const MatrixDense<T>* right = other.blocks[k][j].get();
+                    if (!left || !right) {
+                        continue;
+                    }
+                    // Маленькие блоки - развёрнутым ядром без упаковки
+                    if (!MatrixFixedDispatch<T>::multiplyAdd(_blockSizeM, _blockSizeN, other._blockSizeN,
+                                                             left->rawData(), right->rawData(), target)) {
+                        MatrixGemm<T>::multiply(_blockSizeM, other._blockSizeN, _blockSizeN,
+                                                T(1), left->rawData(), _blockSizeN,
+                                                right->rawData(), other._blockSizeN,
+                                                T(1), target, other._blockSizeN);
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    // Произведение на диагональную матрицу: столбцы присутствующих блоков масштабируются
+    MatrixBlock<T>* scaleColumns(const T* d) const {
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+
+        std::vector<size_t> list = blockList([&](unsigned bi, unsigned bj) { return blocks[bi][bj] != nullptr; });
+        result->allocateArena(list, false);
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned bi = static_cast<unsigned>(list[index] / _blockCols);
+                unsigned bj = static_cast<unsigned>(list[index] % _blockCols);
+                const T* src = blocks[bi][bj]->rawData();
+                T* dst = result->blockIndex[list[index]];
+                const T* scale = d + static_cast<size_t>(bj) * _blockSizeN;
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    size_t row = static_cast<size_t>(r) * _blockSizeN;
+                    MatrixSimd::apply(MatrixSimdMul(), src + row, scale, dst + row, _blockSizeN);
+                }
+            }
+        });
+        return result;
+    }
+
+    // out = alpha * this * other + beta * out для разреженного и ленточного other: блочная
+    // строка собирается в плотную полосу (отсутствующие блоки - нули, соответствующие строки
+    // other пропускаются по нулевому весу) и умножается на other через multiplyLeft
+    void multiplyLeftOf(const Matrix<T>& other, MatrixDense<T>& out, T alpha, T beta) const {
+        unsigned n = other.cols();
+        TaskScheduler::parallelFor(0, _blockRows, 1, [&](size_t from, size_t to) {
+            MatrixDense<T> panel(_blockSizeM, cols(), MatrixUninitialized());
+            for (size_t i = from; i < to; ++i) {
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* block = blocks[i][k].get();
+                    for (unsigned r = 0; r < _blockSizeM; ++r) {
+                        T* line = panel.rawData() + static_cast<size_t>(r) * cols() + static_cast<size_t>(k) * _blockSizeN;
+                        if (block) {
+                            std::copy(block->rawData() + static_cast<size_t>(r) * _blockSizeN, block->rawData() + static_cast<size_t>(r + 1) * _blockSizeN, line);
+                        } else {
+                            std::fill(line, line + _blockSizeN, T());
+                        }
+                    }
+                }
+                T* target = out.rawData() + i * _blockSizeM * n;
+                if (other.kind() == MatrixKind::Sparse) {
+                    static_cast<const MatrixSparseCSR<T>&>(other).multiplyLeft(panel.rawData(), cols(), _blockSizeM, alpha, beta, target, n);
+                } else {
+                    static_cast<const MatrixBanded<T>&>(other).multiplyLeft(panel.rawData(), cols(), _blockSizeM, alpha, beta, target, n);
+                }
+            }
+        });
+    }
+
+    // Произведение на плотную матрицу: нулевые блоки пропускаются. Задача - полоса
+    // блочной строки шириной Panel столбцов; стоимость полос зависит от заполненности строки
+    MatrixDense<T>* multiplyDense(const MatrixDense<T>& other) const {
+        static constexpr unsigned Panel = 256;
+        unsigned n = other.cols();
+        unsigned panels = std::max(1u, (n + Panel - 1) / Panel);
+        MatrixDense<T>* result = new MatrixDense<T>(rows(), n);
+
+        TaskScheduler::parallelFor(0, static_cast<size_t>(_blockRows) * panels, 1, [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned i = static_cast<unsigned>(index / panels);
+                unsigned column = static_cast<unsigned>(index % panels) * Panel;
+                unsigned width = std::min(Panel, n - column);
+                T* target = result->rawData() + static_cast<size_t>(i) * _blockSizeM * n + column;
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    if (!left) {
+                        continue;
+                    }
+                    MatrixGemm<T>::multiply(_blockSizeM, width, _blockSizeN,
+                                            T(1), left->rawData(), _blockSizeN,
+                                            other.rawData() + static_cast<size_t>(k) * _blockSizeN * n + column, n,
+                                            T(1), target, n);
+                }
+            }
+        });
+        return result;
+    }
+
+    // Операции с результатом в готовой матрице
+
+    static void checkStructure(const MatrixBlock<T>& out, unsigned blockRows, unsigned blockCols, unsigned blockSizeM, unsigned blockSizeN) {
+        if (out._blockRows != blockRows || out._blockCols != blockCols || out._blockSizeM != blockSizeM || out._blockSizeN != blockSizeN) {
+            throw std::invalid_argument("Блочная структура матрицы результата не совпадает с результатом операции.");
+        }
+    }
+
+    // dst = beta * dst (при beta == 0 - нули, dst не читается)
+    static void scaleBy(T* dst, size_t count, T beta) {
+        if (beta == T()) {
+            std::fill(dst, dst + count, T());
+        } else if (beta != T(1)) {
+            MatrixSimd::scale(dst, beta, dst, count);
+        }
+    }
+
+    // Признаки блоков результата для операций с готовым out; буфер потока переиспользуется
+    // между вызовами, чтобы в установившемся цикле не выделять память
+    static std::vector<char>& intoNeeded(size_t count) {
+        thread_local std::vector<char> needed;
+        needed.assign(count, 0);
+        return needed;
+    }
+
+    // Подготовка блоков out к записи до параллельной части: недостающие блоки результата
+    // (needed[key]) создаются нулевыми, общие с копиями - копируются; при повторных вызовах
+    // с той же структурой память не выделяется. Возвращает номера блоков для записи:
+    // блоки результата и, при beta != 1, остальные присутствующие блоки out
+    const std::vector<size_t>& prepareInto(const std::vector<char>& needed, T beta) {
+        thread_local std::vector<size_t> list;
+        list.clear();
+        bool changed = false;
+        for (size_t key = 0; key < needed.size(); ++key) {
+            unsigned i = static_cast<unsigned>(key / _blockCols);
+            unsigned j = static_cast<unsigned>(key % _blockCols);
+            if (!needed[key] && (!blocks[i][j] || beta == T(1))) {
+                continue;
+            }
+            if (!blocks[i][j]) {
+                blocks[i][j] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
+                changed = true;
+            } else if (unshare(i, j)) {
+                changed = true;
+            }
+            list.push_back(key);
+        }
+        if (changed && _compact) {
+            invalidateIndex();
+        }
+        return list;
+    }
+
+    // out = alpha * op(this, other) + beta * out для блочных матриц одной структуры;
+    // both - результат есть только там, где присутствуют блоки обоих операндов
+    template <typename Op>
+    void blocksInto(const MatrixBlock<T>& other, MatrixBlock<T>& out, Op op, T alpha, T beta, bool both) const {
+        if (other._blockRows != _blockRows || other._blockCols != _blockCols ||
+            other._blockSizeM != _blockSizeM || other._blockSizeN != _blockSizeN) {
+            throw std::invalid_argument("Блочная структура матриц должна совпадать.");
+        }
+        checkStructure(out, _blockRows, _blockCols, _blockSizeM, _blockSizeN);
+
+        std::vector<char>& needed = intoNeeded(static_cast<size_t>(_blockRows) * _blockCols);
+        for (size_t key = 0; key < needed.size(); ++key) {
+            bool a = blocks[key / _blockCols][key % _blockCols] != nullptr;
+            bool b = other.blocks[key / _blockCols][key % _blockCols] != nullptr;
+            needed[key] = both ? (a && b) : (a || b);
+        }
+        const std::vector<size_t>& list = out.prepareInto(needed, beta);
+
+        size_t count = blockElements();
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                size_t key = list[index];
+                T* dst = out.blocks[key / _blockCols][key % _blockCols]->rawData();
+                if (!needed[key]) {
+                    scaleBy(dst, count, beta);
+                    continue;
+                }
+                const MatrixDense<T>* left = blocks[key / _blockCols][key % _blockCols].get();
+                const MatrixDense<T>* right = other.blocks[key / _blockCols][key % _blockCols].get();
+                const T* a = left ? left->rawData() : nullptr;
+                const T* b = right ? right->rawData() : nullptr;
+                if (a && b && beta == T()) {
+                    MatrixSimd::apply(op, a, b, dst, count);
+                    if (alpha != T(1)) {
+                        MatrixSimd::scale(dst, alpha, dst, count);
+                    }
+                    continue;
+                }
+                for (size_t k = 0; k < count; ++k) {
+                    T value = alpha * op(a ? a[k] : T(), b ? b[k] : T());
+                    dst[k] = beta == T() ? value : value + beta * dst[k];
+                }
+            }
+        });
+    }
+
+    // Плотный out = alpha * op(this, other) + beta * out; участки other читаются напрямую,
+    // если это возможно (см. hasDirectRegions)
+    template <typename Op>
+    void denseInto(const Matrix<T>& other, MatrixDense<T>& out, Op op, T alpha, T beta) const {
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        this->checkInto(other, out, rows(), cols(), false);
+
+        bool direct = hasDirectRegions(other);
+        size_t ldc = cols();
+        TaskScheduler::parallelFor(0, static_cast<size_t>(_blockRows) * _blockCols, blockGrain(), [&](size_t from, size_t to) {
+            for (size_t key = from; key < to; ++key) {
+                unsigned bi = static_cast<unsigned>(key / _blockCols);
+                unsigned bj = static_cast<unsigned>(key % _blockCols);
+                const T* a = blocks[bi][bj] ? blocks[bi][bj]->rawData() : nullptr;
+                size_t stride = 0;
+                const T* b = direct ? regionOf(other, bi, bj, stride) : nullptr;
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    unsigned i = bi * _blockSizeM + r;
+                    T* c = out.rawData() + i * ldc + static_cast<size_t>(bj) * _blockSizeN;
+                    const T* aRow = a ? a + static_cast<size_t>(r) * _blockSizeN : nullptr;
+                    const T* bRow = b ? b + r * stride : nullptr;
+                    if (aRow && bRow && alpha == T(1) && beta == T()) {
+                        MatrixSimd::apply(op, aRow, bRow, c, _blockSizeN);
+                        continue;
+                    }
+                    for (unsigned col = 0; col < _blockSizeN; ++col) {
+                        T bValue = direct ? (bRow ? bRow[col] : T()) : other(i, bj * _blockSizeN + col);
+                        T value = alpha * op(aRow ? aRow[col] : T(), bValue);
+                        c[col] = beta == T() ? value : value + beta * c[col];
+                    }
+                }
+            }
+        });
+    }
+
+public:
     // Операции с матрицами
 
     // Сложение
     Matrix<T>& operator+=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::operator+=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) + other(i, j);
-                setElement(i, j, value);
-            }
-        }
-
+        accumulate(other, MatrixSimdAdd());
         return *this;
     }
 
     // Вычитание
     Matrix<T>& operator-=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::operator-=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) - other(i, j);
-                setElement(i, j, value);
-            }
-        }
-
+        accumulate(other, MatrixSimdSub());
         return *this;
     }
 
     // Оператор сложения
     Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::operator+", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
+        // Копия разделяет блоки с this, += пишет результат сразу в новые блоки
         MatrixBlock<T>* result = new MatrixBlock<T>(*this);
         result->operator+=(other);
         return result;
@@ -177,10 +829,12 @@ public:
 
     // Оператор вычитания
     Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::operator-", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
+        // Копия разделяет блоки с this, += пишет результат сразу в новые блоки
         MatrixBlock<T>* result = new MatrixBlock<T>(*this);
         result->operator-=(other);
         return result;
@@ -188,144 +842,593 @@ public:
 
     // Матричное умножение
     Matrix<T>* operator*(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::operator*", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 1.0 * rows() * other.cols()));
         if (cols() != other.rows()) {
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        // Для простоты вернем плотную матрицу
-        MatrixDense<T>* result = new MatrixDense<T>(rows(), other.cols());
+        if (other.kind() == MatrixKind::Block) {
+            const MatrixBlock<T>& block = static_cast<const MatrixBlock<T>&>(other);
+            if (block._blockSizeM == _blockSizeN) {
+                return multiplyBlocks(block);
+            }
+        }
+
+        if (other.kind() == MatrixKind::Dense) {
+            return multiplyDense(static_cast<const MatrixDense<T>&>(other));
+        }
+
+        if (other.kind() == MatrixKind::Diagonal) {
+            return scaleColumns(static_cast<const MatrixDiagonal<T>&>(other).rawData());
+        }
+
+        MatrixDense<T>* result = new MatrixDense<T>(rows(), other.cols(), MatrixUninitialized());
+
+        // Разреженный, ленточный, кронекеров множители и представление с непрерывными
+        // строками - через multiplyInto, который обходит только присутствующие блоки
+        size_t stride;
+        if (other.kind() == MatrixKind::Sparse || other.kind() == MatrixKind::Banded || other.kind() == MatrixKind::Kronecker ||
+            MatrixView<T>::rowStorage(other, stride)) {
+            multiplyInto(other, *result);
+            return result;
+        }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                T sum = T();
-                for (unsigned k = 0; k < cols(); ++k) {
-                    sum += (*this)(i, k) * other(k, j);
+        ThreadPool::instance().parallelFor(0, rows(), ThreadPool::rowGrain(static_cast<size_t>(cols()) * other.cols()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < other.cols(); ++j) {
+                    T sum = T();
+                    for (unsigned k = 0; k < cols(); ++k) {
+                        sum += (*this)(i, k) * other(k, j);
+                    }
+                    result->operator()(i, j) = sum;
                 }
-                result->operator()(i, j) = sum;
             }
-        }
+        });
         return result;
     }
 
     // Почленное умножение
     Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::elemMult", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
         }
 
-        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
-
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T value = (*this)(i, j) * other(i, j);
+        if (other.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+            for (unsigned i = 0; i < rows(); ++i) {
+                T value = (*this)(i, i) * d[i];
                 if (value != T()) {
-                    result->setElement(i, j, value);
+                    result->setElement(i, i, value);
                 }
             }
+            return result;
         }
-        return result;
+
+        return combine(other, MatrixSimdMul());
     }
 
     // Почленное деление
     Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::elemDiv", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (rows() != other.rows() || cols() != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного деления.");
         }
+        if (hasZeroElement(other)) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+        }
 
-        MatrixBlock<T>* result = new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN);
+        return combine(other, MatrixSimdDiv());
+    }
 
-        for (unsigned i = 0; i < rows(); ++i) {
-            for (unsigned j = 0; j < cols(); ++j) {
-                T denom = other(i, j);
-                if (denom == T()) {
-                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
-                }
-                T value = (*this)(i, j) / denom;
-                if (value != T()) {
-                    result->setElement(i, j, value);
+    // Транспонирование
+    MatrixBlock<T>* transpose() const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::transpose", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        MatrixBlock<T>* result = new MatrixBlock<T>(_blockCols, _blockRows, _blockSizeN, _blockSizeM);
+
+        // Блоки результата идут в буфере в его порядке, исходные читаются вразброс
+        std::vector<size_t> list = result->blockList([&](unsigned j, unsigned i) { return blocks[i][j] != nullptr; });
+        result->allocateArena(list, false);
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned j = static_cast<unsigned>(list[index] / _blockRows);
+                unsigned i = static_cast<unsigned>(list[index] % _blockRows);
+                const T* src = blocks[i][j]->rawData();
+                T* dst = result->blockIndex[list[index]];
+                if (!MatrixFixedDispatch<T>::transpose(_blockSizeM, _blockSizeN, src, dst)) {
+                    MatrixTranspose<T>::transpose(_blockSizeM, _blockSizeN, src, _blockSizeN, dst, _blockSizeM);
                 }
             }
-        }
+        });
         return result;
     }
 
-    // Транспонирование
-    MatrixBlock<T>* transpose() const override {
-        MatrixBlock<T>* result = new MatrixBlock<T>(_blockCols, _blockRows, _blockSizeN, _blockSizeM);
+    // Транспонирование на месте для квадратной сетки квадратных блоков:
+    // блоки транспонируются на месте, симметричные блоки меняются местами
+    void transposeInPlace() {
+        MATRIX_TRACE_SCOPE("MatrixBlock::transposeInPlace", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        if (_blockRows != _blockCols || _blockSizeM != _blockSizeN) {
+            throw std::invalid_argument("Транспонирование на месте возможно только для квадратной сетки квадратных блоков.");
+        }
 
+        std::vector<size_t> list = blockList([&](unsigned i, unsigned j) { return blocks[i][j] != nullptr; });
+        for (size_t key : list) {
+            if (isShared(static_cast<unsigned>(key / _blockCols), static_cast<unsigned>(key % _blockCols))) {
+                invalidateIndex();
+                break;
+            }
+        }
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned i = static_cast<unsigned>(list[index] / _blockCols);
+                unsigned j = static_cast<unsigned>(list[index] % _blockCols);
+                unshare(i, j);
+                blocks[i][j]->transposeInPlace();
+            }
+        });
         for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                if (blocks[i][j]) {
-                    result->blocks[j][i] = std::shared_ptr<MatrixDense<T>>(blocks[i][j]->transpose());
+            for (unsigned j = i + 1; j < _blockCols; ++j) {
+                std::swap(blocks[i][j], blocks[j][i]);
+                if (_compact) {
+                    std::swap(blockIndex[static_cast<size_t>(i) * _blockCols + j], blockIndex[static_cast<size_t>(j) * _blockCols + i]);
                 }
             }
         }
-        return result;
     }
 
-    // Импорт из файла
-    void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
+    // Операции с результатом в готовой матрице (см. Matrix<T>::multiplyInto).
+    // Варианты с блочным out требуют структуры блоков результата; недостающие блоки out
+    // создаются при первом вызове, дальше переиспользуются
+
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::multiplyInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 2.0 * rows() * other.cols()));
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
+        this->checkInto(other, out, rows(), other.cols(), true);
 
-        std::string className;
-        std::getline(infile, className);
+        const MatrixBlock<T>* right = other.kind() == MatrixKind::Block ? &static_cast<const MatrixBlock<T>&>(other) : nullptr;
+        if (right && right->_blockSizeM != _blockSizeN) {
+            right = nullptr;
+        }
+        if (other.kind() == MatrixKind::Sparse || other.kind() == MatrixKind::Banded) {
+            multiplyLeftOf(other, out, alpha, beta);
+            return;
+        }
+        if (other.kind() == MatrixKind::Kronecker) {
+            // (this * K)^T = K^T * this^T, K^T = A^T ⊗ B^T: смешанное произведение
+            // MatrixKronecker над транспонированным this, результат транспонируется обратно
+            MatrixDense<T> transposed(cols(), rows(), MatrixUninitialized());
+            transposeInto(transposed);
+            std::unique_ptr<Matrix<T>> kronecker(other.transpose());
+            MatrixDense<T> product(other.cols(), rows(), MatrixUninitialized());
+            kronecker->multiplyInto(transposed, product, alpha, T());
+            product.transposeInto(out, T(1), beta);
+            return;
+        }
+        size_t stride = 0;
+        const T* values = right ? nullptr : MatrixView<T>::rowStorage(other, stride);
+        if (!right && !values) {
+            Matrix<T>::multiplyInto(other, out, alpha, beta);
+            return;
+        }
 
-        if (className != "MatrixBlock") {
-            throw std::runtime_error("Файл не содержит данные MatrixBlock.");
+        // Задача - участок out под блоком (i, j) сетки результата; для плотного other
+        // (или представления с непрерывными строками) - полоса блочной строки
+        unsigned n = other.cols();
+        unsigned width = right ? right->_blockSizeN : n;
+        unsigned columns = right ? right->_blockCols : 1;
+        TaskScheduler::parallelFor(0, static_cast<size_t>(_blockRows) * columns, 1, [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned i = static_cast<unsigned>(index / columns);
+                unsigned j = static_cast<unsigned>(index % columns);
+                T* target = out.rawData() + static_cast<size_t>(i) * _blockSizeM * n + static_cast<size_t>(j) * width;
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    scaleBy(target + static_cast<size_t>(r) * n, width, beta);
+                }
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    if (!left) {
+                        continue;
+                    }
+                    const T* source;
+                    unsigned ldb;
+                    if (right) {
+                        const MatrixDense<T>* block = right->blocks[k][j].get();
+                        if (!block) {
+                            continue;
+                        }
+                        source = block->rawData();
+                        ldb = width;
+                    } else {
+                        source = values + static_cast<size_t>(k) * _blockSizeN * stride;
+                        ldb = static_cast<unsigned>(stride);
+                    }
+                    MatrixGemm<T>::multiply(_blockSizeM, width, _blockSizeN, alpha, left->rawData(), _blockSizeN,
+                                            source, ldb, T(1), target, n);
+                }
+            }
+        });
+    }
+
+    void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::addInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        denseInto(other, out, MatrixSimdAdd(), alpha, beta);
+    }
+
+    void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::subtractInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        denseInto(other, out, MatrixSimdSub(), alpha, beta);
+    }
+
+    void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::elemMultInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        denseInto(other, out, MatrixSimdMul(), alpha, beta);
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::transposeInto", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        this->checkInto(*this, out, cols(), rows(), true);
+
+        size_t ldc = rows();
+        TaskScheduler::parallelFor(0, static_cast<size_t>(_blockRows) * _blockCols, blockGrain(), [&](size_t from, size_t to) {
+            for (size_t key = from; key < to; ++key) {
+                unsigned bi = static_cast<unsigned>(key / _blockCols);
+                unsigned bj = static_cast<unsigned>(key % _blockCols);
+                const T* a = blocks[bi][bj] ? blocks[bi][bj]->rawData() : nullptr;
+                T* region = out.rawData() + static_cast<size_t>(bj) * _blockSizeN * ldc + static_cast<size_t>(bi) * _blockSizeM;
+                if (a && alpha == T(1) && beta == T()) {
+                    MatrixTranspose<T>::transpose(_blockSizeM, _blockSizeN, a, _blockSizeN, region, ldc);
+                    continue;
+                }
+                for (unsigned c = 0; c < _blockSizeN; ++c) {
+                    T* row = region + c * ldc;
+                    if (!a) {
+                        scaleBy(row, _blockSizeM, beta);
+                        continue;
+                    }
+                    for (unsigned r = 0; r < _blockSizeM; ++r) {
+                        T value = alpha * a[static_cast<size_t>(r) * _blockSizeN + c];
+                        row[r] = beta == T() ? value : value + beta * row[r];
+                    }
+                }
+            }
+        });
+    }
+
+    // out = alpha * this * other + beta * out в блочной форме: out - blockRows() x other.blockCols()
+    // блоков blockSizeM() x other.blockSizeN()
+    void multiplyInto(const MatrixBlock<T>& other, MatrixBlock<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::multiplyInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 2.0 * rows() * other.cols()));
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (other._blockSizeM != _blockSizeN) {
+            throw std::invalid_argument("Размер блоков множителей не согласован для блочного умножения.");
         }
+        checkStructure(out, _blockRows, other._blockCols, _blockSizeM, other._blockSizeN);
+        this->checkInto(other, out, rows(), other.cols(), true);
 
-        infile >> _blockRows >> _blockCols >> _blockSizeM >> _blockSizeN;
+        std::vector<char>& needed = intoNeeded(static_cast<size_t>(_blockRows) * other._blockCols);
+        for (size_t key = 0; key < needed.size(); ++key) {
+            unsigned i = static_cast<unsigned>(key / other._blockCols);
+            unsigned j = static_cast<unsigned>(key % other._blockCols);
+            for (unsigned k = 0; k < _blockCols && !needed[key]; ++k) {
+                needed[key] = blocks[i][k] && other.blocks[k][j];
+            }
+        }
+        const std::vector<size_t>& list = out.prepareInto(needed, beta);
 
-        blocks.resize(_blockRows, std::vector<std::shared_ptr<MatrixDense<T>>>(_blockCols, nullptr));
+        size_t count = static_cast<size_t>(_blockSizeM) * other._blockSizeN;
+        size_t pairFlops = 2 * static_cast<size_t>(_blockSizeM) * _blockSizeN * other._blockSizeN;
+        TaskScheduler::parallelFor(0, list.size(), std::max<size_t>(1, 65536 / pairFlops), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned i = static_cast<unsigned>(list[index] / other._blockCols);
+                unsigned j = static_cast<unsigned>(list[index] % other._blockCols);
+                T* target = out.blocks[i][j]->rawData();
+                scaleBy(target, count, beta);
+                if (!needed[list[index]]) {
+                    continue;
+                }
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    const MatrixDense<T>* right = other.blocks[k][j].get();
+                    if (!left || !right) {
+                        continue;
+                    }
+                    if (alpha == T(1) && MatrixFixedDispatch<T>::multiplyAdd(_blockSizeM, _blockSizeN, other._blockSizeN,
+                                                                             left->rawData(), right->rawData(), target)) {
+                        continue;
+                    }
+                    MatrixGemm<T>::multiply(_blockSizeM, other._blockSizeN, _blockSizeN,
+                                            alpha, left->rawData(), _blockSizeN,
+                                            right->rawData(), other._blockSizeN,
+                                            T(1), target, other._blockSizeN);
+                }
+            }
+        });
+    }
 
-        for (unsigned i = 0; i < _blockRows; ++i) {
-            for (unsigned j = 0; j < _blockCols; ++j) {
-                std::string hasBlock;
-                infile >> hasBlock;
-                if (hasBlock == "1") {
-                    blocks[i][j] = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN);
-                    for (unsigned m = 0; m < _blockSizeM; ++m) {
-                        for (unsigned n = 0; n < _blockSizeN; ++n) {
-                            infile >> (*blocks[i][j])(m, n);
-                        }
+    // Поэлементные операции в блочной форме: структура other и out совпадает со структурой this;
+    // out может совпадать с this или other
+    void addInto(const MatrixBlock<T>& other, MatrixBlock<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::addInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blocksInto(other, out, MatrixSimdAdd(), alpha, beta, false);
+    }
+
+    void subtractInto(const MatrixBlock<T>& other, MatrixBlock<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::subtractInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blocksInto(other, out, MatrixSimdSub(), alpha, beta, false);
+    }
+
+    void elemMultInto(const MatrixBlock<T>& other, MatrixBlock<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::elemMultInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blocksInto(other, out, MatrixSimdMul(), alpha, beta, true);
+    }
+
+    // out - blockCols() x blockRows() блоков blockSizeN() x blockSizeM()
+    void transposeInto(MatrixBlock<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::transposeInto", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        checkStructure(out, _blockCols, _blockRows, _blockSizeN, _blockSizeM);
+        this->checkInto(*this, out, cols(), rows(), true);
+
+        std::vector<char>& needed = intoNeeded(static_cast<size_t>(_blockCols) * _blockRows);
+        for (size_t key = 0; key < needed.size(); ++key) {
+            needed[key] = blocks[key % _blockRows][key / _blockRows] != nullptr;
+        }
+        const std::vector<size_t>& list = out.prepareInto(needed, beta);
+
+        size_t count = blockElements();
+        TaskScheduler::parallelFor(0, list.size(), blockGrain(), [&](size_t from, size_t to) {
+            for (size_t index = from; index < to; ++index) {
+                unsigned j = static_cast<unsigned>(list[index] / _blockRows);
+                unsigned i = static_cast<unsigned>(list[index] % _blockRows);
+                T* dst = out.blocks[j][i]->rawData();
+                if (!needed[list[index]]) {
+                    scaleBy(dst, count, beta);
+                    continue;
+                }
+                const T* src = blocks[i][j]->rawData();
+                if (alpha == T(1) && beta == T()) {
+                    if (!MatrixFixedDispatch<T>::transpose(_blockSizeM, _blockSizeN, src, dst)) {
+                        MatrixTranspose<T>::transpose(_blockSizeM, _blockSizeN, src, _blockSizeN, dst, _blockSizeM);
+                    }
+                    continue;
+                }
+                for (unsigned c = 0; c < _blockSizeN; ++c) {
+                    for (unsigned r = 0; r < _blockSizeM; ++r) {
+                        T value = alpha * src[static_cast<size_t>(r) * _blockSizeN + c];
+                        T& target = dst[static_cast<size_t>(c) * _blockSizeM + r];
+                        target = beta == T() ? value : value + beta * target;
+                    }
+                }
+            }
+        });
+    }
+
+    // y = alpha * A * x + beta * y: полосы блоков по строкам - задачи планировщика
+    // (их стоимость зависит от заполненности), нулевые блоки пропускаются
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::gemv", T, (rows(), cols(), x.size(), 1), 2.0 * rows() * cols(), sizeof(T) * (1.0 * rows() * cols() + x.size() + 2.0 * y.size()));
+        this->checkGemv(x, y);
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        TaskScheduler::parallelFor(0, _blockRows, std::max<size_t>(1, blockGrain() / std::max(1u, _blockCols)), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* target = ys + static_cast<size_t>(i) * _blockSizeM;
+                for (unsigned r = 0; r < _blockSizeM; ++r) {
+                    target[r] = beta == T() ? T() : beta * target[r];
+                }
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    if (!left) {
+                        continue;
+                    }
+                    const T* source = xs + static_cast<size_t>(k) * _blockSizeN;
+                    for (unsigned r = 0; r < _blockSizeM; ++r) {
+                        target[r] += alpha * MatrixSimd::dot(left->rawData() + static_cast<size_t>(r) * _blockSizeN, source, _blockSizeN);
+                    }
+                }
+            }
+        });
+    }
+
+    // Y = alpha * A * X + beta * Y: каждый присутствующий блок умножается
+    // плотным ядром сразу на все векторы (при немногих векторах - по транспонированному X)
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::gemvBatch", T, (rows(), cols(), X.rows(), X.cols()), 2.0 * rows() * cols() * X.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * X.rows() * X.cols() + 2.0 * Y.rows() * Y.cols()));
+        this->checkGemvBatch(X, Y);
+        unsigned n = X.cols();
+        bool narrow = n <= MatrixGemm<T>::NarrowWidth;
+        MatrixDense<T> vectors(narrow ? n : 0, narrow ? cols() : 0, MatrixUninitialized());
+        if (narrow) {
+            MatrixTranspose<T>::transpose(cols(), n, X.rawData(), n, vectors.rawData(), cols());
+        }
+        TaskScheduler::parallelFor(0, _blockRows, 1, [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T* target = Y.rawData() + static_cast<size_t>(i) * _blockSizeM * n;
+                bool touched = false;
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    const MatrixDense<T>* left = blocks[i][k].get();
+                    if (!left) {
+                        continue;
+                    }
+                    // beta применяется только с первым блоком полосы
+                    if (narrow) {
+                        MatrixGemm<T>::multiplyTransposed(_blockSizeM, n, _blockSizeN,
+                                                          alpha, left->rawData(), _blockSizeN,
+                                                          vectors.rawData() + static_cast<size_t>(k) * _blockSizeN, cols(),
+                                                          touched ? T(1) : beta, target, n);
+                    } else {
+                        MatrixGemm<T>::multiply(_blockSizeM, n, _blockSizeN,
+                                                alpha, left->rawData(), _blockSizeN,
+                                                X.rawData() + static_cast<size_t>(k) * _blockSizeN * n, n,
+                                                touched ? T(1) : beta, target, n);
+                    }
+                    touched = true;
+                }
+                // Полоса без блоков: остаётся только beta * Y
+                if (!touched) {
+                    size_t count = static_cast<size_t>(_blockSizeM) * n;
+                    if (beta == T()) {
+                        std::fill(target, target + count, T());
+                    } else {
+                        MatrixSimd::scale(target, beta, target, count);
                     }
                 }
             }
+        });
+    }
+
+    // Импорт из файла: все числа (включая признаки наличия блоков) разбираются
+    // параллельно, затем раскладываются по блокам
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixBlock::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
+
+        if (reader.line() != "MatrixBlock") {
+            throw std::runtime_error("Файл не содержит данные MatrixBlock.");
         }
 
-        infile.close();
+        unsigned blockRows = reader.value<unsigned>();
+        unsigned blockCols = reader.value<unsigned>();
+        unsigned blockSizeM = reader.value<unsigned>();
+        unsigned blockSizeN = reader.value<unsigned>();
+
+        std::vector<T> values = reader.rest<T>();
+        size_t blockSize = static_cast<size_t>(blockSizeM) * blockSizeN;
+
+        // Первый проход - присутствующие блоки и их начала, затем блоки копируются в общий буфер
+        std::vector<size_t> list, starts;
+        size_t pos = 0;
+        for (size_t key = 0; key < static_cast<size_t>(blockRows) * blockCols; ++key) {
+            if (pos >= values.size()) {
+                throw std::runtime_error("В текстовом файле матрицы меньше чисел, чем требуется.");
+            }
+            if (values[pos++] == T(1)) {
+                if (values.size() - pos < blockSize) {
+                    throw std::runtime_error("В текстовом файле матрицы меньше чисел, чем требуется.");
+                }
+                list.push_back(key);
+                starts.push_back(pos);
+                pos += blockSize;
+            }
+        }
+
+        MatrixBlock<T> loaded(blockRows, blockCols, blockSizeM, blockSizeN);
+        loaded.allocateArena(list, false);
+        for (size_t k = 0; k < list.size(); ++k) {
+            std::copy(values.begin() + starts[k], values.begin() + starts[k] + blockSize, loaded.blockIndex[list[k]]);
+        }
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * rows() * cols());
     }
 
-    // Экспорт в файл
+    // Экспорт в файл: блоки форматируются параллельно в буферы потоков
     void exportToFile(const std::string& filename) const override {
-        std::ofstream outfile(filename);
+        MATRIX_TRACE_SCOPE("MatrixBlock::exportToFile", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixBlock\n" + std::to_string(_blockRows) + " " + std::to_string(_blockCols) + " " +
+                    std::to_string(_blockSizeM) + " " + std::to_string(_blockSizeN) + "\n");
+        size_t blockBytes = static_cast<size_t>(_blockSizeM) * (static_cast<size_t>(_blockSizeN) * 14 + 1) + 2;
+        writer.units(static_cast<size_t>(_blockRows) * _blockCols, blockBytes, [this](size_t unit, std::string& buffer) {
+            const std::shared_ptr<MatrixDense<T>>& block = blocks[unit / _blockCols][unit % _blockCols];
+            if (!block) {
+                buffer += "0\n";
+                return;
+            }
+            buffer += "1\n";
+            const T* values = block->rawData();
+            for (unsigned m = 0; m < _blockSizeM; ++m) {
+                for (unsigned n = 0; n < _blockSizeN; ++n) {
+                    MatrixTextValue::append(buffer, values[static_cast<size_t>(m) * _blockSizeN + n]);
+                }
+                buffer += '\n';
+            }
+        });
+
+        writer.close();
+    }
+
+    // Импорт из двоичного файла
+    void importFromBinary(const std::string& filename) {
+        MATRIX_TRACE_SCOPE("MatrixBlock::importFromBinary", T, (0, 0), 0, 0);
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+
+        MatrixBinaryHeader header = MatrixBinary::readHeader(infile);
+        bool swap = MatrixBinary::checkHeader<T>(header, MatrixClassTag::Block, "MatrixBlock");
+        unsigned blockRows = static_cast<unsigned>(header.dims[0]);
+        unsigned blockCols = static_cast<unsigned>(header.dims[1]);
+        unsigned blockSizeM = static_cast<unsigned>(header.dims[2]);
+        unsigned blockSizeN = static_cast<unsigned>(header.dims[3]);
+
+        std::vector<char> present(static_cast<size_t>(blockRows) * blockCols);
+        infile.seekg(static_cast<std::streamoff>(header.dataOffset));
+        infile.read(present.data(), static_cast<std::streamsize>(present.size()));
+        infile.seekg(static_cast<std::streamoff>(MatrixBinary::alignUp(header.dataOffset + present.size())));
+
+        // Блоки лежат в файле подряд в порядке номеров - так же, как в общем буфере,
+        // поэтому читаются одним вызовом
+        MatrixBlock<T> loaded(blockRows, blockCols, blockSizeM, blockSizeN);
+        std::vector<size_t> list = loaded.blockList([&](unsigned i, unsigned j) { return present[static_cast<size_t>(i) * blockCols + j] != 0; });
+        loaded.allocateArena(list, false);
+        size_t total = list.size() * loaded.blockElements();
+        if (total > 0) {
+            T* values = loaded.blockIndex[list.front()];
+            infile.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(total * sizeof(T)));
+            if (swap) {
+                MatrixBinary::swapBytes(values, total);
+            }
+        }
+        if (!infile) {
+            throw std::runtime_error("Повреждённый двоичный файл MatrixBlock.");
+        }
+
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * rows() * cols());
+    }
+
+    // Экспорт в двоичный файл
+    void exportToBinary(const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixBlock::exportToBinary", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        std::ofstream outfile(filename, std::ios::binary);
         if (!outfile) {
             throw std::runtime_error("Не удалось открыть файл для записи.");
         }
 
-        outfile << "MatrixBlock\n";
-        outfile << _blockRows << " " << _blockCols << " " << _blockSizeM << " " << _blockSizeN << "\n";
+        MatrixBinaryHeader header = MatrixBinary::makeHeader<T>(MatrixClassTag::Block, _blockRows, _blockCols, _blockSizeM, _blockSizeN);
+        MatrixBinary::writeHeader(outfile, header);
 
+        std::vector<char> present(static_cast<size_t>(_blockRows) * _blockCols);
+        for (unsigned i = 0; i < _blockRows; ++i) {
+            for (unsigned j = 0; j < _blockCols; ++j) {
+                present[static_cast<size_t>(i) * _blockCols + j] = blocks[i][j] ? 1 : 0;
+            }
+        }
+        outfile.write(present.data(), static_cast<std::streamsize>(present.size()));
+        std::vector<char> padding(MatrixBinary::alignUp(header.dataOffset + present.size()) - header.dataOffset - present.size());
+        outfile.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+        size_t blockBytes = static_cast<size_t>(_blockSizeM) * _blockSizeN * sizeof(T);
         for (unsigned i = 0; i < _blockRows; ++i) {
             for (unsigned j = 0; j < _blockCols; ++j) {
                 if (blocks[i][j]) {
-                    outfile << "1\n";
-                    for (unsigned m = 0; m < _blockSizeM; ++m) {
-                        for (unsigned n = 0; n < _blockSizeN; ++n) {
-                            outfile << (*blocks[i][j])(m, n) << " ";
-                        }
-                        outfile << "\n";
-                    }
-                } else {
-                    outfile << "0\n";
+                    outfile.write(reinterpret_cast<const char*>(blocks[i][j]->rawData()), static_cast<std::streamsize>(blockBytes));
                 }
             }
         }
-
-        outfile.close();
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
+        }
     }
 
     // Метод для печати матрицы
@@ -0,0 +1,536 @@
+#ifndef MATRIXBLOCKSTORE_H
+#define MATRIXBLOCKSTORE_H
+
+#include "MatrixDense.h"
+#include "MatrixBlock.h"
+#include "MatrixBinary.h"
+#include "MatrixGemm.h"
+#include "MatrixSimd.h"
+#include "MatrixTranspose.h"
+#include "MatrixTrace.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+// Блочная матрица на диске: блоки читаются по требованию через кэш LRU с
+// ограничением памяти. Файл - двоичный формат с таблицей смещений блоков
+// (MatrixClassTag::BlockStore), поэтому любой блок читается одним обращением,
+// а новые блоки дописываются в конец в любом порядке.
+// Блок, который держит вызывающий код (shared_ptr из block()), из кэша не вытесняется.
+// Операции multiply, add и transpose обходят блоки по одному выходному блоку,
+// заранее подгружая в фоне блоки следующего шага; результат пишется в новый файл
+template <typename T = double>
+class MatrixBlockStore {
+private:
+    using Entry = std::pair<size_t, std::shared_ptr<MatrixDense<T>>>;
+
+    unsigned _blockRows, _blockCols;         // Количество блоков по строкам и столбцам
+    unsigned _blockSizeM, _blockSizeN;       // Размер каждого блока
+    std::string _filename;
+
+    // Файл и таблица смещений; чтение и запись под fileMutex
+    mutable std::fstream file;
+    mutable std::mutex fileMutex;
+    std::vector<uint64_t> offsets;
+    uint64_t indexOffset = 0;
+    uint64_t _end = 0;
+    bool swap = false;
+    bool writable = false;
+
+    // Кэш: начало списка - последние использованные блоки
+    mutable std::mutex cacheMutex;
+    mutable std::condition_variable loaded;
+    mutable std::list<Entry> lru;
+    mutable std::unordered_map<size_t, typename std::list<Entry>::iterator> resident;
+    mutable std::unordered_set<size_t> loading;
+    size_t _budget;
+    mutable size_t _residentBytes = 0;
+    mutable size_t _hits = 0, _reads = 0;
+
+    // Фоновая подгрузка, поток запускается при первом запросе
+    mutable std::deque<size_t> prefetchQueue;
+    mutable std::condition_variable prefetchCondition;
+    mutable std::thread prefetcher;
+    mutable bool stopping = false;
+
+    size_t blockCount() const { return static_cast<size_t>(_blockSizeM) * _blockSizeN; }
+    size_t blockBytes() const { return blockCount() * sizeof(T); }
+    size_t keyOf(unsigned blockRow, unsigned blockCol) const { return static_cast<size_t>(blockRow) * _blockCols + blockCol; }
+
+    void checkIndex(unsigned blockRow, unsigned blockCol) const {
+        if (blockRow >= _blockRows || blockCol >= _blockCols) {
+            throw std::out_of_range("Индекс блока вне диапазона.");
+        }
+    }
+
+    std::shared_ptr<MatrixDense<T>> read(size_t key) const {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::read", T, (_blockSizeM, _blockSizeN), 0, 1.0 * sizeof(T) * _blockSizeM * _blockSizeN);
+        auto block = std::make_shared<MatrixDense<T>>(_blockSizeM, _blockSizeN, MatrixUninitialized());
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offsets[key]));
+            file.read(reinterpret_cast<char*>(block->rawData()), static_cast<std::streamsize>(blockBytes()));
+            if (!file) {
+                throw std::runtime_error("Не удалось прочитать блок из файла " + _filename + ".");
+            }
+        }
+        if (swap) {
+            MatrixBinary::swapBytes(block->rawData(), blockCount());
+        }
+        return block;
+    }
+
+    // Вытеснение давно не использованных блоков, пока не освободится bytes;
+    // блоки, которые держит вызывающий код, пропускаются. Вызывается под cacheMutex
+    void evict(size_t bytes) const {
+        auto it = lru.end();
+        while (_residentBytes + bytes > _budget && it != lru.begin()) {
+            --it;
+            if (it->second.use_count() > 1) {
+                continue;
+            }
+            resident.erase(it->first);
+            _residentBytes -= blockBytes();
+            it = lru.erase(it);
+        }
+    }
+
+    // Блок из кэша или с диска; если блок уже читается другим потоком, ожидание его загрузки
+    std::shared_ptr<MatrixDense<T>> fetch(size_t key) const {
+        std::unique_lock<std::mutex> lock(cacheMutex);
+        for (;;) {
+            auto found = resident.find(key);
+            if (found != resident.end()) {
+                lru.splice(lru.begin(), lru, found->second);
+                ++_hits;
+                return found->second->second;
+            }
+            if (!loading.count(key)) {
+                break;
+            }
+            loaded.wait(lock);
+        }
+        loading.insert(key);
+        ++_reads;
+        lock.unlock();
+
+        std::shared_ptr<MatrixDense<T>> block;
+        try {
+            block = read(key);
+        } catch (...) {
+            lock.lock();
+            loading.erase(key);
+            loaded.notify_all();
+            throw;
+        }
+
+        lock.lock();
+        loading.erase(key);
+        evict(blockBytes());
+        lru.emplace_front(key, block);
+        resident[key] = lru.begin();
+        _residentBytes += blockBytes();
+        loaded.notify_all();
+        return block;
+    }
+
+    void prefetchLoop() const {
+        std::unique_lock<std::mutex> lock(cacheMutex);
+        for (;;) {
+            prefetchCondition.wait(lock, [this] { return stopping || !prefetchQueue.empty(); });
+            if (stopping) {
+                return;
+            }
+            size_t key = prefetchQueue.front();
+            prefetchQueue.pop_front();
+            if (resident.count(key) || loading.count(key)) {
+                continue;
+            }
+            lock.unlock();
+            try {
+                fetch(key);
+            } catch (...) {
+                // Ошибка чтения повторится при обычном обращении к блоку
+            }
+            lock.lock();
+        }
+    }
+
+    // Подгрузка блоков следующего шага из this и other (other может совпадать с this)
+    void schedule(std::vector<size_t> keys, const MatrixBlockStore<T>& other, const std::vector<size_t>& otherKeys) const {
+        if (&other == this) {
+            keys.insert(keys.end(), otherKeys.begin(), otherKeys.end());
+            schedule(keys);
+            return;
+        }
+        schedule(keys);
+        other.schedule(otherKeys);
+    }
+
+    // Очередь подгрузки заменяется блоками следующего шага
+    void schedule(const std::vector<size_t>& keys) const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        prefetchQueue.assign(keys.begin(), keys.end());
+        if (!prefetcher.joinable()) {
+            prefetcher = std::thread([this] { prefetchLoop(); });
+        }
+        prefetchCondition.notify_one();
+    }
+
+    void writeIndexEntry(size_t key) {
+        uint64_t offset = offsets[key];
+        file.seekp(static_cast<std::streamoff>(indexOffset + key * sizeof(uint64_t)));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+
+    void open(const std::string& filename) {
+        file.open(filename, std::ios::in | std::ios::out | std::ios::binary);
+        writable = file.is_open();
+        if (!writable) {
+            file.open(filename, std::ios::in | std::ios::binary);
+        }
+        if (!file) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+
+        MatrixBinaryHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw std::runtime_error("Не удалось прочитать заголовок двоичного файла матрицы.");
+        }
+        swap = MatrixBinary::checkHeader<T>(header, MatrixClassTag::BlockStore, "MatrixBlockStore");
+        _blockRows = static_cast<unsigned>(header.dims[0]);
+        _blockCols = static_cast<unsigned>(header.dims[1]);
+        _blockSizeM = static_cast<unsigned>(header.dims[2]);
+        _blockSizeN = static_cast<unsigned>(header.dims[3]);
+        indexOffset = header.dataOffset;
+
+        offsets.resize(static_cast<size_t>(_blockRows) * _blockCols);
+        file.seekg(static_cast<std::streamoff>(indexOffset));
+        file.read(reinterpret_cast<char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+        if (!file) {
+            throw std::runtime_error("Повреждённый двоичный файл MatrixBlockStore.");
+        }
+        if (swap) {
+            MatrixBinary::swapBytes(offsets.data(), offsets.size());
+        }
+
+        file.seekg(0, std::ios::end);
+        uint64_t size = static_cast<uint64_t>(file.tellg());
+        for (uint64_t offset : offsets) {
+            if (offset != 0 && offset + blockBytes() > size) {
+                throw std::runtime_error("Повреждённый двоичный файл MatrixBlockStore.");
+            }
+        }
+        _end = MatrixBinary::alignUp(size);
+    }
+
+public:
+    static constexpr size_t defaultBudget = size_t(256) << 20;
+
+    // Открытие существующего файла хранилища; memoryBudget - предел памяти кэша в байтах
+    explicit MatrixBlockStore(const std::string& filename, size_t memoryBudget = defaultBudget)
+        : _blockRows(0), _blockCols(0), _blockSizeM(0), _blockSizeN(0), _filename(filename), _budget(memoryBudget) {
+        open(filename);
+    }
+
+    // Создание пустого хранилища (все блоки нулевые); существующий файл перезаписывается
+    MatrixBlockStore(const std::string& filename, unsigned blockRows, unsigned blockCols,
+                     unsigned blockSizeM, unsigned blockSizeN, size_t memoryBudget = defaultBudget)
+        : _blockRows(blockRows), _blockCols(blockCols), _blockSizeM(blockSizeM), _blockSizeN(blockSizeN),
+          _filename(filename), _budget(memoryBudget) {
+        file.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+        writable = true;
+
+        MatrixBinaryHeader header = MatrixBinary::makeHeader<T>(MatrixClassTag::BlockStore, blockRows, blockCols, blockSizeM, blockSizeN);
+        indexOffset = header.dataOffset;
+        offsets.assign(static_cast<size_t>(blockRows) * blockCols, 0);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::vector<char> padding(indexOffset - sizeof(header));
+        file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        file.write(reinterpret_cast<const char*>(offsets.data()), static_cast<std::streamsize>(offsets.size() * sizeof(uint64_t)));
+        _end = MatrixBinary::alignUp(indexOffset + offsets.size() * sizeof(uint64_t));
+        if (!file) {
+            throw std::runtime_error("Не удалось записать файл.");
+        }
+    }
+
+    MatrixBlockStore(const MatrixBlockStore<T>&) = delete;
+    MatrixBlockStore<T>& operator=(const MatrixBlockStore<T>&) = delete;
+
+    // Деструктор
+    ~MatrixBlockStore() {
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            stopping = true;
+        }
+        prefetchCondition.notify_all();
+        if (prefetcher.joinable()) {
+            prefetcher.join();
+        }
+    }
+
+    // Запись блочной матрицы в новый файл хранилища
+    static MatrixBlockStore<T>* fromMatrix(const MatrixBlock<T>& matrix, const std::string& filename, size_t memoryBudget = defaultBudget) {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::fromMatrix", T, (matrix.rows(), matrix.cols()), 0, 1.0 * sizeof(T) * matrix.rows() * matrix.cols());
+        std::unique_ptr<MatrixBlockStore<T>> store(new MatrixBlockStore<T>(filename, matrix.blockRows(), matrix.blockCols(),
+                                                                            matrix.blockSizeM(), matrix.blockSizeN(), memoryBudget));
+        for (unsigned i = 0; i < matrix.blockRows(); ++i) {
+            for (unsigned j = 0; j < matrix.blockCols(); ++j) {
+                if (matrix.block(i, j)) {
+                    store->setBlock(i, j, *matrix.block(i, j));
+                }
+            }
+        }
+        return store.release();
+    }
+
+    unsigned rows() const { return _blockRows * _blockSizeM; }
+    unsigned cols() const { return _blockCols * _blockSizeN; }
+    unsigned blockRows() const { return _blockRows; }
+    unsigned blockCols() const { return _blockCols; }
+    unsigned blockSizeM() const { return _blockSizeM; }
+    unsigned blockSizeN() const { return _blockSizeN; }
+    const std::string& filename() const { return _filename; }
+
+    // Предел памяти кэша; при уменьшении лишние блоки вытесняются сразу
+    size_t memoryBudget() const { return _budget; }
+    void setMemoryBudget(size_t bytes) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        _budget = bytes;
+        evict(0);
+    }
+
+    // Статистика кэша: занятая память, попадания и чтения с диска
+    size_t residentBytes() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return _residentBytes;
+    }
+    size_t hits() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return _hits;
+    }
+    size_t reads() const {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return _reads;
+    }
+
+    bool hasBlock(unsigned blockRow, unsigned blockCol) const {
+        checkIndex(blockRow, blockCol);
+        return offsets[keyOf(blockRow, blockCol)] != 0;
+    }
+
+    // Блок (blockRow, blockCol) или nullptr для нулевого блока
+    std::shared_ptr<const MatrixDense<T>> block(unsigned blockRow, unsigned blockCol) const {
+        if (!hasBlock(blockRow, blockCol)) {
+            return nullptr;
+        }
+        return fetch(keyOf(blockRow, blockCol));
+    }
+
+    // Фоновая подгрузка блока в кэш
+    void prefetch(unsigned blockRow, unsigned blockCol) const {
+        if (!hasBlock(blockRow, blockCol)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        prefetchQueue.push_back(keyOf(blockRow, blockCol));
+        if (!prefetcher.joinable()) {
+            prefetcher = std::thread([this] { prefetchLoop(); });
+        }
+        prefetchCondition.notify_one();
+    }
+
+    // Запись блока: данные дописываются в конец файла, смещение обновляется в таблице.
+    // Место прежней версии блока не освобождается
+    void setBlock(unsigned blockRow, unsigned blockCol, const MatrixDense<T>& block) {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::setBlock", T, (_blockSizeM, _blockSizeN), 0, 1.0 * sizeof(T) * _blockSizeM * _blockSizeN);
+        checkIndex(blockRow, blockCol);
+        if (block.rows() != _blockSizeM || block.cols() != _blockSizeN) {
+            throw std::invalid_argument("Размер блока не соответствует размеру блока матрицы.");
+        }
+        if (!writable || swap) {
+            throw std::runtime_error("Файл " + _filename + " открыт только для чтения.");
+        }
+
+        size_t key = keyOf(blockRow, blockCol);
+        {
+            std::lock_guard<std::mutex> lock(fileMutex);
+            file.clear();
+            file.seekp(static_cast<std::streamoff>(_end));
+            file.write(reinterpret_cast<const char*>(block.rawData()), static_cast<std::streamsize>(blockBytes()));
+            offsets[key] = _end;
+            _end = MatrixBinary::alignUp(_end + blockBytes());
+            // Выравнивание конца файла, чтобы следующая запись не оставляла дыру
+            std::vector<char> padding(_end - offsets[key] - blockBytes());
+            file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            writeIndexEntry(key);
+            file.flush();
+            if (!file) {
+                throw std::runtime_error("Не удалось записать файл.");
+            }
+        }
+
+        // Устаревшая копия в кэше заменяется при следующем чтении. Чтение, начатое до записи
+        // (например, фоновой подгрузкой), могло взять прежнее смещение: его результат
+        // дожидается попадания в кэш и удаляется вместе с остальными
+        std::unique_lock<std::mutex> lock(cacheMutex);
+        loaded.wait(lock, [&] { return !loading.count(key); });
+        auto found = resident.find(key);
+        if (found != resident.end()) {
+            lru.erase(found->second);
+            resident.erase(found);
+            _residentBytes -= blockBytes();
+        }
+    }
+
+    // Доступ к элементам (через кэш блоков)
+    T operator()(unsigned i, unsigned j) const {
+        std::shared_ptr<const MatrixDense<T>> source = block(i / _blockSizeM, j / _blockSizeN);
+        return source ? (*source)(i % _blockSizeM, j % _blockSizeN) : T();
+    }
+
+    // Загрузка всей матрицы в память
+    MatrixBlock<T>* load() const {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::load", T, (rows(), cols()), 0, 1.0 * sizeof(T) * rows() * cols());
+        std::unique_ptr<MatrixBlock<T>> result(new MatrixBlock<T>(_blockRows, _blockCols, _blockSizeM, _blockSizeN));
+        for (unsigned i = 0; i < _blockRows; ++i) {
+            for (unsigned j = 0; j < _blockCols; ++j) {
+                if (hasBlock(i, j)) {
+                    result->setBlock(i, j, read(keyOf(i, j)));
+                }
+            }
+        }
+        return result.release();
+    }
+
+    // Умножение с результатом в файле filename: выходные блоки вычисляются по одному,
+    // пока считается блок (i, j), в фоне подгружаются пары блоков для следующего
+    MatrixBlockStore<T>* multiply(const MatrixBlockStore<T>& other, const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::multiply", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 1.0 * rows() * other.cols()));
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (_blockSizeN != other._blockSizeM) {
+            throw std::invalid_argument("Размеры блоков должны быть согласованы для умножения.");
+        }
+
+        std::unique_ptr<MatrixBlockStore<T>> result(new MatrixBlockStore<T>(filename, _blockRows, other._blockCols,
+                                                                             _blockSizeM, other._blockSizeN, _budget));
+        MatrixDense<T> accumulator(_blockSizeM, other._blockSizeN, MatrixUninitialized());
+        size_t outputs = static_cast<size_t>(_blockRows) * other._blockCols;
+
+        for (size_t index = 0; index < outputs; ++index) {
+            unsigned i = static_cast<unsigned>(index / other._blockCols);
+            unsigned j = static_cast<unsigned>(index % other._blockCols);
+
+            if (index + 1 < outputs) {
+                unsigned ni = static_cast<unsigned>((index + 1) / other._blockCols);
+                unsigned nj = static_cast<unsigned>((index + 1) % other._blockCols);
+                std::vector<size_t> left, right;
+                for (unsigned k = 0; k < _blockCols; ++k) {
+                    if (hasBlock(ni, k) && other.hasBlock(k, nj)) {
+                        left.push_back(keyOf(ni, k));
+                        right.push_back(other.keyOf(k, nj));
+                    }
+                }
+                schedule(left, other, right);
+            }
+
+            bool present = false;
+            for (unsigned k = 0; k < _blockCols; ++k) {
+                if (!hasBlock(i, k) || !other.hasBlock(k, j)) {
+                    continue;
+                }
+                std::shared_ptr<const MatrixDense<T>> a = block(i, k);
+                std::shared_ptr<const MatrixDense<T>> b = other.block(k, j);
+                MatrixGemm<T>::multiply(_blockSizeM, other._blockSizeN, _blockSizeN,
+                                        T(1), a->rawData(), _blockSizeN,
+                                        b->rawData(), other._blockSizeN,
+                                        present ? T(1) : T(), accumulator.rawData(), other._blockSizeN);
+                present = true;
+            }
+            if (present) {
+                result->setBlock(i, j, accumulator);
+            }
+        }
+        return result.release();
+    }
+
+    // Сложение с результатом в файле filename; блок отсутствует, если нулевой в обоих слагаемых
+    MatrixBlockStore<T>* add(const MatrixBlockStore<T>& other, const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::add", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
+        }
+        if (_blockSizeM != other._blockSizeM || _blockSizeN != other._blockSizeN) {
+            throw std::invalid_argument("Размеры блоков должны совпадать для сложения.");
+        }
+
+        std::unique_ptr<MatrixBlockStore<T>> result(new MatrixBlockStore<T>(filename, _blockRows, _blockCols,
+                                                                             _blockSizeM, _blockSizeN, _budget));
+        MatrixDense<T> sum(_blockSizeM, _blockSizeN, MatrixUninitialized());
+        size_t outputs = offsets.size();
+
+        for (size_t index = 0; index < outputs; ++index) {
+            if (index + 1 < outputs) {
+                schedule(offsets[index + 1] ? std::vector<size_t>{index + 1} : std::vector<size_t>(),
+                         other, other.offsets[index + 1] ? std::vector<size_t>{index + 1} : std::vector<size_t>());
+            }
+
+            unsigned i = static_cast<unsigned>(index / _blockCols);
+            unsigned j = static_cast<unsigned>(index % _blockCols);
+            std::shared_ptr<const MatrixDense<T>> a = block(i, j);
+            std::shared_ptr<const MatrixDense<T>> b = other.block(i, j);
+            if (a && b) {
+                MatrixSimd::apply(MatrixSimdAdd(), a->rawData(), b->rawData(), sum.rawData(), blockCount());
+                result->setBlock(i, j, sum);
+            } else if (a || b) {
+                result->setBlock(i, j, a ? *a : *b);
+            }
+        }
+        return result.release();
+    }
+
+    // Транспонирование с результатом в файле filename: выходной блок (j, i) - транспонированный блок (i, j)
+    MatrixBlockStore<T>* transpose(const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixBlockStore::transpose", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        std::unique_ptr<MatrixBlockStore<T>> result(new MatrixBlockStore<T>(filename, _blockCols, _blockRows,
+                                                                             _blockSizeN, _blockSizeM, _budget));
+        MatrixDense<T> transposed(_blockSizeN, _blockSizeM, MatrixUninitialized());
+        size_t outputs = offsets.size();
+
+        // Выходные блоки пишутся построчно, исходные читаются по столбцам
+        for (size_t index = 0; index < outputs; ++index) {
+            unsigned j = static_cast<unsigned>(index / _blockRows);
+            unsigned i = static_cast<unsigned>(index % _blockRows);
+            if (index + 1 < outputs) {
+                size_t next = keyOf(static_cast<unsigned>((index + 1) % _blockRows), static_cast<unsigned>((index + 1) / _blockRows));
+                schedule(offsets[next] ? std::vector<size_t>{next} : std::vector<size_t>());
+            }
+
+            std::shared_ptr<const MatrixDense<T>> source = block(i, j);
+            if (source) {
+                MatrixTranspose<T>::transpose(_blockSizeM, _blockSizeN, source->rawData(), _blockSizeN, transposed.rawData(), _blockSizeM);
+                result->setBlock(j, i, transposed);
+            }
+        }
+        return result.release();
+    }
+};
+
+#endif
@@ -0,0 +1,489 @@
+#include "MatrixDense.h"
+#include "MatrixDiagonal.h"
+#include "MatrixBlock.h"
+#include "MatrixKronecker.h"
+#include "MatrixView.h"
+#include "MatrixSparseCSR.h"
+#include "MatrixBanded.h"
+#include "MatrixStrassen.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Проверка результатов: каждая операция всех видов матриц (Dense, Diagonal, Block,
+// Kronecker, View, Sparse, Banded) сравнивается с реализацией Matrix<T> по умолчанию,
+// которая читает операнды через виртуальный operator(). Матрицы небольшие и нечётного
+// размера, чтобы попадать на хвосты векторных и блочных ядер.
+// Параметры командной строки (все необязательны):
+//   --size 15               размер квадратных операндов (кратен 3 и 5)
+//   --types double,float,int
+//   --threads 1,4           число потоков пула
+// Код возврата 1, если найдено хотя бы одно расхождение
+
+struct CheckConfig {
+    unsigned size = 15;
+    std::vector<std::string> types = {"double", "float", "int"};
+    std::vector<unsigned> threads = {1, 4};
+};
+
+static std::vector<std::string> parseNames(const std::string& text) {
+    std::vector<std::string> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(item);
+    }
+    return values;
+}
+
+static CheckConfig parseArguments(int argc, char** argv) {
+    CheckConfig config;
+    for (int k = 1; k + 1 < argc; k += 2) {
+        std::string key = argv[k];
+        std::string value = argv[k + 1];
+        if (key == "--size") {
+            config.size = static_cast<unsigned>(std::stoul(value));
+        } else if (key == "--types") {
+            config.types = parseNames(value);
+        } else if (key == "--threads") {
+            config.threads.clear();
+            for (const std::string& item : parseNames(value)) {
+                config.threads.push_back(static_cast<unsigned>(std::stoul(item)));
+            }
+        } else {
+            throw std::invalid_argument("Неизвестный параметр " + key);
+        }
+    }
+    if (config.size == 0 || config.size % 15 != 0) {
+        throw std::invalid_argument("Размер матриц должен быть кратен 15.");
+    }
+    return config;
+}
+
+// Операнд проверки; storage держит хранилище представлений
+template <typename T>
+struct CheckOperand {
+    std::string name;
+    std::shared_ptr<MatrixDense<T>> storage;
+    std::unique_ptr<Matrix<T>> matrix;
+};
+
+template <typename T>
+class Check {
+private:
+    unsigned n;
+    std::string type;
+    unsigned threads = 1;
+    size_t checks = 0;
+    size_t failures = 0;
+
+    static const std::vector<std::string>& kinds() {
+        static const std::vector<std::string> names = {"Dense", "Diagonal", "Block", "Block3", "Kronecker", "View", "ViewT", "Sparse", "Banded"};
+        return names;
+    }
+
+    // Ненулевые целые значения: результаты точны и для float, и для int
+    static T randomValue(std::mt19937& gen) {
+        std::uniform_int_distribution<> dis(-4, 4);
+        int value = dis(gen);
+        return static_cast<T>(value == 0 ? 5 : value);
+    }
+
+    static MatrixDense<T> randomDense(unsigned m, unsigned k, std::mt19937& gen) {
+        MatrixDense<T> result(m, k);
+        for (unsigned i = 0; i < m; ++i) {
+            for (unsigned j = 0; j < k; ++j) {
+                result(i, j) = randomValue(gen);
+            }
+        }
+        return result;
+    }
+
+    // Новый операнд вида kind; одинаковый kind даёт одинаковые значения
+    CheckOperand<T> make(const std::string& kind) const {
+        std::mt19937 gen(static_cast<unsigned>(std::hash<std::string>()(kind) % 1000));
+        CheckOperand<T> operand;
+        operand.name = kind;
+        if (kind == "Dense") {
+            operand.matrix.reset(new MatrixDense<T>(randomDense(n, n, gen)));
+        } else if (kind == "Diagonal") {
+            MatrixDiagonal<T>* diagonal = new MatrixDiagonal<T>(n);
+            for (unsigned i = 0; i < n; ++i) {
+                (*diagonal)(i, i) = randomValue(gen);
+            }
+            operand.matrix.reset(diagonal);
+        } else if (kind == "Block" || kind == "Block3") {
+            // Присутствует примерно половина блоков
+            unsigned blockSize = kind == "Block" ? 5 : 3;
+            unsigned grid = n / blockSize;
+            MatrixBlock<T>* block = new MatrixBlock<T>(grid, grid, blockSize, blockSize);
+            for (unsigned bi = 0; bi < grid; ++bi) {
+                for (unsigned bj = 0; bj < grid; ++bj) {
+                    if ((bi + 2 * bj) % 3 == 1) {
+                        continue;
+                    }
+                    for (unsigned i = 0; i < blockSize; ++i) {
+                        for (unsigned j = 0; j < blockSize; ++j) {
+                            block->setElement(bi * blockSize + i, bj * blockSize + j, randomValue(gen));
+                        }
+                    }
+                }
+            }
+            operand.matrix.reset(block);
+        } else if (kind == "Kronecker") {
+            operand.matrix.reset(new MatrixKronecker<T>(randomDense(3, 3, gen), randomDense(n / 3, n / 3, gen)));
+        } else if (kind == "View") {
+            // Участок большей матрицы: шаг строк больше числа столбцов
+            operand.storage = std::make_shared<MatrixDense<T>>(randomDense(n + 4, n + 2, gen));
+            operand.matrix.reset(new MatrixView<T>(operand.storage->view(2, 1, n, n)));
+        } else if (kind == "ViewT") {
+            // Представление с шагом по столбцам: быстрые пути для непрерывных строк неприменимы
+            operand.storage = std::make_shared<MatrixDense<T>>(randomDense(n, n + 2, gen));
+            operand.matrix.reset(new MatrixView<T>(n, n, operand.storage->rawData(), 1, n + 2));
+        } else if (kind == "Sparse") {
+            std::uniform_int_distribution<unsigned> column(0, n - 1);
+            std::vector<MatrixTriplet<T>> triplets;
+            for (unsigned i = 0; i < n; ++i) {
+                for (unsigned k = 0; k < 3; ++k) {
+                    triplets.push_back({i, column(gen), randomValue(gen)});
+                }
+            }
+            operand.matrix.reset(new MatrixSparseCSR<T>(n, n, triplets));
+        } else if (kind == "Banded") {
+            MatrixBanded<T>* banded = new MatrixBanded<T>(n, 2, 1);
+            for (unsigned i = 0; i < n; ++i) {
+                for (unsigned j = i > 2 ? i - 2 : 0; j < std::min(n, i + 2); ++j) {
+                    (*banded)(i, j) = randomValue(gen);
+                }
+            }
+            operand.matrix.reset(banded);
+        } else {
+            throw std::invalid_argument("Неизвестный вид матрицы " + kind);
+        }
+        return operand;
+    }
+
+    // Пустая матрица того же вида для чтения из файла
+    static std::unique_ptr<Matrix<T>> blank(const std::string& kind, unsigned size) {
+        if (kind == "Dense") return std::unique_ptr<Matrix<T>>(new MatrixDense<T>(0, 0));
+        if (kind == "Diagonal") return std::unique_ptr<Matrix<T>>(new MatrixDiagonal<T>(0));
+        if (kind == "Block" || kind == "Block3") return std::unique_ptr<Matrix<T>>(new MatrixBlock<T>(0, 0, 1, 1));
+        if (kind == "Kronecker") return std::unique_ptr<Matrix<T>>(new MatrixKronecker<T>(MatrixDense<T>(1, 1), MatrixDense<T>(1, 1)));
+        if (kind == "Sparse") return std::unique_ptr<Matrix<T>>(new MatrixSparseCSR<T>(0, 0));
+        if (kind == "Banded") return std::unique_ptr<Matrix<T>>(new MatrixBanded<T>(0, 0, 0));
+        return std::unique_ptr<Matrix<T>>(new MatrixDense<T>(size, size));
+    }
+
+    static double tolerance() {
+        return std::numeric_limits<T>::is_integer ? 0.0 : std::sqrt(static_cast<double>(std::numeric_limits<T>::epsilon()));
+    }
+
+    // Начальное содержимое out для операций с beta: при beta == 0 - NaN (для целых - мусор),
+    // чтобы чтение out, которого не должно быть, меняло результат
+    static void prefill(MatrixDense<T>& out, T beta) {
+        for (unsigned i = 0; i < out.rows(); ++i) {
+            for (unsigned j = 0; j < out.cols(); ++j) {
+                out(i, j) = beta == T() && std::numeric_limits<T>::has_quiet_NaN ? std::numeric_limits<T>::quiet_NaN()
+                                                                                   : static_cast<T>(static_cast<int>(i + 2 * j) % 7 - 3);
+            }
+        }
+    }
+
+    void fail(const std::string& what, const std::string& detail) {
+        ++failures;
+        std::printf("FAIL %-7s t=%-2u %s: %s\n", type.c_str(), threads, what.c_str(), detail.c_str());
+    }
+
+    // Поэлементное сравнение; expected(i, j) - ожидаемое значение
+    void compare(const std::string& what, const Matrix<T>& actual, unsigned m, unsigned k, const std::function<T(unsigned, unsigned)>& expected) {
+        ++checks;
+        if (actual.rows() != m || actual.cols() != k) {
+            fail(what, "размер " + std::to_string(actual.rows()) + "x" + std::to_string(actual.cols()) +
+                       ", ожидался " + std::to_string(m) + "x" + std::to_string(k));
+            return;
+        }
+        for (unsigned i = 0; i < m; ++i) {
+            for (unsigned j = 0; j < k; ++j) {
+                double got = static_cast<double>(actual(i, j));
+                double want = static_cast<double>(expected(i, j));
+                if (!(std::fabs(got - want) <= tolerance() * (1 + std::fabs(want)))) {
+                    std::ostringstream detail;
+                    detail << "(" << i << ", " << j << ") = " << got << ", ожидалось " << want;
+                    fail(what, detail.str());
+                    return;
+                }
+            }
+        }
+    }
+
+    void compare(const std::string& what, const Matrix<T>& actual, const Matrix<T>& expected) {
+        compare(what, actual, expected.rows(), expected.cols(), [&](unsigned i, unsigned j) { return expected(i, j); });
+        // Разреженный результат не хранит нулей, в том числе взаимно сократившихся сумм
+        if (actual.kind() == MatrixKind::Sparse) {
+            const MatrixSparseCSR<T>& sparse = static_cast<const MatrixSparseCSR<T>&>(actual);
+            ++checks;
+            if (MatrixSimd::hasZero(sparse.values(), sparse.nonZeros())) {
+                fail(what, "разреженный результат хранит нули");
+            }
+        }
+    }
+
+    // Операция, которая не должна бросать исключение
+    void guarded(const std::string& what, const std::function<void()>& body) {
+        try {
+            body();
+        } catch (const std::exception& e) {
+            ++checks;
+            fail(what, std::string("исключение: ") + e.what());
+        }
+    }
+
+    // Бинарные операции пары видов: операторы, операции с готовым out и на месте
+    void checkPair(const std::string& left, const std::string& right) {
+        CheckOperand<T> a = make(left), b = make(right);
+        const Matrix<T>& A = *a.matrix;
+        const Matrix<T>& B = *b.matrix;
+        std::string pair = left + " " + right;
+
+        MatrixDense<T> sum(n, n), difference(n, n), product(n, n), elementwise(n, n);
+        A.Matrix<T>::addInto(B, sum);
+        A.Matrix<T>::subtractInto(B, difference);
+        A.Matrix<T>::multiplyInto(B, product);
+        A.Matrix<T>::elemMultInto(B, elementwise);
+
+        guarded(pair + " +", [&] { std::unique_ptr<Matrix<T>> r(A + B); compare(pair + " +", *r, sum); });
+        guarded(pair + " -", [&] { std::unique_ptr<Matrix<T>> r(A - B); compare(pair + " -", *r, difference); });
+        guarded(pair + " *", [&] { std::unique_ptr<Matrix<T>> r(A * B); compare(pair + " *", *r, product); });
+        guarded(pair + " elemMult", [&] { std::unique_ptr<Matrix<T>> r(A.elemMult(B)); compare(pair + " elemMult", *r, elementwise); });
+
+        // Деление: делитель с нулями должен отвергаться. У диагонального делимого результат
+        // диагональный, поэтому важны только диагональные элементы делителя
+        bool diagonal = left == "Diagonal";
+        bool zero = false;
+        for (unsigned i = 0; i < n; ++i) {
+            for (unsigned j = 0; j < n; ++j) {
+                zero = zero || ((!diagonal || i == j) && B(i, j) == T());
+            }
+        }
+        ++checks;
+        if (zero) {
+            try {
+                std::unique_ptr<Matrix<T>> r(A.elemDiv(B));
+                fail(pair + " elemDiv", "деление на матрицу с нулями не отвергнуто");
+            } catch (const std::exception&) {
+            }
+        } else {
+            guarded(pair + " elemDiv", [&] {
+                std::unique_ptr<Matrix<T>> r(A.elemDiv(B));
+                compare(pair + " elemDiv", *r, n, n, [&](unsigned i, unsigned j) { return diagonal && i != j ? T() : A(i, j) / B(i, j); });
+            });
+        }
+
+        // Операции с готовым out: alpha и beta, в том числе beta == 0 без чтения out
+        const T scales[][2] = {{T(1), T()}, {T(2), T(-1)}};
+        for (const auto& scale : scales) {
+            T alpha = scale[0], beta = scale[1];
+            std::string suffix = " Into(" + std::to_string(static_cast<int>(alpha)) + ", " + std::to_string(static_cast<int>(beta)) + ")";
+            // Быстрый путь - виртуальный вызов, эталон - явный вызов версии Matrix<T>
+            using Into = std::function<void(MatrixDense<T>&, bool)>;
+            const std::pair<const char*, Into> operations[] = {
+                {"multiply", [&](MatrixDense<T>& out, bool base) { base ? A.Matrix<T>::multiplyInto(B, out, alpha, beta) : A.multiplyInto(B, out, alpha, beta); }},
+                {"add", [&](MatrixDense<T>& out, bool base) { base ? A.Matrix<T>::addInto(B, out, alpha, beta) : A.addInto(B, out, alpha, beta); }},
+                {"subtract", [&](MatrixDense<T>& out, bool base) { base ? A.Matrix<T>::subtractInto(B, out, alpha, beta) : A.subtractInto(B, out, alpha, beta); }},
+                {"elemMult", [&](MatrixDense<T>& out, bool base) { base ? A.Matrix<T>::elemMultInto(B, out, alpha, beta) : A.elemMultInto(B, out, alpha, beta); }}};
+            for (const auto& operation : operations) {
+                std::string what = pair + " " + operation.first + suffix;
+                MatrixDense<T> out(n, n), expected(n, n);
+                prefill(out, beta);
+                prefill(expected, T(1));
+                operation.second(expected, true);
+                guarded(what, [&] { operation.second(out, false); compare(what, out, expected); });
+            }
+        }
+
+        // На месте: Dense, Block, Sparse и View хранят полный результат, Diagonal и Banded -
+        // его часть в своей структуре, Kronecker на месте не изменяется
+        if (left == "Kronecker") {
+            return;
+        }
+        for (int sign : {1, -1}) {
+            std::string what = pair + (sign > 0 ? " +=" : " -=");
+            CheckOperand<T> target = make(left);
+            const MatrixDense<T>& full = sign > 0 ? sum : difference;
+            guarded(what, [&] {
+                if (sign > 0) {
+                    *target.matrix += B;
+                } else {
+                    *target.matrix -= B;
+                }
+                compare(what, *target.matrix, n, n, [&](unsigned i, unsigned j) {
+                    bool kept = left == "Diagonal" ? i == j : left == "Banded" ? j + 2 >= i && j <= i + 1 : true;
+                    return kept ? full(i, j) : A(i, j);
+                });
+            });
+        }
+    }
+
+    // Унарные операции вида: транспонирование, умножение на векторы, текстовый и двоичный форматы
+    void checkSingle(const std::string& kind) {
+        CheckOperand<T> a = make(kind);
+        const Matrix<T>& A = *a.matrix;
+
+        MatrixDense<T> transposed(n, n);
+        A.Matrix<T>::transposeInto(transposed);
+        guarded(kind + " transpose", [&] { std::unique_ptr<Matrix<T>> r(A.transpose()); compare(kind + " transpose", *r, transposed); });
+        {
+            MatrixDense<T> out(n, n), expected(n, n);
+            prefill(out, T(-1));
+            prefill(expected, T(-1));
+            A.Matrix<T>::transposeInto(expected, T(2), T(-1));
+            guarded(kind + " transposeInto", [&] { A.transposeInto(out, T(2), T(-1)); compare(kind + " transposeInto", out, expected); });
+        }
+
+        std::mt19937 gen(7);
+        const unsigned Batch = 5;
+        for (T beta : {T(), T(3)}) {
+            std::string suffix = beta == T() ? "(2, 0)" : "(2, 3)";
+            Vector<T> x(n), y(n), expected(n);
+            for (unsigned i = 0; i < n; ++i) {
+                x[i] = randomValue(gen);
+                y[i] = expected[i] = randomValue(gen);
+            }
+            A.Matrix<T>::gemv(T(2), x, beta, expected);
+            guarded(kind + " gemv" + suffix, [&] {
+                A.gemv(T(2), x, beta, y);
+                ++checks;
+                for (unsigned i = 0; i < n; ++i) {
+                    if (std::fabs(static_cast<double>(y[i]) - static_cast<double>(expected[i])) > tolerance() * (1 + std::fabs(static_cast<double>(expected[i])))) {
+                        fail(kind + " gemv" + suffix, "элемент " + std::to_string(i));
+                        break;
+                    }
+                }
+            });
+
+            MatrixDense<T> X = randomDense(n, Batch, gen), Y(n, Batch), batch(n, Batch);
+            prefill(Y, beta);
+            prefill(batch, T(1));
+            A.Matrix<T>::gemvBatch(T(2), X, beta, batch);
+            guarded(kind + " gemvBatch" + suffix, [&] { A.gemvBatch(T(2), X, beta, Y); compare(kind + " gemvBatch" + suffix, Y, batch); });
+        }
+
+        const std::string filename = "MatrixCheck.tmp";
+        guarded(kind + " text", [&] {
+            A.exportToFile(filename);
+            std::unique_ptr<Matrix<T>> loaded(blank(kind, n));
+            loaded->importFromFile(filename);
+            compare(kind + " text", *loaded, A);
+        });
+        guarded(kind + " binary", [&] {
+            if (kind == "Dense") {
+                roundTrip(kind + " binary", static_cast<const MatrixDense<T>&>(A), MatrixDense<T>(0, 0), filename);
+            } else if (kind == "Diagonal") {
+                roundTrip(kind + " binary", static_cast<const MatrixDiagonal<T>&>(A), MatrixDiagonal<T>(0), filename);
+            } else if (kind == "Block" || kind == "Block3") {
+                roundTrip(kind + " binary", static_cast<const MatrixBlock<T>&>(A), MatrixBlock<T>(0, 0, 1, 1), filename);
+            } else if (kind == "Banded") {
+                roundTrip(kind + " binary", static_cast<const MatrixBanded<T>&>(A), MatrixBanded<T>(0, 0, 0), filename);
+            }
+        });
+        std::remove(filename.c_str());
+    }
+
+    template <typename M>
+    void roundTrip(const std::string& what, const M& source, M loaded, const std::string& filename) {
+        source.exportToBinary(filename);
+        loaded.importFromBinary(filename);
+        compare(what, loaded, source);
+    }
+
+    // Прямоугольные произведения и схема Штрассена с пониженным порогом
+    void checkShapes() {
+        std::mt19937 gen(11);
+        MatrixDense<T> A = randomDense(13, 17, gen), B = randomDense(17, 11, gen);
+        std::vector<MatrixTriplet<T>> triplets;
+        for (unsigned k = 0; k < 40; ++k) {
+            triplets.push_back({(k * 7) % 17, (k * 5) % 11, randomValue(gen)});
+        }
+        MatrixSparseCSR<T> S(17, 11, triplets);
+        for (const Matrix<T>* right : {static_cast<const Matrix<T>*>(&B), static_cast<const Matrix<T>*>(&S)}) {
+            std::string what = right == &B ? "Dense 13x17 * Dense 17x11" : "Dense 13x17 * Sparse 17x11";
+            MatrixDense<T> expected(13, 11);
+            A.Matrix<T>::multiplyInto(*right, expected);
+            guarded(what, [&] { std::unique_ptr<Matrix<T>> r(A * *right); compare(what, *r, expected); });
+        }
+        guarded("Sparse 17x11 transpose", [&] {
+            std::unique_ptr<Matrix<T>> r(S.transpose());
+            MatrixDense<T> expected(11, 17);
+            S.Matrix<T>::transposeInto(expected);
+            compare("Sparse 17x11 transpose", *r, expected);
+        });
+
+        unsigned threshold = MatrixStrassen<T>::threshold();
+        MatrixStrassen<T>::setThreshold(8);
+        for (unsigned size : {33u, 64u}) {
+            MatrixDense<T> L = randomDense(size, size, gen), R = randomDense(size, size, gen), expected(size, size);
+            L.Matrix<T>::multiplyInto(R, expected);
+            std::string what = "Strassen " + std::to_string(size);
+            guarded(what, [&] { std::unique_ptr<Matrix<T>> r(L * R); compare(what, *r, expected); });
+        }
+        MatrixStrassen<T>::setThreshold(threshold);
+    }
+
+public:
+    Check(unsigned size, const std::string& typeName) : n(size), type(typeName) {}
+
+    void run(unsigned threadCount) {
+        threads = threadCount;
+        for (const std::string& left : kinds()) {
+            checkSingle(left);
+            for (const std::string& right : kinds()) {
+                checkPair(left, right);
+            }
+        }
+        checkShapes();
+    }
+
+    size_t checkCount() const { return checks; }
+    size_t failureCount() const { return failures; }
+};
+
+template <typename T>
+static bool runType(const CheckConfig& config, const std::string& type) {
+    Check<T> check(config.size, type);
+    for (unsigned threads : config.threads) {
+        ThreadPool::setThreadCount(threads);
+        check.run(threads);
+    }
+    std::printf("%-7s проверок: %zu, расхождений: %zu\n", type.c_str(), check.checkCount(), check.failureCount());
+    return check.failureCount() == 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        CheckConfig config = parseArguments(argc, argv);
+        bool passed = true;
+        for (const std::string& type : config.types) {
+            if (type == "double") {
+                passed = runType<double>(config, type) && passed;
+            } else if (type == "float") {
+                passed = runType<float>(config, type) && passed;
+            } else if (type == "int") {
+                passed = runType<int>(config, type) && passed;
+            } else {
+                throw std::invalid_argument("Неподдерживаемый тип элементов " + type);
+            }
+        }
+        return passed ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -4,48 +4,141 @@
 #define MATRIXDENSE_H
 
 #include "Matrix.h"
+#include "MatrixGemm.h"
+#include "ThreadPool.h"
+#include "MatrixBinary.h"
+#include "MatrixText.h"
+#include "MatrixExpr.h"
+#include "MatrixAllocator.h"
+#include "MatrixSimd.h"
+#include "MatrixTranspose.h"
+#include "MatrixStrassen.h"
+#include "MatrixTrace.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <memory>
+
+// Есть ли среди элементов матрицы нули; используется для проверки делителя до начала деления
+template <typename T>
+bool hasZeroElement(const Matrix<T>& other) {
+    switch (other.kind()) {
+    case MatrixKind::Dense: {
+        const MatrixDense<T>& dense = static_cast<const MatrixDense<T>&>(other);
+        const T* values = dense.rawData();
+        size_t count = static_cast<size_t>(dense.rows()) * dense.cols();
+        // Векторная проверка по частям; найденный ноль останавливает остальные части
+        std::atomic<bool> found(false);
+        ThreadPool::instance().parallelFor(0, count, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+            if (!found.load(std::memory_order_relaxed) && MatrixSimd::hasZero(values + from, to - from)) {
+                found.store(true, std::memory_order_relaxed);
+            }
+        });
+        return found.load();
+    }
+    case MatrixKind::Diagonal: {
+        const MatrixDiagonal<T>& diagonal = static_cast<const MatrixDiagonal<T>&>(other);
+        const T* values = diagonal.rawData();
+        return diagonal.rows() > 1 || MatrixSimd::hasZero(values, diagonal.rows());
+    }
+    case MatrixKind::Block:
+        return static_cast<const MatrixBlock<T>&>(other).hasZero();
+    case MatrixKind::Kronecker: {
+        // Элемент произведения Кронекера равен нулю, только если нулевой один из множителей
+        const MatrixKronecker<T>& kron = static_cast<const MatrixKronecker<T>&>(other);
+        return hasZeroElement(kron.left()) || hasZeroElement(kron.right());
+    }
+    case MatrixKind::Sparse: {
+        // Нули вне структуры есть, если хранятся не все элементы
+        const MatrixSparseCSR<T>& sparse = static_cast<const MatrixSparseCSR<T>&>(other);
+        return sparse.nonZeros() < static_cast<size_t>(sparse.rows()) * sparse.cols() || MatrixSimd::hasZero(sparse.values(), sparse.nonZeros());
+    }
+    case MatrixKind::Banded:
+        return static_cast<const MatrixBanded<T>&>(other).hasZero();
+    default:
+        for (unsigned i = 0; i < other.rows(); ++i) {
+            for (unsigned j = 0; j < other.cols(); ++j) {
+                if (other(i, j) == T()) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
 
 template <typename T = double>
 class MatrixDense : public Matrix<T> {
 private:
     unsigned _m, _n;
     T* data;
+    // Внешний владелец хранилища (например, отображённый в память файл);
+    // если задан, data не возвращается в MatrixStorage
+    std::shared_ptr<void> _owner;
+
+    size_t elementCount() const { return static_cast<size_t>(_m) * _n; }
+
+    void release() {
+        if (!_owner) {
+            MatrixStorage<T>::deallocate(data, elementCount());
+        }
+        _owner.reset();
+        data = nullptr;
+    }
 
 public:
     // Конструктор
     MatrixDense(unsigned m, unsigned n) : _m(m), _n(n) {
-        data = new T[_m * _n]();
+        data = MatrixStorage<T>::allocate(elementCount());
+    }
+
+    // Конструктор без обнуления: для результатов, которые будут полностью перезаписаны
+    MatrixDense(unsigned m, unsigned n, MatrixUninitialized) : _m(m), _n(n) {
+        data = MatrixStorage<T>::allocate(elementCount(), false);
     }
 
+    // Матрица над чужим хранилищем values (например, общим буфером блоков MatrixBlock):
+    // owner продлевает жизнь хранилища, сама матрица его не освобождает
+    MatrixDense(unsigned m, unsigned n, T* values, std::shared_ptr<void> owner)
+        : _m(m), _n(n), data(values), _owner(std::move(owner)) {}
+
     // Конструктор копирования
     MatrixDense(const MatrixDense<T>& other) : _m(other._m), _n(other._n) {
-        data = new T[_m * _n];
-        std::copy(other.data, other.data + _m * _n, data);
+        data = MatrixStorage<T>::allocate(elementCount(), false);
+        std::copy(other.data, other.data + elementCount(), data);
     }
 
     // Конструктор перемещения
-    MatrixDense(MatrixDense<T>&& other) noexcept : _m(other._m), _n(other._n), data(other.data) {
+    MatrixDense(MatrixDense<T>&& other) noexcept
+        : _m(other._m), _n(other._n), data(other.data), _owner(std::move(other._owner)) {
         other.data = nullptr;
         other._m = other._n = 0;
     }
 
+    // Конструктор из ленивого выражения: вычисление за один проход
+    template <typename E>
+    MatrixDense(const MatrixExpr<E, T>& expr) : _m(expr.rows()), _n(expr.cols()) {
+        data = MatrixStorage<T>::allocate(elementCount(), false);
+        evaluateExpr(expr, data);
+    }
+
     // Деструктор
     ~MatrixDense() {
-        delete[] data;
+        release();
     }
 
     // Оператор присваивания
     MatrixDense<T>& operator=(const MatrixDense<T>& other) {
         if (this != &other) {
-            delete[] data;
-            _m = other._m;
-            _n = other._n;
-            data = new T[_m * _n];
-            std::copy(other.data, other.data + _m * _n, data);
+            // Хранилище той же формы переиспользуется
+            if (_owner || _m != other._m || _n != other._n) {
+                release();
+                _m = other._m;
+                _n = other._n;
+                data = MatrixStorage<T>::allocate(elementCount(), false);
+            }
+            std::copy(other.data, other.data + elementCount(), data);
         }
         return *this;
     }
@@ -53,19 +146,44 @@ public:
     // Оператор перемещающего присваивания
     MatrixDense<T>& operator=(MatrixDense<T>&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            release();
             _m = other._m;
             _n = other._n;
             data = other.data;
+            _owner = std::move(other._owner);
             other.data = nullptr;
             other._m = other._n = 0;
         }
         return *this;
     }
 
+    // Присваивание ленивого выражения; при совпадении размеров хранилище переиспользуется,
+    // поэтому выражение может ссылаться на саму матрицу (A = lazy(A) + lazy(B))
+    template <typename E>
+    MatrixDense<T>& operator=(const MatrixExpr<E, T>& expr) {
+        if (expr.rows() == _m && expr.cols() == _n) {
+            evaluateExpr(expr, data);
+            return *this;
+        }
+
+        T* values = MatrixStorage<T>::allocate(static_cast<size_t>(expr.rows()) * expr.cols(), false);
+        evaluateExpr(expr, values);
+        release();
+        _m = expr.rows();
+        _n = expr.cols();
+        data = values;
+        return *this;
+    }
+
     unsigned rows() const override { return _m; }
     unsigned cols() const override { return _n; }
 
+    MatrixKind kind() const override { return MatrixKind::Dense; }
+
+    // Непосредственный доступ к хранилищу (построчно, _m * _n элементов)
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+
     // Доступ к элементам
     T& operator()(unsigned i, unsigned j) {
         return data[i * _n + j];
@@ -75,182 +193,636 @@ public:
         return data[i * _n + j];
     }
 
+    // Представления части хранилища без копирования (см. MatrixView): подматрица m x n
+    // с углом (row, col), строка, столбец и главная диагональ; у константной матрицы -
+    // только для чтения. Представление действительно, пока матрица не изменила размер
+    MatrixView<T> view(unsigned row, unsigned col, unsigned m, unsigned n) {
+        return MatrixView<T>(_m, _n, data, _n).view(row, col, m, n);
+    }
+
+    const MatrixView<T> view(unsigned row, unsigned col, unsigned m, unsigned n) const {
+        return const_cast<MatrixDense<T>*>(this)->view(row, col, m, n);
+    }
+
+    MatrixView<T> rowView(unsigned i) {
+        return view(i, 0, 1, _n);
+    }
+
+    const MatrixView<T> rowView(unsigned i) const {
+        return view(i, 0, 1, _n);
+    }
+
+    MatrixView<T> columnView(unsigned j) {
+        return MatrixView<T>(_m, _n, data, _n).columnView(j);
+    }
+
+    const MatrixView<T> columnView(unsigned j) const {
+        return const_cast<MatrixDense<T>*>(this)->columnView(j);
+    }
+
+    MatrixView<T> diagonalView() {
+        return MatrixView<T>(_m, _n, data, _n).diagonalView();
+    }
+
+    const MatrixView<T> diagonalView() const {
+        return const_cast<MatrixDense<T>*>(this)->diagonalView();
+    }
+
+private:
+    // out = op(this, other) поэлементно; ядро выбирается по виду other, out может совпадать с this.
+    // Непрерывные участки обрабатываются векторными ядрами MatrixSimd
+    template <typename Op>
+    void combine(const Matrix<T>& other, MatrixDense<T>& out, Op op) const {
+        ThreadPool& pool = ThreadPool::instance();
+        const T* a = data;
+        T* c = out.data;
+
+        switch (other.kind()) {
+        case MatrixKind::Dense: {
+            const T* b = static_cast<const MatrixDense<T>&>(other).data;
+            pool.parallelFor(0, static_cast<size_t>(_m) * _n, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                MatrixSimd::apply(op, a + from, b + from, c + from, to - from);
+            });
+            return;
+        }
+        case MatrixKind::Diagonal: {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    size_t row = i * _n;
+                    for (size_t j = 0; j < _n; ++j) {
+                        c[row + j] = op(a[row + j], i == j ? d[i] : T());
+                    }
+                }
+            });
+            return;
+        }
+        case MatrixKind::Block: {
+            const MatrixBlock<T>& block = static_cast<const MatrixBlock<T>&>(other);
+            unsigned bm = block.blockSizeM(), bn = block.blockSizeN();
+            pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    size_t row = i * _n;
+                    unsigned bi = static_cast<unsigned>(i / bm);
+                    unsigned local = static_cast<unsigned>(i % bm);
+                    for (unsigned bj = 0; bj < block.blockCols(); ++bj) {
+                        const MatrixDense<T>* src = block.block(bi, bj);
+                        size_t col = static_cast<size_t>(bj) * bn;
+                        if (src) {
+                            const T* b = src->data + static_cast<size_t>(local) * bn;
+                            MatrixSimd::apply(op, a + row + col, b, c + row + col, bn);
+                        } else {
+                            for (unsigned j = 0; j < bn; ++j) {
+                                c[row + col + j] = op(a[row + col + j], T());
+                            }
+                        }
+                    }
+                }
+            });
+            return;
+        }
+        case MatrixKind::View: {
+            // Представление с построчно непрерывными элементами - векторное ядро по строкам
+            size_t stride;
+            if (const T* b = MatrixView<T>::rowStorage(other, stride)) {
+                pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                    for (size_t i = from; i < to; ++i) {
+                        MatrixSimd::apply(op, a + i * _n, b + i * stride, c + i * _n, _n);
+                    }
+                });
+                return;
+            }
+            break;
+        }
+        case MatrixKind::Sparse: {
+            // Строка other проходится вместе со строкой this: вне структуры элемент other нулевой
+            const MatrixSparseCSR<T>& sparse = static_cast<const MatrixSparseCSR<T>&>(other);
+            const size_t* start = sparse.rowStart();
+            const unsigned* columns = sparse.columnIndex();
+            const T* values = sparse.values();
+            pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    size_t row = i * _n, k = start[i];
+                    for (unsigned j = 0; j < _n; ++j) {
+                        T b = k < start[i + 1] && columns[k] == j ? values[k++] : T();
+                        c[row + j] = op(a[row + j], b);
+                    }
+                }
+            });
+            return;
+        }
+        case MatrixKind::Banded: {
+            // Вне ленты элемент other нулевой, лента строки - непрерывный участок хранилища
+            const MatrixBanded<T>& band = static_cast<const MatrixBanded<T>&>(other);
+            const T* b = band.rawData();
+            unsigned width = band.width(), lower = band.lower();
+            pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                    size_t row = static_cast<size_t>(i) * _n;
+                    unsigned first = band.first(i), last = band.last(i);
+                    for (unsigned j = 0; j < first; ++j) {
+                        c[row + j] = op(a[row + j], T());
+                    }
+                    MatrixSimd::apply(op, a + row + first, b + static_cast<size_t>(i) * width + first + lower - i, c + row + first, last - first);
+                    for (unsigned j = last; j < _n; ++j) {
+                        c[row + j] = op(a[row + j], T());
+                    }
+                }
+            });
+            return;
+        }
+        default:
+            break;
+        }
+
+        pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                size_t row = static_cast<size_t>(i) * _n;
+                for (unsigned j = 0; j < _n; ++j) {
+                    c[row + j] = op(a[row + j], other(i, j));
+                }
+            }
+        });
+    }
+
+    // out = alpha * op(this, other) + beta * out: при beta == 0 - векторное ядро combine
+    // и масштабирование, иначе один проход по строкам
+    template <typename Op>
+    void blend(const Matrix<T>& other, MatrixDense<T>& out, Op op, T alpha, T beta) const {
+        if (_m != other.rows() || _n != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        this->checkInto(other, out, _m, _n, false);
+
+        ThreadPool& pool = ThreadPool::instance();
+        if (beta == T()) {
+            combine(other, out, op);
+            if (alpha != T(1)) {
+                T* c = out.data;
+                pool.parallelFor(0, elementCount(), ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                    MatrixSimd::scale(c + from, alpha, c + from, to - from);
+                });
+            }
+            return;
+        }
+
+        const T* a = data;
+        size_t stride = 0;
+        const T* b = MatrixView<T>::rowStorage(other, stride);
+        T* c = out.data;
+        pool.parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                size_t row = static_cast<size_t>(i) * _n;
+                for (unsigned j = 0; j < _n; ++j) {
+                    T value = op(a[row + j], b ? b[i * stride + j] : other(i, j));
+                    c[row + j] = alpha * value + beta * c[row + j];
+                }
+            }
+        });
+    }
+
+    // c = alpha * this * other + beta * c (c построчно, шаг other.cols()) для блочного
+    // и кронекерова other; для остальных видов возвращает false
+    bool multiplyStructured(const Matrix<T>& other, T alpha, T beta, T* c) const {
+        unsigned n = other.cols();
+        if (other.kind() == MatrixKind::Block) {
+            // Зеркало MatrixBlock::multiplyDense: столбец блоков результата набирается
+            // из присутствующих блоков этого столбца, отсутствующие пропускаются
+            const MatrixBlock<T>& block = static_cast<const MatrixBlock<T>&>(other);
+            static constexpr unsigned Panel = 256;
+            unsigned sizeM = block.blockSizeM(), sizeN = block.blockSizeN();
+            unsigned panels = std::max(1u, (_m + Panel - 1) / Panel);
+            ThreadPool::instance().parallelFor(0, static_cast<size_t>(block.blockCols()) * panels, 1, [&](size_t from, size_t to) {
+                for (size_t index = from; index < to; ++index) {
+                    unsigned j = static_cast<unsigned>(index / panels);
+                    unsigned row = static_cast<unsigned>(index % panels) * Panel;
+                    unsigned height = std::min(Panel, _m - row);
+                    T* target = c + static_cast<size_t>(row) * n + static_cast<size_t>(j) * sizeN;
+                    T scale = beta;
+                    for (unsigned k = 0; k < block.blockRows(); ++k) {
+                        const MatrixDense<T>* right = block.block(k, j);
+                        if (!right) {
+                            continue;
+                        }
+                        MatrixGemm<T>::multiply(height, sizeN, sizeM, alpha, data + static_cast<size_t>(row) * _n + static_cast<size_t>(k) * sizeM, _n,
+                                                right->rawData(), sizeN, scale, target, n);
+                        scale = T(1);
+                    }
+                    // Столбец блоков без единого блока: остаётся beta * c
+                    if (scale != T(1)) {
+                        for (unsigned r = 0; r < height; ++r) {
+                            T* line = target + static_cast<size_t>(r) * n;
+                            if (scale == T()) {
+                                std::fill(line, line + sizeN, T());
+                            } else {
+                                MatrixSimd::scale(line, scale, line, sizeN);
+                            }
+                        }
+                    }
+                }
+            });
+            return true;
+        }
+        if (other.kind() == MatrixKind::Kronecker) {
+            // (this * K)^T = K^T * this^T, K^T = A^T ⊗ B^T: смешанное произведение
+            // MatrixKronecker над транспонированным this, результат транспонируется обратно
+            std::unique_ptr<Matrix<T>> kronecker(other.transpose());
+            std::unique_ptr<MatrixDense<T>> transposed(transpose());
+            MatrixDense<T> product(n, _m, MatrixUninitialized());
+            kronecker->multiplyInto(*transposed, product, alpha, T());
+            if (beta == T()) {
+                MatrixTranspose<T>::transpose(n, _m, product.data, _m, c, n);
+                return true;
+            }
+            MatrixDense<T> back(_m, n, MatrixUninitialized());
+            MatrixTranspose<T>::transpose(n, _m, product.data, _m, back.data, n);
+            ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(n), [&](size_t from, size_t to) {
+                for (size_t k = from * n; k < to * n; ++k) {
+                    c[k] = back.data[k] + beta * c[k];
+                }
+            });
+            return true;
+        }
+        return false;
+    }
+
+public:
     // Операции с матрицами
     Matrix<T>& operator+=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixDense::operator+=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                (*this)(i, j) += other(i, j);
-            }
-        }
+        combine(other, *this, MatrixSimdAdd());
         return *this;
     }
 
     Matrix<T>& operator-=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixDense::operator-=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                (*this)(i, j) -= other(i, j);
-            }
-        }
+        combine(other, *this, MatrixSimdSub());
         return *this;
     }
 
     // Оператор сложения
     Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::operator+", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
-
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) + other(i, j);
-            }
-        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, *result, MatrixSimdAdd());
         return result;
     }
 
     // Оператор вычитания
     Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::operator-", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
-
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) - other(i, j);
-            }
-        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, *result, MatrixSimdSub());
         return result;
     }
 
     // Матричное умножение
     Matrix<T>* operator*(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::operator*", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 1.0 * rows() * other.cols()));
         if (_n != other.rows()) {
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols());
+        // Оба операнда плотные - блочное ядро по непрерывным буферам
+        if (other.kind() == MatrixKind::Dense) {
+            const MatrixDense<T>& dense = static_cast<const MatrixDense<T>&>(other);
+            MatrixDense<T>* result = new MatrixDense<T>(_m, dense._n, MatrixUninitialized());
+            // Большие квадратные произведения - по схеме Штрассена-Винограда
+            if (_m == _n && dense._n == _n && _n >= MatrixStrassen<T>::threshold()) {
+                MatrixStrassen<T>::multiply(_n, data, _n, dense.data, _n, result->data, _n);
+                return result;
+            }
+            MatrixGemm<T>::multiply(_m, dense._n, _n, T(1), data, _n, dense.data, dense._n, T(), result->data, dense._n);
+            return result;
+        }
 
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                T sum = T();
-                for (unsigned k = 0; k < _n; ++k) {
-                    sum += (*this)(i, k) * other(k, j);
+        // Представление с построчно непрерывными элементами - то же ядро с шагом строк представления
+        size_t stride;
+        if (const T* b = MatrixView<T>::rowStorage(other, stride)) {
+            MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+            MatrixGemm<T>::multiply(_m, other.cols(), _n, T(1), data, _n, b, static_cast<unsigned>(stride), T(), result->data, other.cols());
+            return result;
+        }
+
+        // Разреженный и ленточный множители - накопление их строк с весами из строк this
+        if (other.kind() == MatrixKind::Sparse) {
+            MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+            static_cast<const MatrixSparseCSR<T>&>(other).multiplyLeft(data, _n, _m, T(1), T(), result->data, other.cols());
+            return result;
+        }
+
+        if (other.kind() == MatrixKind::Banded) {
+            MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+            static_cast<const MatrixBanded<T>&>(other).multiplyLeft(data, _n, _m, T(1), T(), result->data, other.cols());
+            return result;
+        }
+
+        // Умножение на диагональную матрицу справа - масштабирование столбцов
+        if (other.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+            ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    MatrixSimd::apply(MatrixSimdMul(), data + i * _n, d, result->data + i * _n, _n);
                 }
-                (*result)(i, j) = sum;
-            }
+            });
+            return result;
+        }
+
+        MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+        // Блочный и кронекеров множители - по их структуре
+        if (multiplyStructured(other, T(1), T(), result->data)) {
+            return result;
         }
+
+        // Прочие наследники Matrix<T> - через виртуальный доступ к элементам
+        ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(static_cast<size_t>(_n) * other.cols()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < other.cols(); ++j) {
+                    T sum = T();
+                    for (unsigned k = 0; k < _n; ++k) {
+                        sum += (*this)(i, k) * other(k, j);
+                    }
+                    (*result)(i, j) = sum;
+                }
+            }
+        });
         return result;
     }
 
     // Почленное умножение
     Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::elemMult", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
-
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(i, j) = (*this)(i, j) * other(i, j);
-            }
-        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, *result, MatrixSimdMul());
         return result;
     }
 
     // Почленное деление
     Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::elemDiv", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
         if (_m != other.rows() || _n != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного деления.");
         }
-
-        MatrixDense<T>* result = new MatrixDense<T>(_m, _n);
-
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                if (other(i, j) == T()) {
-                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
-                }
-                result->operator()(i, j) = (*this)(i, j) / other(i, j);
-            }
+        if (hasZeroElement(other)) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
         }
+
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, *result, MatrixSimdDiv());
         return result;
     }
 
     // Транспонирование
     MatrixDense<T>* transpose() const override {
-        MatrixDense<T>* result = new MatrixDense<T>(_n, _m);
+        MATRIX_TRACE_SCOPE("MatrixDense::transpose", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        MatrixDense<T>* result = new MatrixDense<T>(_n, _m, MatrixUninitialized());
+        MatrixTranspose<T>::transpose(_m, _n, data, _n, result->data, _m);
+        return result;
+    }
+
+    // Операции с результатом в готовой матрице (см. Matrix<T>::multiplyInto)
+
+    // out = alpha * this * other + beta * out: плотный other (или представление с непрерывными
+    // строками) - блочным ядром сразу с alpha и beta, диагональный - масштабированием столбцов,
+    // разреженный и ленточный - накоплением их строк
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::multiplyInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 2.0 * rows() * other.cols()));
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, _m, other.cols(), true);
+
+        size_t stride;
+        if (const T* b = MatrixView<T>::rowStorage(other, stride)) {
+            MatrixGemm<T>::multiply(_m, other.cols(), _n, alpha, data, _n, b, static_cast<unsigned>(stride), beta, out.data, other.cols());
+            return;
+        }
+        if (other.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(other).rawData();
+            ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    const T* a = data + i * _n;
+                    T* c = out.data + i * _n;
+                    for (unsigned j = 0; j < _n; ++j) {
+                        c[j] = beta == T() ? alpha * a[j] * d[j] : alpha * a[j] * d[j] + beta * c[j];
+                    }
+                }
+            });
+            return;
+        }
+        if (other.kind() == MatrixKind::Sparse) {
+            static_cast<const MatrixSparseCSR<T>&>(other).multiplyLeft(data, _n, _m, alpha, beta, out.data, other.cols());
+            return;
+        }
+        if (other.kind() == MatrixKind::Banded) {
+            static_cast<const MatrixBanded<T>&>(other).multiplyLeft(data, _n, _m, alpha, beta, out.data, other.cols());
+            return;
+        }
+        if (multiplyStructured(other, alpha, beta, out.data)) {
+            return;
+        }
+        Matrix<T>::multiplyInto(other, out, alpha, beta);
+    }
+
+    void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::addInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blend(other, out, MatrixSimdAdd(), alpha, beta);
+    }
+
+    void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::subtractInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blend(other, out, MatrixSimdSub(), alpha, beta);
+    }
 
-        for (unsigned i = 0; i < _m; ++i) {
+    void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::elemMultInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        blend(other, out, MatrixSimdMul(), alpha, beta);
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::transposeInto", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        this->checkInto(*this, out, _n, _m, true);
+        if (alpha == T(1) && beta == T()) {
+            MatrixTranspose<T>::transpose(_m, _n, data, _n, out.data, _m);
+            return;
+        }
+        // Полосы по Task строк источника: каждая полоса пишет свои столбцы out
+        static constexpr unsigned Task = 64;
+        ThreadPool::instance().parallelFor(0, (_m + Task - 1) / Task, 1, [&](size_t from, size_t to) {
             for (unsigned j = 0; j < _n; ++j) {
-                result->operator()(j, i) = (*this)(i, j);
+                T* c = out.data + static_cast<size_t>(j) * _m;
+                for (size_t i = from * Task; i < std::min<size_t>(to * Task, _m); ++i) {
+                    T value = alpha * data[i * _n + j];
+                    c[i] = beta == T() ? value : value + beta * c[i];
+                }
             }
+        });
+    }
+
+    // Транспонирование квадратной матрицы на месте, без второго буфера
+    void transposeInPlace() {
+        MATRIX_TRACE_SCOPE("MatrixDense::transposeInPlace", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        if (_m != _n) {
+            throw std::invalid_argument("Транспонирование на месте возможно только для квадратной матрицы.");
         }
-        return result;
+        MatrixTranspose<T>::transposeInPlace(_n, data, _n);
     }
 
+    // y = alpha * A * x + beta * y: строки обрабатываются параллельно векторным скалярным произведением
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::gemv", T, (rows(), cols(), x.size(), 1), 2.0 * rows() * cols(), sizeof(T) * (1.0 * rows() * cols() + x.size() + 2.0 * y.size()));
+        this->checkGemv(x, y);
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                T sum = alpha * MatrixSimd::dot(data + i * _n, xs, _n);
+                ys[i] = beta == T() ? sum : sum + beta * ys[i];
+            }
+        });
+    }
 
-    // Импорт из файла
-    void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
+    // Y = alpha * A * X + beta * Y. Для немногих векторов X транспонируется, и каждая строка A
+    // умножается сразу на все векторы; для широкого X - обычное произведение матриц
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::gemvBatch", T, (rows(), cols(), X.rows(), X.cols()), 2.0 * rows() * cols() * X.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * X.rows() * X.cols() + 2.0 * Y.rows() * Y.cols()));
+        this->checkGemvBatch(X, Y);
+        unsigned k = X._n;
+        if (k <= MatrixGemm<T>::NarrowWidth) {
+            MatrixDense<T> vectors(k, _n, MatrixUninitialized());
+            MatrixTranspose<T>::transpose(_n, k, X.data, k, vectors.data, _n);
+            MatrixGemm<T>::multiplyTransposed(_m, k, _n, alpha, data, _n, vectors.data, _n, beta, Y.data, k);
+            return;
         }
+        MatrixGemm<T>::multiply(_m, k, _n, alpha, data, _n, X.data, k, beta, Y.data, k);
+    }
 
-        std::string className;
-        std::getline(infile, className);
+    // Импорт из файла: числа разбираются параллельно прямо из отображённого файла
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixDense::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
 
-        if (className != "MatrixDense") {
+        if (reader.line() != "MatrixDense") {
             throw std::runtime_error("Файл не содержит данные MatrixDense.");
         }
 
-        unsigned m, n;
-        infile >> m >> n;
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
 
-        delete[] data;
-        _m = m;
-        _n = n;
-        data = new T[_m * _n];
+        MatrixDense<T> loaded(m, n, MatrixUninitialized());
+        reader.values(loaded.data, loaded.elementCount());
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * rows() * cols());
+    }
+
+    // Экспорт в файл: строки форматируются параллельно в буферы потоков
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixDense::exportToFile", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        MatrixTextWriter writer(filename);
 
-        for (unsigned i = 0; i < _m; ++i) {
+        writer.text("MatrixDense\n" + std::to_string(_m) + " " + std::to_string(_n) + "\n");
+        writer.units(_m, static_cast<size_t>(_n) * 14 + 1, [this](size_t i, std::string& buffer) {
+            const T* row = data + i * _n;
             for (unsigned j = 0; j < _n; ++j) {
-                infile >> (*this)(i, j);
+                MatrixTextValue::append(buffer, row[j]);
             }
+            buffer += '\n';
+        });
+
+        writer.close();
+    }
+
+    // Импорт из двоичного файла; при useMapping файл отображается в память
+    // и его страницы используются как хранилище без копирования
+    void importFromBinary(const std::string& filename, bool useMapping = false) {
+        MATRIX_TRACE_SCOPE("MatrixDense::importFromBinary", T, (0, 0), 0, 0);
+        if (useMapping) {
+            auto mapping = std::make_shared<MappedFile>(filename);
+            if (mapping->size() < sizeof(MatrixBinaryHeader)) {
+                throw std::runtime_error("Не удалось прочитать заголовок двоичного файла матрицы.");
+            }
+            MatrixBinaryHeader header;
+            std::memcpy(&header, mapping->data(), sizeof(header));
+            if (MatrixBinary::checkHeader<T>(header, MatrixClassTag::Dense, "MatrixDense")) {
+                throw std::runtime_error("Порядок байтов файла не позволяет отобразить его в память.");
+            }
+            size_t count = static_cast<size_t>(header.dims[0]) * header.dims[1];
+            if (header.dataOffset % alignof(T) != 0 || mapping->size() < header.dataOffset + count * sizeof(T)) {
+                throw std::runtime_error("Повреждённый двоичный файл MatrixDense.");
+            }
+
+            release();
+            _m = static_cast<unsigned>(header.dims[0]);
+            _n = static_cast<unsigned>(header.dims[1]);
+            data = reinterpret_cast<T*>(mapping->data() + header.dataOffset);
+            _owner = std::move(mapping);
+            MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * rows() * cols());
+            return;
+        }
+
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
         }
 
-        infile.close();
+        MatrixBinaryHeader header = MatrixBinary::readHeader(infile);
+        bool swap = MatrixBinary::checkHeader<T>(header, MatrixClassTag::Dense, "MatrixDense");
+        size_t count = static_cast<size_t>(header.dims[0]) * header.dims[1];
+
+        T* values = MatrixStorage<T>::allocate(count, false);
+        infile.seekg(static_cast<std::streamoff>(header.dataOffset));
+        if (!infile.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)))) {
+            MatrixStorage<T>::deallocate(values, count);
+            throw std::runtime_error("Повреждённый двоичный файл MatrixDense.");
+        }
+        if (swap) {
+            MatrixBinary::swapBytes(values, count);
+        }
+
+        release();
+        _m = static_cast<unsigned>(header.dims[0]);
+        _n = static_cast<unsigned>(header.dims[1]);
+        data = values;
+        MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * rows() * cols());
     }
 
-    // Экспорт в файл
-    void exportToFile(const std::string& filename) const override {
-        std::ofstream outfile(filename);
+    // Экспорт в двоичный файл: заголовок и одна запись всего буфера
+    void exportToBinary(const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixDense::exportToBinary", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        std::ofstream outfile(filename, std::ios::binary);
         if (!outfile) {
             throw std::runtime_error("Не удалось открыть файл для записи.");
         }
 
-        outfile << "MatrixDense\n";
-        outfile << _m << " " << _n << "\n";
-
-        for (unsigned i = 0; i < _m; ++i) {
-            for (unsigned j = 0; j < _n; ++j) {
-                outfile << (*this)(i, j) << " ";
-            }
-            outfile << "\n";
+        MatrixBinary::writeHeader(outfile, MatrixBinary::makeHeader<T>(MatrixClassTag::Dense, _m, _n));
+        outfile.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(static_cast<size_t>(_m) * _n * sizeof(T)));
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
         }
-
-        outfile.close();
     }
 
     // Метод для печати матрицы
@@ -264,4 +836,12 @@ void print(std::ostream& os = std::cout) const override {
 }
 };
 
-#endif
+// Ядра диспетчеризации обращаются к хранилищу MatrixDiagonal, MatrixBlock, MatrixKronecker и MatrixView
+#include "MatrixDiagonal.h"
+#include "MatrixBlock.h"
+#include "MatrixKronecker.h"
+#include "MatrixView.h"
+#include "MatrixSparseCSR.h"
+#include "MatrixBanded.h"
+
+#endif
\ No newline at end of file
@@ -4,10 +4,19 @@
 #define MATRIXDIAGONAL_H
 
 #include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixBlock.h"
+#include "ThreadPool.h"
+#include "MatrixBinary.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "MatrixSimd.h"
+#include "MatrixAllocator.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <memory>
 
 template <typename T = double>
 class MatrixDiagonal : public Matrix<T> {
@@ -18,12 +27,17 @@ private:
 public:
     // Конструктор
     MatrixDiagonal(unsigned size) : _size(size) {
-        data = new T[_size]();
+        data = MatrixStorage<T>::allocate(_size);
+    }
+
+    // Конструктор без обнуления: для результатов, которые будут полностью перезаписаны
+    MatrixDiagonal(unsigned size, MatrixUninitialized) : _size(size) {
+        data = MatrixStorage<T>::allocate(_size, false);
     }
 
     // Конструктор копирования
     MatrixDiagonal(const MatrixDiagonal<T>& other) : _size(other._size) {
-        data = new T[_size];
+        data = MatrixStorage<T>::allocate(_size, false);
         std::copy(other.data, other.data + _size, data);
     }
 
@@ -35,15 +49,18 @@ public:
 
     // Деструктор
     ~MatrixDiagonal() {
-        delete[] data;
+        MatrixStorage<T>::deallocate(data, _size);
     }
 
     // Оператор присваивания
     MatrixDiagonal<T>& operator=(const MatrixDiagonal<T>& other) {
         if (this != &other) {
-            delete[] data;
-            _size = other._size;
-            data = new T[_size];
+            // Хранилище того же размера переиспользуется
+            if (_size != other._size) {
+                MatrixStorage<T>::deallocate(data, _size);
+                _size = other._size;
+                data = MatrixStorage<T>::allocate(_size, false);
+            }
             std::copy(other.data, other.data + _size, data);
         }
         return *this;
@@ -52,7 +69,7 @@ public:
     // Оператор перемещающего присваивания
     MatrixDiagonal<T>& operator=(MatrixDiagonal<T>&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            MatrixStorage<T>::deallocate(data, _size);
             _size = other._size;
             data = other.data;
             other.data = nullptr;
@@ -64,6 +81,12 @@ public:
     unsigned rows() const override { return _size; }
     unsigned cols() const override { return _size; }
 
+    MatrixKind kind() const override { return MatrixKind::Diagonal; }
+
+    // Непосредственный доступ к диагональным элементам (_size элементов)
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+
     // Доступ к элементам
     T& operator()(unsigned i, unsigned j) {
         static T zero = T();
@@ -79,37 +102,149 @@ public:
         return data[i];
     }
 
+private:
+    // out[i] = op(data[i], other(i, i)); диагональ other читается напрямую из хранилища
+    template <typename Op>
+    void combine(const Matrix<T>& other, T* out, Op op) const {
+        ThreadPool& pool = ThreadPool::instance();
+        const T* a = data;
+
+        switch (other.kind()) {
+        case MatrixKind::Diagonal: {
+            const T* b = static_cast<const MatrixDiagonal<T>&>(other).data;
+            pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                MatrixSimd::apply(op, a + from, b + from, out + from, to - from);
+            });
+            return;
+        }
+        case MatrixKind::Dense: {
+            const T* b = static_cast<const MatrixDense<T>&>(other).rawData();
+            size_t stride = static_cast<size_t>(_size) + 1;
+            pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    out[i] = op(a[i], b[i * stride]);
+                }
+            });
+            return;
+        }
+        case MatrixKind::Block: {
+            const MatrixBlock<T>& block = static_cast<const MatrixBlock<T>&>(other);
+            unsigned bm = block.blockSizeM(), bn = block.blockSizeN();
+            pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    const MatrixDense<T>* src = block.block(static_cast<unsigned>(i / bm), static_cast<unsigned>(i / bn));
+                    out[i] = op(a[i], src ? src->rawData()[(i % bm) * bn + i % bn] : T());
+                }
+            });
+            return;
+        }
+        default:
+            pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                    out[i] = op(a[i], other(i, i));
+                }
+            });
+            return;
+        }
+    }
+
 
+    // this * block: строки присутствующих блоков масштабируются, нулевые блоки остаются нулевыми
+    MatrixBlock<T>* scaleBlocks(const MatrixBlock<T>& block) const {
+        unsigned bm = block.blockSizeM(), bn = block.blockSizeN();
+        MatrixBlock<T>* result = new MatrixBlock<T>(block.blockRows(), block.blockCols(), bm, bn);
 
-    // Сложение
+        // Каждый поток заполняет только свои блочные строки результата
+        ThreadPool::instance().parallelFor(0, block.blockRows(), ThreadPool::rowGrain(static_cast<size_t>(bm) * block.cols()), [&](size_t from, size_t to) {
+            for (unsigned bi = static_cast<unsigned>(from); bi < to; ++bi) {
+                const T* d = data + static_cast<size_t>(bi) * bm;
+                for (unsigned bj = 0; bj < block.blockCols(); ++bj) {
+                    const MatrixDense<T>* src = block.block(bi, bj);
+                    if (!src) {
+                        continue;
+                    }
+                    auto scaled = std::make_shared<MatrixDense<T>>(bm, bn, MatrixUninitialized());
+                    for (unsigned r = 0; r < bm; ++r) {
+                        MatrixSimd::scale(src->rawData() + static_cast<size_t>(r) * bn, d[r], scaled->rawData() + static_cast<size_t>(r) * bn, bn);
+                    }
+                    result->setBlock(bi, bj, scaled);
+                }
+            }
+        });
+        return result;
+    }
+
+    // out = alpha * op(this, other) + beta * out по диагонали; out может совпадать с this или other
+    template <typename Op>
+    void diagonalInto(const Matrix<T>& other, MatrixDiagonal<T>& out, Op op, T alpha, T beta) const {
+        if (_size != other.rows() || _size != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+        this->checkInto(other, out, _size, _size, false);
+
+        ThreadPool& pool = ThreadPool::instance();
+        T* c = out.data;
+        if (beta == T()) {
+            combine(other, c, op);
+            if (alpha != T(1)) {
+                pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+                    MatrixSimd::scale(c + from, alpha, c + from, to - from);
+                });
+            }
+            return;
+        }
+
+        const T* b = other.kind() == MatrixKind::Diagonal ? static_cast<const MatrixDiagonal<T>&>(other).data : nullptr;
+        pool.parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                c[i] = alpha * op(data[i], b ? b[i] : other(i, i)) + beta * c[i];
+            }
+        });
+    }
+
+public:
+    // Сложение на месте: матрица остаётся диагональной, поэтому учитывается только
+    // диагональ other; полную сумму дают operator+ и addInto
     Matrix<T>& operator+=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::operator+=", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
 
-        for (unsigned i = 0; i < _size; ++i) {
-            data[i] += other(i, i);
-        }
+        combine(other, data, MatrixSimdAdd());
         return *this;
     }
 
     // Вычитание
     Matrix<T>& operator-=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::operator-=", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
 
-        for (unsigned i = 0; i < _size; ++i) {
-            data[i] -= other(i, i);
-        }
+        combine(other, data, MatrixSimdSub());
         return *this;
     }
 
     // Оператор сложения
     Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::operator+", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
         }
+        // Сумма с недиагональной матрицей - полная: разреженная и ленточная сохраняют
+        // свою структуру, остальные дают плотный результат (как addInto)
+        if (other.kind() == MatrixKind::Sparse) {
+            return new MatrixSparseCSR<T>(MatrixSparseCSR<T>(*this).add(static_cast<const MatrixSparseCSR<T>&>(other)));
+        }
+        if (other.kind() == MatrixKind::Banded) {
+            return other + *this;
+        }
+        if (other.kind() != MatrixKind::Diagonal) {
+            MatrixDense<T>* result = new MatrixDense<T>(_size, _size, MatrixUninitialized());
+            addInto(other, *result);
+            return result;
+        }
 
         MatrixDiagonal<T>* result = new MatrixDiagonal<T>(*this);
         result->operator+=(other);
@@ -118,9 +253,22 @@ public:
 
     // Оператор вычитания
     Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::operator-", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
         }
+        // Разность с недиагональной матрицей - полная, как и сумма
+        if (other.kind() == MatrixKind::Sparse) {
+            return new MatrixSparseCSR<T>(MatrixSparseCSR<T>(*this).add(static_cast<const MatrixSparseCSR<T>&>(other), T(1), T(-1)));
+        }
+        if (other.kind() == MatrixKind::Banded) {
+            return MatrixBanded<T>(*this, 0, 0) - other;
+        }
+        if (other.kind() != MatrixKind::Diagonal) {
+            MatrixDense<T>* result = new MatrixDense<T>(_size, _size, MatrixUninitialized());
+            subtractInto(other, *result);
+            return result;
+        }
 
         MatrixDiagonal<T>* result = new MatrixDiagonal<T>(*this);
         result->operator-=(other);
@@ -129,118 +277,330 @@ public:
 
     // Матричное умножение
     Matrix<T>* operator*(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::operator*", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size * other.cols(), sizeof(T) * (_size + 2.0 * other.rows() * other.cols()));
         if (_size != other.rows()) {
             throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
         }
 
-        MatrixDense<T>* result = new MatrixDense<T>(_size, other.cols());
+        // Умножение слева на диагональную матрицу масштабирует строки other,
+        // поэтому структура other сохраняется
+        switch (other.kind()) {
+        case MatrixKind::Diagonal: {
+            MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size, MatrixUninitialized());
+            combine(other, result->data, MatrixSimdMul());
+            return result;
+        }
+        case MatrixKind::Dense: {
+            const MatrixDense<T>& dense = static_cast<const MatrixDense<T>&>(other);
+            unsigned n = dense.cols();
+            MatrixDense<T>* result = new MatrixDense<T>(_size, n, MatrixUninitialized());
+            const T* src = dense.rawData();
+            T* dst = result->rawData();
+            ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(n), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    MatrixSimd::scale(src + i * n, data[i], dst + i * n, n);
+                }
+            });
+            return result;
+        }
+        case MatrixKind::Block:
+            return scaleBlocks(static_cast<const MatrixBlock<T>&>(other));
+        case MatrixKind::Sparse:
+            return new MatrixSparseCSR<T>(static_cast<const MatrixSparseCSR<T>&>(other).scaleRows(data));
+        case MatrixKind::Banded:
+            return new MatrixBanded<T>(static_cast<const MatrixBanded<T>&>(other).scaleRows(data));
+        default:
+            break;
+        }
+
+        MatrixDense<T>* result = new MatrixDense<T>(_size, other.cols(), MatrixUninitialized());
 
-        for (unsigned i = 0; i < _size; ++i) {
-            for (unsigned j = 0; j < other.cols(); ++j) {
-                result->operator()(i, j) = data[i] * other(i, j);
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(other.cols()), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < other.cols(); ++j) {
+                    result->operator()(i, j) = data[i] * other(i, j);
+                }
             }
-        }
+        });
         return result;
     }
 
     // Почленное умножение
     Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::elemMult", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
         }
 
-        MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size);
+        MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size, MatrixUninitialized());
 
-        for (unsigned i = 0; i < _size; ++i) {
-            result->data[i] = data[i] * other(i, i);
-        }
+        combine(other, result->data, MatrixSimdMul());
         return result;
     }
 
     // Почленное деление
     Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::elemDiv", T, (_size, _size, other.rows(), other.cols()), 1.0 * _size, 3.0 * sizeof(T) * _size);
         if (_size != other.rows() || _size != other.cols()) {
             throw std::invalid_argument("Размеры матриц должны совпадать для почленного деления.");
         }
 
-        MatrixDiagonal<T>* result = new MatrixDiagonal<T>(_size);
+        std::unique_ptr<MatrixDiagonal<T>> result(new MatrixDiagonal<T>(_size, MatrixUninitialized()));
 
-        for (unsigned i = 0; i < _size; ++i) {
-            if (other(i, i) == T()) {
+        // Делитель-диагональ проверяется заранее, тогда деление идёт векторным ядром
+        if (other.kind() == MatrixKind::Diagonal) {
+            if (MatrixSimd::hasZero(static_cast<const MatrixDiagonal<T>&>(other).data, _size)) {
                 throw std::runtime_error("Деление на ноль при почленном делении матриц.");
             }
-            result->data[i] = data[i] / other(i, i);
+            combine(other, result->data, MatrixSimdDiv());
+            return result.release();
         }
-        return result;
+
+        combine(other, result->data, [](T a, T b) {
+            if (b == T()) {
+                throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+            }
+            return a / b;
+        });
+        return result.release();
     }
 
     // Транспонирование
     MatrixDiagonal<T>* transpose() const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::transpose", T, (_size, _size), 0, 2.0 * sizeof(T) * _size);
         // Транспонирование диагональной матрицы дает ту же матрицу
         return new MatrixDiagonal<T>(*this);
     }
-    // Произведение Кронекера
-    Matrix<T>* kroneckerProduct(const Matrix<T>& other) const {
-        unsigned new_size = _size * other.rows();
-        MatrixDense<T>* result = new MatrixDense<T>(new_size, new_size);
 
-        for (unsigned i = 0; i < _size; ++i) {
-            for (unsigned j = 0; j < _size; ++j) {
-                for (unsigned k = 0; k < other.rows(); ++k) {
-                    for (unsigned l = 0; l < other.cols(); ++l) {
-                        (*result)(i * other.rows() + k, j * other.cols() + l) = 
-                            ((i == j) ? data[i] : 0) * other(k, l);
-                    }
+    // Операции с результатом в готовой матрице (см. Matrix<T>::multiplyInto).
+    // С плотным out сложение и вычитание с плотной матрицей выполняет её ядро
+
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::multiplyInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size * other.cols(), sizeof(T) * (_size + 2.0 * other.rows() * other.cols()));
+        if (_size != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, _size, other.cols(), true);
+        if (other.kind() == MatrixKind::Dense) {
+            gemvBatch(alpha, static_cast<const MatrixDense<T>&>(other), beta, out);
+            return;
+        }
+        unsigned n = other.cols();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T factor = alpha * data[i];
+                for (unsigned j = 0; j < n; ++j) {
+                    out(i, j) = beta == T() ? factor * other(i, j) : factor * other(i, j) + beta * out(i, j);
                 }
             }
+        });
+    }
+
+    void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        if (other.kind() == MatrixKind::Dense) {
+            other.addInto(*this, out, alpha, beta);
+            return;
         }
+        Matrix<T>::addInto(other, out, alpha, beta);
+    }
 
-        return result;
+    void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        // alpha * (D - other) = -alpha * (other - D)
+        if (other.kind() == MatrixKind::Dense) {
+            other.subtractInto(*this, out, -alpha, beta);
+            return;
+        }
+        Matrix<T>::subtractInto(other, out, alpha, beta);
     }
-    // Импорт из файла
-    void importFromFile(const std::string& filename) override {
-        std::ifstream infile(filename);
-        if (!infile) {
-            throw std::runtime_error("Не удалось открыть файл для чтения.");
+
+    // Вне диагонали результат нулевой: out там только масштабируется на beta
+    void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::elemMultInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size, sizeof(T) * (2.0 * _size + 1.0 * _size * _size));
+        if (_size != other.rows() || _size != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
         }
+        this->checkInto(other, out, _size, _size, false);
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(_size), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                T value = alpha * data[i] * other(i, i);
+                T* row = c + static_cast<size_t>(i) * _size;
+                if (beta == T()) {
+                    std::fill(row, row + _size, T());
+                    row[i] = value;
+                } else {
+                    MatrixSimd::scale(row, beta, row, _size);
+                    row[i] += value;
+                }
+            }
+        });
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::transposeInto", T, (_size, _size), 0, sizeof(T) * (_size + 1.0 * _size * _size));
+        this->checkInto(*this, out, _size, _size, true);
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(_size), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                T* row = c + i * _size;
+                if (beta == T()) {
+                    std::fill(row, row + _size, T());
+                    row[i] = alpha * data[i];
+                } else {
+                    MatrixSimd::scale(row, beta, row, _size);
+                    row[i] += alpha * data[i];
+                }
+            }
+        });
+    }
+
+    // Варианты с диагональным out: результат остаётся диагональным
+
+    void multiplyInto(const MatrixDiagonal<T>& other, MatrixDiagonal<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::multiplyInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size, 3.0 * sizeof(T) * _size);
+        diagonalInto(other, out, MatrixSimdMul(), alpha, beta);
+    }
+
+    void addInto(const MatrixDiagonal<T>& other, MatrixDiagonal<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::addInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size, 3.0 * sizeof(T) * _size);
+        diagonalInto(other, out, MatrixSimdAdd(), alpha, beta);
+    }
+
+    void subtractInto(const MatrixDiagonal<T>& other, MatrixDiagonal<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::subtractInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size, 3.0 * sizeof(T) * _size);
+        diagonalInto(other, out, MatrixSimdSub(), alpha, beta);
+    }
+
+    // Почленное произведение с любой матрицей диагонально
+    void elemMultInto(const Matrix<T>& other, MatrixDiagonal<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::elemMultInto", T, (_size, _size, other.rows(), other.cols()), 2.0 * _size, 3.0 * sizeof(T) * _size);
+        diagonalInto(other, out, MatrixSimdMul(), alpha, beta);
+    }
+
+    void transposeInto(MatrixDiagonal<T>& out, T alpha = T(1), T beta = T()) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::transposeInto", T, (_size, _size), 0, 2.0 * sizeof(T) * _size);
+        this->checkInto(*this, out, _size, _size, false);
+        T* c = out.data;
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                c[i] = beta == T() ? alpha * data[i] : alpha * data[i] + beta * c[i];
+            }
+        });
+    }
+
+    // y = alpha * D * x + beta * y: поэлементное умножение на диагональ
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::gemv", T, (_size, _size, x.size(), 1), 2.0 * _size, sizeof(T) * (3.0 * _size));
+        this->checkGemv(x, y);
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                T value = alpha * data[i] * xs[i];
+                ys[i] = beta == T() ? value : value + beta * ys[i];
+            }
+        });
+    }
+
+    // Y = alpha * D * X + beta * Y: строка i матрицы векторов масштабируется на alpha * d[i]
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::gemvBatch", T, (_size, _size, X.rows(), X.cols()), 2.0 * _size * X.cols(), sizeof(T) * (_size + 2.0 * X.rows() * X.cols()));
+        this->checkGemvBatch(X, Y);
+        unsigned k = X.cols();
+        const T* xs = X.rawData();
+        T* ys = Y.rawData();
+        ThreadPool::instance().parallelFor(0, _size, ThreadPool::rowGrain(k), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                const T* src = xs + i * k;
+                T* dst = ys + i * k;
+                T factor = alpha * data[i];
+                if (beta == T()) {
+                    MatrixSimd::scale(src, factor, dst, k);
+                } else {
+                    for (unsigned c = 0; c < k; ++c) {
+                        dst[c] = factor * src[c] + beta * dst[c];
+                    }
+                }
+            }
+        });
+    }
+
+    // Произведение Кронекера this ⊗ other без явного заполнения: результат хранит
+    // копии множителей, явное блочно-диагональное представление - materialize()
+    MatrixKronecker<T>* kroneckerProduct(const Matrix<T>& other) const {
+        return new MatrixKronecker<T>(*this, other);
+    }
 
-        std::string className;
-        std::getline(infile, className);
+    // Импорт из файла
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
 
-        if (className != "MatrixDiagonal") {
+        if (reader.line() != "MatrixDiagonal") {
             throw std::runtime_error("Файл не содержит данные MatrixDiagonal.");
         }
 
-        unsigned size;
-        infile >> size;
+        unsigned size = reader.value<unsigned>();
 
-        delete[] data;
-        _size = size;
-        data = new T[_size];
+        MatrixDiagonal<T> loaded(size, MatrixUninitialized());
+        reader.values(loaded.data, size);
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((_size, _size), 0, sizeof(T) * _size);
+    }
 
-        for (unsigned i = 0; i < _size; ++i) {
-            infile >> data[i];
+    // Экспорт в файл: диагональ - одна строка, форматируется частями параллельно
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::exportToFile", T, (_size, _size), 0, sizeof(T) * _size);
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixDiagonal\n" + std::to_string(_size) + "\n");
+        writer.values(data, _size);
+        writer.text("\n");
+
+        writer.close();
+    }
+
+    // Импорт из двоичного файла
+    void importFromBinary(const std::string& filename) {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::importFromBinary", T, (0, 0), 0, 0);
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+
+        MatrixBinaryHeader header = MatrixBinary::readHeader(infile);
+        bool swap = MatrixBinary::checkHeader<T>(header, MatrixClassTag::Diagonal, "MatrixDiagonal");
+        size_t count = static_cast<size_t>(header.dims[0]);
+
+        T* values = MatrixStorage<T>::allocate(count, false);
+        infile.seekg(static_cast<std::streamoff>(header.dataOffset));
+        if (!infile.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(count * sizeof(T)))) {
+            MatrixStorage<T>::deallocate(values, count);
+            throw std::runtime_error("Повреждённый двоичный файл MatrixDiagonal.");
+        }
+        if (swap) {
+            MatrixBinary::swapBytes(values, count);
         }
 
-        infile.close();
+        MatrixStorage<T>::deallocate(data, _size);
+        _size = static_cast<unsigned>(count);
+        data = values;
+        MATRIX_TRACE_UPDATE((_size, _size), 0, sizeof(T) * _size);
     }
 
-    // Экспорт в файл
-    void exportToFile(const std::string& filename) const override {
-        std::ofstream outfile(filename);
+    // Экспорт в двоичный файл
+    void exportToBinary(const std::string& filename) const {
+        MATRIX_TRACE_SCOPE("MatrixDiagonal::exportToBinary", T, (_size, _size), 0, sizeof(T) * _size);
+        std::ofstream outfile(filename, std::ios::binary);
         if (!outfile) {
             throw std::runtime_error("Не удалось открыть файл для записи.");
         }
 
-        outfile << "MatrixDiagonal\n";
-        outfile << _size << "\n";
-
-        for (unsigned i = 0; i < _size; ++i) {
-            outfile << data[i] << " ";
+        MatrixBinary::writeHeader(outfile, MatrixBinary::makeHeader<T>(MatrixClassTag::Diagonal, _size));
+        outfile.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(static_cast<size_t>(_size) * sizeof(T)));
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
         }
-        outfile << "\n";
-
-        outfile.close();
     }
 
     // Метод для печати матрицы
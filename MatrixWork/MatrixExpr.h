@@ -0,0 +1,171 @@
+#ifndef MATRIXEXPR_H
+#define MATRIXEXPR_H
+
+#include "ThreadPool.h"
+#include <stdexcept>
+#include <type_traits>
+
+template <typename T> class MatrixDense;
+
+// Ленивые поэлементные выражения над MatrixDense.
+// lazy(A) + lazy(B) - lazy(C) строит дерево выражения на этапе компиляции;
+// вычисление выполняется за один проход при присваивании в MatrixDense:
+//     MatrixDense<double> R = lazy(A) + lazy(B).elemMult(lazy(C)) * 2.0;
+// Каждый узел хранит размеры и умеет вернуть элемент по линейному индексу.
+template <typename E, typename T>
+class MatrixExpr {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    unsigned rows() const { return self().rows(); }
+    unsigned cols() const { return self().cols(); }
+    T at(size_t index) const { return self().at(index); }
+
+    template <typename R>
+    auto elemMult(const MatrixExpr<R, T>& other) const;
+
+    template <typename R>
+    auto elemDiv(const MatrixExpr<R, T>& other) const;
+};
+
+// Лист выражения - ссылка на непрерывное хранилище плотной матрицы
+template <typename T>
+class MatrixExprLeaf : public MatrixExpr<MatrixExprLeaf<T>, T> {
+private:
+    const T* _data;
+    unsigned _m, _n;
+
+public:
+    explicit MatrixExprLeaf(const MatrixDense<T>& matrix)
+        : _data(matrix.rawData()), _m(matrix.rows()), _n(matrix.cols()) {}
+
+    unsigned rows() const { return _m; }
+    unsigned cols() const { return _n; }
+    T at(size_t index) const { return _data[index]; }
+};
+
+// Скаляр, участвующий в выражении (A * 2.0, 1.0 - A)
+template <typename T>
+class MatrixExprScalar {
+private:
+    T _value;
+
+public:
+    explicit MatrixExprScalar(T value) : _value(value) {}
+    T at(size_t) const { return _value; }
+};
+
+struct MatrixExprAdd { template <typename T> static T apply(T a, T b) { return a + b; } };
+struct MatrixExprSub { template <typename T> static T apply(T a, T b) { return a - b; } };
+struct MatrixExprMul { template <typename T> static T apply(T a, T b) { return a * b; } };
+// Деление в выражениях не проверяет делитель на ноль, чтобы не мешать векторизации
+struct MatrixExprDiv { template <typename T> static T apply(T a, T b) { return a / b; } };
+
+// Поэлементный бинарный узел
+template <typename Op, typename L, typename R, typename T>
+class MatrixExprBinary : public MatrixExpr<MatrixExprBinary<Op, L, R, T>, T> {
+private:
+    L _left;
+    R _right;
+
+public:
+    MatrixExprBinary(const L& left, const R& right) : _left(left), _right(right) {
+        if (left.rows() != right.rows() || left.cols() != right.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для поэлементной операции.");
+        }
+    }
+
+    unsigned rows() const { return _left.rows(); }
+    unsigned cols() const { return _left.cols(); }
+    T at(size_t index) const { return Op::apply(_left.at(index), _right.at(index)); }
+};
+
+// Узел с матрицей и скаляром; ScalarLeft задаёт порядок операндов
+template <typename Op, typename E, typename T, bool ScalarLeft>
+class MatrixExprScaled : public MatrixExpr<MatrixExprScaled<Op, E, T, ScalarLeft>, T> {
+private:
+    E _expr;
+    MatrixExprScalar<T> _scalar;
+
+public:
+    MatrixExprScaled(const E& expr, T scalar) : _expr(expr), _scalar(scalar) {}
+
+    unsigned rows() const { return _expr.rows(); }
+    unsigned cols() const { return _expr.cols(); }
+    T at(size_t index) const {
+        return ScalarLeft ? Op::apply(_scalar.at(index), _expr.at(index))
+                          : Op::apply(_expr.at(index), _scalar.at(index));
+    }
+};
+
+template <typename E, typename T>
+template <typename R>
+auto MatrixExpr<E, T>::elemMult(const MatrixExpr<R, T>& other) const {
+    return MatrixExprBinary<MatrixExprMul, E, R, T>(self(), other.self());
+}
+
+template <typename E, typename T>
+template <typename R>
+auto MatrixExpr<E, T>::elemDiv(const MatrixExpr<R, T>& other) const {
+    return MatrixExprBinary<MatrixExprDiv, E, R, T>(self(), other.self());
+}
+
+template <typename L, typename R, typename T>
+auto operator+(const MatrixExpr<L, T>& left, const MatrixExpr<R, T>& right) {
+    return MatrixExprBinary<MatrixExprAdd, L, R, T>(left.self(), right.self());
+}
+
+template <typename L, typename R, typename T>
+auto operator-(const MatrixExpr<L, T>& left, const MatrixExpr<R, T>& right) {
+    return MatrixExprBinary<MatrixExprSub, L, R, T>(left.self(), right.self());
+}
+
+template <typename E, typename T>
+auto operator*(const MatrixExpr<E, T>& expr, typename std::common_type<T>::type scalar) {
+    return MatrixExprScaled<MatrixExprMul, E, T, false>(expr.self(), scalar);
+}
+
+template <typename E, typename T>
+auto operator*(typename std::common_type<T>::type scalar, const MatrixExpr<E, T>& expr) {
+    return MatrixExprScaled<MatrixExprMul, E, T, true>(expr.self(), scalar);
+}
+
+template <typename E, typename T>
+auto operator/(const MatrixExpr<E, T>& expr, typename std::common_type<T>::type scalar) {
+    return MatrixExprScaled<MatrixExprDiv, E, T, false>(expr.self(), scalar);
+}
+
+template <typename E, typename T>
+auto operator+(const MatrixExpr<E, T>& expr, typename std::common_type<T>::type scalar) {
+    return MatrixExprScaled<MatrixExprAdd, E, T, false>(expr.self(), scalar);
+}
+
+template <typename E, typename T>
+auto operator-(const MatrixExpr<E, T>& expr, typename std::common_type<T>::type scalar) {
+    return MatrixExprScaled<MatrixExprSub, E, T, false>(expr.self(), scalar);
+}
+
+template <typename E, typename T>
+auto operator-(typename std::common_type<T>::type scalar, const MatrixExpr<E, T>& expr) {
+    return MatrixExprScaled<MatrixExprSub, E, T, true>(expr.self(), scalar);
+}
+
+// Начало ленивого выражения над плотной матрицей
+template <typename T>
+MatrixExprLeaf<T> lazy(const MatrixDense<T>& matrix) {
+    return MatrixExprLeaf<T>(matrix);
+}
+
+// Вычисление выражения в буфер за один параллельный проход
+template <typename E, typename T>
+void evaluateExpr(const MatrixExpr<E, T>& expr, T* out) {
+    const E& e = expr.self();
+    size_t count = static_cast<size_t>(e.rows()) * e.cols();
+    ThreadPool::instance().parallelFor(0, count, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+        for (size_t k = from; k < to; ++k) {
+            out[k] = e.at(k);
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,347 @@
+#ifndef MATRIXFIXED_H
+#define MATRIXFIXED_H
+
+#include <utility>
+#include <initializer_list>
+#include <algorithm>
+#include <cstddef>
+
+// Ядра для матриц с размерами, известными при компиляции (построчное хранение).
+// Циклы развёрнуты раскрытием пакетов индексов, поэтому для маленьких размеров
+// нет ни счётчиков циклов, ни остатков - компилятор векторизует последовательность
+// операций целиком. Объявлены до включения остальных заголовков: ими пользуется MatrixBlock
+template <typename T, unsigned M, unsigned N>
+struct MatrixFixedKernel {
+    static constexpr unsigned Size = M * N;
+
+    // c[k] = op(a[k], b[k]) для всех M * N элементов
+    template <typename Op>
+    static void apply(Op op, const T* a, const T* b, T* c) {
+        applyEach(op, a, b, c, std::make_index_sequence<Size>());
+    }
+
+    // C (M x P) += A (M x N) * B (N x P)
+    template <unsigned P>
+    static void multiplyAdd(const T* a, const T* b, T* c) {
+        multiplyRows<P>(a, b, c, std::make_index_sequence<M>());
+    }
+
+    // B (N x M) = A^T
+    static void transpose(const T* a, T* b) {
+        transposeEach(a, b, std::make_index_sequence<Size>());
+    }
+
+private:
+    template <typename Op, size_t... K>
+    static void applyEach(Op op, const T* a, const T* b, T* c, std::index_sequence<K...>) {
+        ((c[K] = op(a[K], b[K])), ...);
+    }
+
+    template <unsigned P, size_t... J>
+    static void axpy(T s, const T* b, T* c, std::index_sequence<J...>) {
+        ((c[J] += s * b[J]), ...);
+    }
+
+    template <unsigned P, size_t... K>
+    static void multiplyRow(const T* a, const T* b, T* c, std::index_sequence<K...>) {
+        (axpy<P>(a[K], b + K * P, c, std::make_index_sequence<P>()), ...);
+    }
+
+    template <unsigned P, size_t... I>
+    static void multiplyRows(const T* a, const T* b, T* c, std::index_sequence<I...>) {
+        (multiplyRow<P>(a + I * N, b, c + I * P, std::make_index_sequence<N>()), ...);
+    }
+
+    template <size_t... K>
+    static void transposeEach(const T* a, T* b, std::index_sequence<K...>) {
+        ((b[(K % N) * M + K / N] = a[K]), ...);
+    }
+};
+
+// Выбор развёрнутого ядра по размерам, известным только во время выполнения
+// (блоки MatrixBlock). Поддерживаются квадратные блоки 2, 3, 4 и 8; для остальных
+// размеров функции возвращают false и вызывающий использует общее ядро
+template <typename T>
+struct MatrixFixedDispatch {
+    // C (n x n) += A (n x n) * B (n x n)
+    static bool multiplyAdd(unsigned m, unsigned n, unsigned p, const T* a, const T* b, T* c) {
+        if (m != n || n != p) {
+            return false;
+        }
+        switch (n) {
+        case 2: MatrixFixedKernel<T, 2, 2>::template multiplyAdd<2>(a, b, c); return true;
+        case 3: MatrixFixedKernel<T, 3, 3>::template multiplyAdd<3>(a, b, c); return true;
+        case 4: MatrixFixedKernel<T, 4, 4>::template multiplyAdd<4>(a, b, c); return true;
+        case 8: MatrixFixedKernel<T, 8, 8>::template multiplyAdd<8>(a, b, c); return true;
+        default: return false;
+        }
+    }
+
+    // B = A^T для квадратного блока n x n
+    static bool transpose(unsigned m, unsigned n, const T* a, T* b) {
+        if (m != n) {
+            return false;
+        }
+        switch (n) {
+        case 2: MatrixFixedKernel<T, 2, 2>::transpose(a, b); return true;
+        case 3: MatrixFixedKernel<T, 3, 3>::transpose(a, b); return true;
+        case 4: MatrixFixedKernel<T, 4, 4>::transpose(a, b); return true;
+        case 8: MatrixFixedKernel<T, 8, 8>::transpose(a, b); return true;
+        default: return false;
+        }
+    }
+};
+
+template <typename T, unsigned M, unsigned N> class MatrixFixed;
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixText.h"
+#include "MatrixSimd.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// Матрица M x N с размерами времени компиляции и хранилищем внутри объекта:
+// без выделения памяти и без циклов переменной длины. Операции над MatrixFixed
+// (add, subtract, multiply, transposed, +=, -=) возвращают значения и используют
+// развёрнутые ядра; интерфейс Matrix<T> работает с любыми матрицами тех же размеров.
+// Может быть блоком MatrixBlock (см. MatrixBlock::setBlock и MatrixBlock::fixedBlock).
+// Текстовый формат совпадает с MatrixDense
+template <typename T, unsigned M, unsigned N>
+class MatrixFixed : public Matrix<T> {
+    static_assert(M > 0 && N > 0, "Размеры MatrixFixed должны быть положительными.");
+
+private:
+    using Kernel = MatrixFixedKernel<T, M, N>;
+
+    T data[M * N] = {};
+
+    // Указатель на хранилище other, если его элементы лежат построчно подряд
+    static const T* contiguous(const Matrix<T>& other) {
+        if (other.kind() == MatrixKind::Dense) {
+            return static_cast<const MatrixDense<T>&>(other).rawData();
+        }
+        return nullptr;
+    }
+
+    void checkSize(const Matrix<T>& other, const char* message) const {
+        if (other.rows() != M || other.cols() != N) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    // this = op(this, other) для матрицы other тех же размеров
+    template <typename Op>
+    void accumulate(const Matrix<T>& other, Op op) {
+        if (const T* values = contiguous(other)) {
+            Kernel::apply(op, data, values, data);
+            return;
+        }
+        for (unsigned i = 0; i < M; ++i) {
+            for (unsigned j = 0; j < N; ++j) {
+                data[i * N + j] = op(data[i * N + j], other(i, j));
+            }
+        }
+    }
+
+public:
+    static constexpr unsigned Rows = M;
+    static constexpr unsigned Cols = N;
+
+    // Нулевая матрица
+    MatrixFixed() = default;
+
+    // Элементы построчно; недостающие элементы нулевые
+    MatrixFixed(std::initializer_list<T> values) {
+        if (values.size() > M * N) {
+            throw std::invalid_argument("Число элементов превышает размер матрицы.");
+        }
+        std::copy(values.begin(), values.end(), data);
+    }
+
+    unsigned rows() const override { return M; }
+    unsigned cols() const override { return N; }
+
+    // Непосредственный доступ к хранилищу (M * N элементов построчно)
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+
+    // Доступ к элементам
+    T& operator()(unsigned i, unsigned j) {
+        return data[i * N + j];
+    }
+
+    T operator()(unsigned i, unsigned j) const override {
+        return data[i * N + j];
+    }
+
+    // Операции над MatrixFixed: размеры проверяются при компиляции
+
+    MatrixFixed<T, M, N> add(const MatrixFixed<T, M, N>& other) const {
+        MatrixFixed<T, M, N> result;
+        Kernel::apply(MatrixSimdAdd(), data, other.data, result.data);
+        return result;
+    }
+
+    MatrixFixed<T, M, N> subtract(const MatrixFixed<T, M, N>& other) const {
+        MatrixFixed<T, M, N> result;
+        Kernel::apply(MatrixSimdSub(), data, other.data, result.data);
+        return result;
+    }
+
+    // Умножение на вектор из Matrix<T> не скрывается перегрузкой ниже
+    using Matrix<T>::multiply;
+
+    template <unsigned P>
+    MatrixFixed<T, M, P> multiply(const MatrixFixed<T, N, P>& other) const {
+        MatrixFixed<T, M, P> result;
+        Kernel::template multiplyAdd<P>(data, other.rawData(), result.rawData());
+        return result;
+    }
+
+    MatrixFixed<T, N, M> transposed() const {
+        MatrixFixed<T, N, M> result;
+        Kernel::transpose(data, result.rawData());
+        return result;
+    }
+
+    MatrixFixed<T, M, N>& operator+=(const MatrixFixed<T, M, N>& other) {
+        Kernel::apply(MatrixSimdAdd(), data, other.data, data);
+        return *this;
+    }
+
+    MatrixFixed<T, M, N>& operator-=(const MatrixFixed<T, M, N>& other) {
+        Kernel::apply(MatrixSimdSub(), data, other.data, data);
+        return *this;
+    }
+
+    // Операции интерфейса Matrix<T>
+
+    // Сложение
+    Matrix<T>& operator+=(const Matrix<T>& other) override {
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        accumulate(other, MatrixSimdAdd());
+        return *this;
+    }
+
+    // Вычитание
+    Matrix<T>& operator-=(const Matrix<T>& other) override {
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        accumulate(other, MatrixSimdSub());
+        return *this;
+    }
+
+    // Оператор сложения
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        MatrixFixed<T, M, N>* result = new MatrixFixed<T, M, N>(*this);
+        result->accumulate(other, MatrixSimdAdd());
+        return result;
+    }
+
+    // Оператор вычитания
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        MatrixFixed<T, M, N>* result = new MatrixFixed<T, M, N>(*this);
+        result->accumulate(other, MatrixSimdSub());
+        return result;
+    }
+
+    // Матричное умножение: число столбцов other известно только во время выполнения
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        if (other.rows() != N) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+
+        unsigned p = other.cols();
+        MatrixDense<T>* result = new MatrixDense<T>(M, p);
+        T* c = result->rawData();
+        const T* b = contiguous(other);
+        for (unsigned i = 0; i < M; ++i) {
+            for (unsigned k = 0; k < N; ++k) {
+                T a = data[i * N + k];
+                for (unsigned j = 0; j < p; ++j) {
+                    c[static_cast<size_t>(i) * p + j] += a * (b ? b[static_cast<size_t>(k) * p + j] : other(k, j));
+                }
+            }
+        }
+        return result;
+    }
+
+    // Поэлементное умножение
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для почленного умножения.");
+        MatrixFixed<T, M, N>* result = new MatrixFixed<T, M, N>(*this);
+        result->accumulate(other, MatrixSimdMul());
+        return result;
+    }
+
+    // Поэлементное деление
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для почленного деления.");
+        for (unsigned i = 0; i < M; ++i) {
+            for (unsigned j = 0; j < N; ++j) {
+                if (other(i, j) == T()) {
+                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+                }
+            }
+        }
+        MatrixFixed<T, M, N>* result = new MatrixFixed<T, M, N>(*this);
+        result->accumulate(other, MatrixSimdDiv());
+        return result;
+    }
+
+    // Транспонирование
+    MatrixFixed<T, N, M>* transpose() const override {
+        MatrixFixed<T, N, M>* result = new MatrixFixed<T, N, M>();
+        Kernel::transpose(data, result->rawData());
+        return result;
+    }
+
+    // Импорт из файла формата MatrixDense; размеры в файле должны совпадать с M x N
+    void importFromFile(const std::string& filename) override {
+        MatrixTextReader reader(filename);
+
+        if (reader.line() != "MatrixDense") {
+            throw std::runtime_error("Файл не содержит данные MatrixDense.");
+        }
+
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
+        if (m != M || n != N) {
+            throw std::runtime_error("Размеры матрицы в файле не совпадают с размерами MatrixFixed.");
+        }
+
+        T loaded[M * N];
+        reader.values(loaded, static_cast<size_t>(M) * N);
+        std::copy(loaded, loaded + M * N, data);
+    }
+
+    // Экспорт в файл формата MatrixDense
+    void exportToFile(const std::string& filename) const override {
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixDense\n" + std::to_string(M) + " " + std::to_string(N) + "\n");
+        writer.units(M, static_cast<size_t>(N) * 14 + 1, [this](size_t i, std::string& buffer) {
+            for (unsigned j = 0; j < N; ++j) {
+                MatrixTextValue::append(buffer, data[i * N + j]);
+            }
+            buffer += '\n';
+        });
+
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        for (unsigned i = 0; i < M; ++i) {
+            for (unsigned j = 0; j < N; ++j) {
+                os << data[i * N + j] << "\t";
+            }
+            os << "\n";
+        }
+    }
+};
+
+#endif
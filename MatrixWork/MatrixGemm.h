@@ -0,0 +1,219 @@
+#ifndef MATRIXGEMM_H
+#define MATRIXGEMM_H
+
+#include "ThreadPool.h"
+#include "MatrixSimd.h"
+#include <vector>
+#include <algorithm>
+
+// Параметры блокирования под иерархию кэшей:
+// MR x NR  - регистровый тайл микроядра,
+// KC       - глубина панелей (микропанель B KC x NR помещается в L1),
+// MC       - высота панели A (MC x KC помещается в L2),
+// NC       - ширина панели B (KC x NC помещается в L3).
+template <typename T>
+struct GemmBlocking {
+    static constexpr unsigned MR = 4;
+    static constexpr unsigned NR = 8;
+    static constexpr unsigned KC = 256;
+    static constexpr unsigned MC = 128;
+    static constexpr unsigned NC = 4096;
+};
+
+template <>
+struct GemmBlocking<float> {
+    static constexpr unsigned MR = 8;
+    static constexpr unsigned NR = 8;
+    static constexpr unsigned KC = 384;
+    static constexpr unsigned MC = 128;
+    static constexpr unsigned NC = 4096;
+};
+
+// Блочное умножение плотных матриц в построчном хранении:
+// C = alpha * A * B + beta * C, где A - M x K, B - K x N, C - M x N,
+// lda/ldb/ldc - шаг между строками соответствующей матрицы.
+template <typename T = double>
+class MatrixGemm {
+private:
+    static constexpr unsigned MR = GemmBlocking<T>::MR;
+    static constexpr unsigned NR = GemmBlocking<T>::NR;
+    static constexpr unsigned KC = GemmBlocking<T>::KC;
+    static constexpr unsigned MC = GemmBlocking<T>::MC;
+    static constexpr unsigned NC = GemmBlocking<T>::NC;
+
+    // Упаковка панели A (mc x kc) в микропанели высотой MR: внутри микропанели
+    // элементы идут по столбцам, неполная последняя микропанель дополняется нулями
+    static void packA(unsigned mc, unsigned kc, const T* A, unsigned lda, T alpha, T* buffer) {
+        for (unsigned ir = 0; ir < mc; ir += MR) {
+            unsigned mr = std::min(MR, mc - ir);
+            for (unsigned p = 0; p < kc; ++p) {
+                for (unsigned i = 0; i < mr; ++i) {
+                    buffer[i] = alpha * A[(ir + i) * lda + p];
+                }
+                for (unsigned i = mr; i < MR; ++i) {
+                    buffer[i] = T();
+                }
+                buffer += MR;
+            }
+        }
+    }
+
+    // Упаковка панели B (kc x nc) в микропанели шириной NR
+    static void packB(unsigned kc, unsigned nc, const T* B, unsigned ldb, T* buffer) {
+        for (unsigned jr = 0; jr < nc; jr += NR) {
+            unsigned nr = std::min(NR, nc - jr);
+            for (unsigned p = 0; p < kc; ++p) {
+                const T* row = B + p * ldb + jr;
+                for (unsigned j = 0; j < nr; ++j) {
+                    buffer[j] = row[j];
+                }
+                for (unsigned j = nr; j < NR; ++j) {
+                    buffer[j] = T();
+                }
+                buffer += NR;
+            }
+        }
+    }
+
+    // Микроядро: тайл MR x NR накапливается в регистрах и добавляется к C
+    static void microKernel(unsigned kc, const T* a, const T* b, T* C, unsigned ldc, unsigned mr, unsigned nr) {
+        T acc[MR][NR] = {};
+
+        for (unsigned p = 0; p < kc; ++p) {
+            for (unsigned i = 0; i < MR; ++i) {
+                T ai = a[i];
+                for (unsigned j = 0; j < NR; ++j) {
+                    acc[i][j] += ai * b[j];
+                }
+            }
+            a += MR;
+            b += NR;
+        }
+
+        if (mr == MR && nr == NR) {
+            for (unsigned i = 0; i < MR; ++i) {
+                for (unsigned j = 0; j < NR; ++j) {
+                    C[i * ldc + j] += acc[i][j];
+                }
+            }
+        } else {
+            for (unsigned i = 0; i < mr; ++i) {
+                for (unsigned j = 0; j < nr; ++j) {
+                    C[i * ldc + j] += acc[i][j];
+                }
+            }
+        }
+    }
+
+    // Макроядро: проход микроядром по упакованным панелям A (mc x kc) и B (kc x nc)
+    static void macroKernel(unsigned mc, unsigned nc, unsigned kc, const T* packedA, const T* packedB, T* C, unsigned ldc) {
+        for (unsigned jr = 0; jr < nc; jr += NR) {
+            unsigned nr = std::min(NR, nc - jr);
+            const T* b = packedB + jr * kc;
+            for (unsigned ir = 0; ir < mc; ir += MR) {
+                unsigned mr = std::min(MR, mc - ir);
+                microKernel(kc, packedA + ir * kc, b, C + ir * ldc + jr, ldc, mr, nr);
+            }
+        }
+    }
+
+    static unsigned roundUp(unsigned value, unsigned step) {
+        return (value + step - 1) / step * step;
+    }
+
+public:
+    // Предел ширины N, до которого multiplyTransposed выгоднее упаковки панелей
+    static constexpr unsigned NarrowWidth = 32;
+
+    // C = alpha * A * Bt^T + beta * C, где Bt - N x K (B, хранимая по столбцам).
+    // Каждый элемент C - векторное скалярное произведение строк A и Bt без упаковки
+    // панелей; строка A читается из памяти один раз на все N столбцов, поэтому
+    // для узких B (несколько векторов) это быстрее multiply
+    static void multiplyTransposed(unsigned M, unsigned N, unsigned K,
+                                   T alpha, const T* A, unsigned lda,
+                                   const T* Bt, unsigned ldbt,
+                                   T beta, T* C, unsigned ldc) {
+        ThreadPool::instance().parallelFor(0, M, ThreadPool::rowGrain(static_cast<size_t>(K) * N), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                const T* a = A + i * lda;
+                T* c = C + i * ldc;
+                for (unsigned j = 0; j < N; ++j) {
+                    T sum = alpha * MatrixSimd::dot(a, Bt + static_cast<size_t>(j) * ldbt, K);
+                    c[j] = beta == T() ? sum : sum + beta * c[j];
+                }
+            }
+        });
+    }
+
+    static void multiply(unsigned M, unsigned N, unsigned K,
+                         T alpha, const T* A, unsigned lda,
+                         const T* B, unsigned ldb,
+                         T beta, T* C, unsigned ldc) {
+        if (M == 0 || N == 0) {
+            return;
+        }
+
+        if (beta != T(1)) {
+            for (unsigned i = 0; i < M; ++i) {
+                T* row = C + static_cast<size_t>(i) * ldc;
+                if (beta == T()) {
+                    std::fill(row, row + N, T());
+                } else {
+                    for (unsigned j = 0; j < N; ++j) {
+                        row[j] *= beta;
+                    }
+                }
+            }
+        }
+
+        if (K == 0 || alpha == T()) {
+            return;
+        }
+
+        ThreadPool& pool = ThreadPool::instance();
+        unsigned rowBlocks = (M + MC - 1) / MC;
+
+        // Буфер упаковки B общий для всех потоков и переиспользуется между вызовами
+        thread_local std::vector<T> bufferB;
+
+        for (unsigned jc = 0; jc < N; jc += NC) {
+            unsigned nc = std::min(NC, N - jc);
+            unsigned panels = (nc + NR - 1) / NR;
+            // Если блоков строк меньше, чем потоков, панель B дополнительно делится по столбцам
+            unsigned slabs = std::min(panels, std::max(1u, pool.size() / rowBlocks));
+            unsigned slabWidth = (panels + slabs - 1) / slabs * NR;
+
+            for (unsigned pc = 0; pc < K; pc += KC) {
+                unsigned kc = std::min(KC, K - pc);
+
+                bufferB.resize(static_cast<size_t>(roundUp(nc, NR)) * kc);
+                packB(kc, nc, B + static_cast<size_t>(pc) * ldb + jc, ldb, bufferB.data());
+                const T* packedB = bufferB.data();
+
+                size_t flopsPerTile = static_cast<size_t>(std::min(MC, M)) * kc * std::min(slabWidth, nc);
+                pool.parallelFor(0, static_cast<size_t>(rowBlocks) * slabs, flopsPerTile >= 65536 ? 1 : 4,
+                    [&](size_t from, size_t to) {
+                        // Буфер упаковки A у каждого потока свой
+                        thread_local std::vector<T> bufferA;
+                        for (size_t tile = from; tile < to; ++tile) {
+                            unsigned ic = static_cast<unsigned>(tile / slabs) * MC;
+                            unsigned jr = static_cast<unsigned>(tile % slabs) * slabWidth;
+                            if (jr >= nc) {
+                                continue;
+                            }
+                            unsigned mc = std::min(MC, M - ic);
+                            unsigned width = std::min(slabWidth, nc - jr);
+
+                            bufferA.resize(static_cast<size_t>(roundUp(mc, MR)) * kc);
+                            packA(mc, kc, A + static_cast<size_t>(ic) * lda + pc, lda, alpha, bufferA.data());
+
+                            macroKernel(mc, width, kc, bufferA.data(), packedB + static_cast<size_t>(jr) * kc,
+                                        C + static_cast<size_t>(ic) * ldc + jc + jr, ldc);
+                        }
+                    });
+            }
+        }
+    }
+};
+
+#endif
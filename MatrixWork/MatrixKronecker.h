@@ -0,0 +1,429 @@
+#ifndef MATRIXKRONECKER_H
+#define MATRIXKRONECKER_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixDiagonal.h"
+#include "MatrixBlock.h"
+#include "MatrixGemm.h"
+#include "MatrixTranspose.h"
+#include "MatrixSimd.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "ThreadPool.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <memory>
+#include <vector>
+
+// Ленивое произведение Кронекера A ⊗ B: хранятся только множители.
+// A - m x n, B - p x q, матрица имеет размер (m * p) x (n * q) и
+// элемент (i, j) равен A(i / p, j / q) * B(i % p, j % q).
+template <typename T = double>
+class MatrixKronecker : public Matrix<T> {
+private:
+    std::shared_ptr<const Matrix<T>> _left;
+    std::shared_ptr<const Matrix<T>> _right;
+
+    // Копия множителя; матрицы неизвестного вида копируются в плотную
+    static std::shared_ptr<const Matrix<T>> copyOf(const Matrix<T>& matrix) {
+        switch (matrix.kind()) {
+        case MatrixKind::Dense:
+            return std::make_shared<MatrixDense<T>>(static_cast<const MatrixDense<T>&>(matrix));
+        case MatrixKind::Diagonal:
+            return std::make_shared<MatrixDiagonal<T>>(static_cast<const MatrixDiagonal<T>&>(matrix));
+        case MatrixKind::Block:
+            return std::make_shared<MatrixBlock<T>>(static_cast<const MatrixBlock<T>&>(matrix));
+        case MatrixKind::Kronecker:
+            return std::make_shared<MatrixKronecker<T>>(static_cast<const MatrixKronecker<T>&>(matrix));
+        case MatrixKind::Sparse:
+            return std::make_shared<MatrixSparseCSR<T>>(static_cast<const MatrixSparseCSR<T>&>(matrix));
+        case MatrixKind::Banded:
+            return std::make_shared<MatrixBanded<T>>(static_cast<const MatrixBanded<T>&>(matrix));
+        default: {
+            std::unique_ptr<MatrixDense<T>> storage;
+            denseOf(matrix, storage);
+            return std::shared_ptr<const Matrix<T>>(storage.release());
+        }
+        }
+    }
+
+    // Построчный буфер матрицы: у плотной - её хранилище, иначе копия в storage
+    static const T* denseOf(const Matrix<T>& matrix, std::unique_ptr<MatrixDense<T>>& storage) {
+        if (matrix.kind() == MatrixKind::Dense) {
+            return static_cast<const MatrixDense<T>&>(matrix).rawData();
+        }
+        unsigned m = matrix.rows(), n = matrix.cols();
+        storage.reset(new MatrixDense<T>(m, n, MatrixUninitialized()));
+        T* values = storage->rawData();
+        ThreadPool::instance().parallelFor(0, m, ThreadPool::rowGrain(n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < n; ++j) {
+                    values[static_cast<size_t>(i) * n + j] = matrix(i, j);
+                }
+            }
+        });
+        return values;
+    }
+
+    static std::shared_ptr<const Matrix<T>> own(Matrix<T>* matrix) {
+        return std::shared_ptr<const Matrix<T>>(matrix);
+    }
+
+    // out = (A ⊗ B) * C, где C - (n * q) x r, out - (m * p) x r.
+    // По тождеству смешанного произведения сначала Z_j = B * C_j для каждой
+    // полосы C_j из q строк, затем out = A * Z, где Z рассматривается как
+    // матрица n x (p * r): вместо m * n * p * q * r операций выполняется
+    // n * p * q * r + m * n * p * r
+    void multiplyInto(const T* C, unsigned r, T* out) const {
+        unsigned m = _left->rows(), n = _left->cols();
+        unsigned p = _right->rows(), q = _right->cols();
+        size_t slab = static_cast<size_t>(p) * r;
+
+        std::unique_ptr<MatrixDense<T>> rightStorage;
+        const T* B = denseOf(*_right, rightStorage);
+        MatrixDense<T> Z(n * p, r, MatrixUninitialized());
+        T* z = Z.rawData();
+
+        // При малом числе полос параллелится само ядро умножения
+        ThreadPool& pool = ThreadPool::instance();
+        auto stripes = [&](size_t from, size_t to) {
+            for (size_t j = from; j < to; ++j) {
+                MatrixGemm<T>::multiply(p, r, q, T(1), B, q, C + j * q * r, r, T(), z + j * slab, r);
+            }
+        };
+        if (n >= pool.size()) {
+            pool.parallelFor(0, n, 1, stripes);
+        } else {
+            stripes(0, n);
+        }
+
+        // Диагональный левый множитель только масштабирует полосы Z
+        if (_left->kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(*_left).rawData();
+            pool.parallelFor(0, m, ThreadPool::rowGrain(slab), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    MatrixSimd::scale(z + i * slab, d[i], out + i * slab, slab);
+                }
+            });
+            return;
+        }
+
+        std::unique_ptr<MatrixDense<T>> leftStorage;
+        const T* A = denseOf(*_left, leftStorage);
+        MatrixGemm<T>::multiply(m, static_cast<unsigned>(slab), n, T(1), A, n, z, static_cast<unsigned>(slab), T(), out, static_cast<unsigned>(slab));
+    }
+
+    // out = alpha * (A ⊗ B) * C + beta * out для построчно хранимой C ((n * q) x r):
+    // смешанное произведение пишется сразу в out, если масштабировать не нужно
+    void productInto(const T* C, unsigned r, T alpha, T beta, MatrixDense<T>& out) const {
+        if (alpha == T(1) && beta == T()) {
+            multiplyInto(C, r, out.rawData());
+            return;
+        }
+        MatrixDense<T> product(rows(), r, MatrixUninitialized());
+        multiplyInto(C, r, product.rawData());
+        const T* z = product.rawData();
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, static_cast<size_t>(rows()) * r, ThreadPool::rowGrain(1), [&](size_t from, size_t to) {
+            for (size_t k = from; k < to; ++k) {
+                c[k] = beta == T() ? alpha * z[k] : alpha * z[k] + beta * c[k];
+            }
+        });
+    }
+
+    bool sameFactorShapes(const MatrixKronecker<T>& other) const {
+        return _left->rows() == other._left->rows() && _left->cols() == other._left->cols() &&
+               _right->rows() == other._right->rows() && _right->cols() == other._right->cols();
+    }
+
+public:
+    // Конструктор по общим множителям (без копирования)
+    MatrixKronecker(std::shared_ptr<const Matrix<T>> left, std::shared_ptr<const Matrix<T>> right)
+        : _left(std::move(left)), _right(std::move(right)) {
+        if (!_left || !_right) {
+            throw std::invalid_argument("Множители произведения Кронекера не заданы.");
+        }
+    }
+
+    // Конструктор с копированием множителей
+    MatrixKronecker(const Matrix<T>& left, const Matrix<T>& right)
+        : _left(copyOf(left)), _right(copyOf(right)) {}
+
+    // Копия разделяет неизменяемые множители
+    MatrixKronecker(const MatrixKronecker<T>& other) = default;
+    MatrixKronecker<T>& operator=(const MatrixKronecker<T>& other) = default;
+
+    unsigned rows() const override { return _left->rows() * _right->rows(); }
+    unsigned cols() const override { return _left->cols() * _right->cols(); }
+
+    MatrixKind kind() const override { return MatrixKind::Kronecker; }
+
+    const Matrix<T>& left() const { return *_left; }
+    const Matrix<T>& right() const { return *_right; }
+
+    // Доступ к элементам за O(1)
+    T operator()(unsigned i, unsigned j) const override {
+        unsigned p = _right->rows(), q = _right->cols();
+        return (*_left)(i / p, j / q) * (*_right)(i % p, j % q);
+    }
+
+    // y = (A ⊗ B) * x, x длины n * q, y длины m * p.
+    // x рассматривается как матрица X (n x q), тогда y - это A * X * B^T
+    void multiplyVector(const T* x, T* y) const {
+        unsigned m = _left->rows(), n = _left->cols();
+        unsigned p = _right->rows(), q = _right->cols();
+
+        std::unique_ptr<MatrixDense<T>> rightStorage;
+        const T* B = denseOf(*_right, rightStorage);
+        MatrixDense<T> rightTransposed(q, p, MatrixUninitialized());
+        MatrixTranspose<T>::transpose(p, q, B, q, rightTransposed.rawData(), p);
+
+        // Z = X * B^T (n x p)
+        MatrixDense<T> Z(n, p, MatrixUninitialized());
+        MatrixGemm<T>::multiply(n, p, q, T(1), x, q, rightTransposed.rawData(), p, T(), Z.rawData(), p);
+
+        if (_left->kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(*_left).rawData();
+            ThreadPool::instance().parallelFor(0, m, ThreadPool::rowGrain(p), [&](size_t from, size_t to) {
+                for (size_t i = from; i < to; ++i) {
+                    MatrixSimd::scale(Z.rawData() + i * p, d[i], y + i * p, p);
+                }
+            });
+            return;
+        }
+
+        // y = A * Z (m x p)
+        std::unique_ptr<MatrixDense<T>> leftStorage;
+        const T* A = denseOf(*_left, leftStorage);
+        MatrixGemm<T>::multiply(m, p, n, T(1), A, n, Z.rawData(), p, T(), y, p);
+    }
+
+    std::vector<T> multiplyVector(const std::vector<T>& x) const {
+        if (x.size() != cols()) {
+            throw std::invalid_argument("Длина вектора должна совпадать с числом столбцов матрицы.");
+        }
+        std::vector<T> y(rows());
+        multiplyVector(x.data(), y.data());
+        return y;
+    }
+
+    // Явное представление: блочная матрица m x n из блоков p x q, блок (i, j) равен
+    // A(i, j) * B и отсутствует при A(i, j) == 0 (при диагональном A - блочно-диагональная)
+    MatrixBlock<T>* materialize() const {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::materialize", T, (_left->rows(), _left->cols(), _right->rows(), _right->cols()), 1.0 * rows() * cols(),
+                           sizeof(T) * rows() * cols());
+        unsigned m = _left->rows(), n = _left->cols();
+        unsigned p = _right->rows(), q = _right->cols();
+        size_t blockSize = static_cast<size_t>(p) * q;
+
+        std::unique_ptr<MatrixDense<T>> rightStorage;
+        const T* B = denseOf(*_right, rightStorage);
+        std::unique_ptr<MatrixBlock<T>> result(new MatrixBlock<T>(m, n, p, q));
+
+        ThreadPool::instance().parallelFor(0, m, ThreadPool::rowGrain(static_cast<size_t>(n) * blockSize), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < n; ++j) {
+                    T a = (*_left)(i, j);
+                    if (a == T()) {
+                        continue;
+                    }
+                    auto block = std::make_shared<MatrixDense<T>>(p, q, MatrixUninitialized());
+                    MatrixSimd::scale(B, a, block->rawData(), blockSize);
+                    result->setBlock(i, j, block);
+                }
+            }
+        });
+        return result.release();
+    }
+
+    // Матрица неизменяема: изменение на месте потребовало бы явного представления
+    Matrix<T>& operator+=(const Matrix<T>&) override {
+        throw std::runtime_error("MatrixKronecker не изменяется на месте; используйте materialize().");
+    }
+
+    Matrix<T>& operator-=(const Matrix<T>&) override {
+        throw std::runtime_error("MatrixKronecker не изменяется на месте; используйте materialize().");
+    }
+
+    // Оператор сложения
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::operator+", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для сложения.");
+        }
+        std::unique_ptr<MatrixBlock<T>> block(materialize());
+        *block += other;
+        return block.release();
+    }
+
+    // Оператор вычитания
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::operator-", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для вычитания.");
+        }
+        std::unique_ptr<MatrixBlock<T>> block(materialize());
+        *block -= other;
+        return block.release();
+    }
+
+    // Матричное умножение: (A ⊗ B)(C ⊗ D) = (AC) ⊗ (BD), иначе смешанное произведение с плотной матрицей
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::operator*", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * other.rows() * other.cols() + 1.0 * rows() * other.cols()));
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+
+        if (other.kind() == MatrixKind::Kronecker) {
+            const MatrixKronecker<T>& kron = static_cast<const MatrixKronecker<T>&>(other);
+            if (_left->cols() == kron._left->rows() && _right->cols() == kron._right->rows()) {
+                return new MatrixKronecker<T>(own(*_left * *kron._left), own(*_right * *kron._right));
+            }
+        }
+
+        std::unique_ptr<MatrixDense<T>> storage;
+        const T* C = denseOf(other, storage);
+        MatrixDense<T>* result = new MatrixDense<T>(rows(), other.cols(), MatrixUninitialized());
+        multiplyInto(C, other.cols(), result->rawData());
+        return result;
+    }
+
+    // Почленное умножение: (A ⊗ B) ∘ (C ⊗ D) = (A ∘ C) ⊗ (B ∘ D) при совпадающих размерах множителей
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::elemMult", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для почленного умножения.");
+        }
+
+        if (other.kind() == MatrixKind::Kronecker) {
+            const MatrixKronecker<T>& kron = static_cast<const MatrixKronecker<T>&>(other);
+            if (sameFactorShapes(kron)) {
+                return new MatrixKronecker<T>(own(_left->elemMult(*kron._left)), own(_right->elemMult(*kron._right)));
+            }
+        }
+
+        std::unique_ptr<MatrixBlock<T>> block(materialize());
+        return block->elemMult(other);
+    }
+
+    // Почленное деление
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::elemDiv", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        if (rows() != other.rows() || cols() != other.cols()) {
+            throw std::invalid_argument("Размеры матриц должны совпадать для почленного деления.");
+        }
+
+        if (other.kind() == MatrixKind::Kronecker) {
+            const MatrixKronecker<T>& kron = static_cast<const MatrixKronecker<T>&>(other);
+            if (sameFactorShapes(kron)) {
+                if (hasZeroElement(*kron._left) || hasZeroElement(*kron._right)) {
+                    throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+                }
+                return new MatrixKronecker<T>(own(_left->elemDiv(*kron._left)), own(_right->elemDiv(*kron._right)));
+            }
+        }
+
+        std::unique_ptr<MatrixBlock<T>> block(materialize());
+        return block->elemDiv(other);
+    }
+
+    // Транспонирование: (A ⊗ B)^T = A^T ⊗ B^T
+    Matrix<T>* transpose() const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::transpose", T, (_left->rows(), _left->cols(), _right->rows(), _right->cols()), 0,
+                           2.0 * sizeof(T) * (1.0 * _left->rows() * _left->cols() + 1.0 * _right->rows() * _right->cols()));
+        return new MatrixKronecker<T>(own(_left->transpose()), own(_right->transpose()));
+    }
+
+    // y = alpha * (A ⊗ B) * x + beta * y через multiplyVector без явного произведения
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::gemv", T, (rows(), cols(), x.size(), 1), 2.0 * x.size() * (_left->rows() + _right->cols()),
+                           sizeof(T) * (3.0 * x.size()));
+        this->checkGemv(x, y);
+        Vector<T> product(rows());
+        multiplyVector(x.rawData(), product.rawData());
+        for (unsigned i = 0; i < rows(); ++i) {
+            y[i] = beta == T() ? alpha * product[i] : alpha * product[i] + beta * y[i];
+        }
+    }
+
+    // Y = alpha * (A ⊗ B) * X + beta * Y: все векторы - одним смешанным произведением
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::gemvBatch", T, (rows(), cols(), X.rows(), X.cols()), 2.0 * X.rows() * X.cols() * (_left->rows() + _right->cols()),
+                           sizeof(T) * (1.0 * X.rows() * X.cols() + 2.0 * Y.rows() * Y.cols()));
+        this->checkGemvBatch(X, Y);
+        productInto(X.rawData(), X.cols(), alpha, beta, Y);
+    }
+
+    // out = alpha * (A ⊗ B) * other + beta * out через смешанное произведение
+    // с построчным буфером other (см. operator*)
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::multiplyInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * other.rows() * other.cols() * (_left->rows() + _right->cols()),
+                           sizeof(T) * (1.0 * other.rows() * other.cols() + 2.0 * rows() * other.cols()));
+        if (cols() != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, rows(), other.cols(), true);
+        std::unique_ptr<MatrixDense<T>> storage;
+        const T* C = denseOf(other, storage);
+        productInto(C, other.cols(), alpha, beta, out);
+    }
+
+    // Импорт из файла: множители читаются как плотные матрицы
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
+
+        if (reader.line() != "MatrixKronecker") {
+            throw std::runtime_error("Файл не содержит данные MatrixKronecker.");
+        }
+
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
+        unsigned p = reader.value<unsigned>();
+        unsigned q = reader.value<unsigned>();
+
+        auto left = std::make_shared<MatrixDense<T>>(m, n, MatrixUninitialized());
+        reader.values(left->rawData(), static_cast<size_t>(m) * n);
+        auto right = std::make_shared<MatrixDense<T>>(p, q, MatrixUninitialized());
+        reader.values(right->rawData(), static_cast<size_t>(p) * q);
+
+        _left = left;
+        _right = right;
+        MATRIX_TRACE_UPDATE((m, n, p, q), 0, sizeof(T) * (1.0 * m * n + 1.0 * p * q));
+    }
+
+    // Экспорт в файл: размеры обоих множителей, затем их элементы построчно
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixKronecker::exportToFile", T, (_left->rows(), _left->cols(), _right->rows(), _right->cols()), 0,
+                           sizeof(T) * (1.0 * _left->rows() * _left->cols() + 1.0 * _right->rows() * _right->cols()));
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixKronecker\n" + std::to_string(_left->rows()) + " " + std::to_string(_left->cols()) + " " +
+                    std::to_string(_right->rows()) + " " + std::to_string(_right->cols()) + "\n");
+        for (const Matrix<T>* factor : {_left.get(), _right.get()}) {
+            writer.units(factor->rows(), static_cast<size_t>(factor->cols()) * 14 + 1, [factor](size_t i, std::string& buffer) {
+                for (unsigned j = 0; j < factor->cols(); ++j) {
+                    MatrixTextValue::append(buffer, (*factor)(static_cast<unsigned>(i), j));
+                }
+                buffer += '\n';
+            });
+        }
+
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        for (unsigned i = 0; i < rows(); ++i) {
+            for (unsigned j = 0; j < cols(); ++j) {
+                os << (*this)(i, j) << "\t";
+            }
+            os << "\n";
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,466 @@
+#ifndef MATRIXSIMD_H
+#define MATRIXSIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MATRIX_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Функции с векторными инструкциями компилируются под свой набор инструкций
+// независимо от флагов сборки; какой из них вызывать, решается во время выполнения
+#if defined(MATRIX_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MATRIX_SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MATRIX_SIMD_TARGET(isa)
+#endif
+
+// Доступный набор векторных инструкций, по возрастанию
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+enum class MatrixSimdOp {
+    Add,
+    Sub,
+    Mul,
+    Div
+};
+
+// Поэлементные операции, для которых есть векторные ядра.
+// Деление не проверяет делитель: проверка выполняется заранее (MatrixSimd::hasZero)
+struct MatrixSimdAdd {
+    static constexpr MatrixSimdOp code = MatrixSimdOp::Add;
+    template <typename T> T operator()(T a, T b) const { return a + b; }
+};
+
+struct MatrixSimdSub {
+    static constexpr MatrixSimdOp code = MatrixSimdOp::Sub;
+    template <typename T> T operator()(T a, T b) const { return a - b; }
+};
+
+struct MatrixSimdMul {
+    static constexpr MatrixSimdOp code = MatrixSimdOp::Mul;
+    template <typename T> T operator()(T a, T b) const { return a * b; }
+};
+
+struct MatrixSimdDiv {
+    static constexpr MatrixSimdOp code = MatrixSimdOp::Div;
+    template <typename T> T operator()(T a, T b) const { return a / b; }
+};
+
+// Есть ли у операции векторное ядро (произвольные функторы обрабатываются скалярно)
+template <typename Op, typename = void>
+struct MatrixSimdKernel : std::false_type {};
+
+template <typename Op>
+struct MatrixSimdKernel<Op, decltype(void(Op::code))> : std::true_type {};
+
+#ifdef MATRIX_SIMD_X86
+
+// Преобразования AVX-512 оставляют неопределённые верхние части регистров, на что
+// GCC выдаёт ложные предупреждения
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Операции над регистром для каждого набора инструкций и типа элементов.
+// Целочисленное деление выполняется через double: для 32-битных операндов частное
+// после отбрасывания дробной части совпадает с целочисленным
+template <typename T> struct SimdSse2;
+template <typename T> struct SimdAvx2;
+template <typename T> struct SimdAvx512;
+
+template <>
+struct SimdSse2<float> {
+    using Reg = __m128;
+    static constexpr size_t width = 4;
+    MATRIX_SIMD_TARGET("sse2") static Reg load(const float* p) { return _mm_loadu_ps(p); }
+    MATRIX_SIMD_TARGET("sse2") static void store(float* p, Reg x) { _mm_storeu_ps(p, x); }
+    MATRIX_SIMD_TARGET("sse2") static Reg broadcast(float value) { return _mm_set1_ps(value); }
+    MATRIX_SIMD_TARGET("sse2") static Reg add(Reg x, Reg y) { return _mm_add_ps(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg sub(Reg x, Reg y) { return _mm_sub_ps(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg mul(Reg x, Reg y) { return _mm_mul_ps(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg div(Reg x, Reg y) { return _mm_div_ps(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static bool hasZero(Reg x) { return _mm_movemask_ps(_mm_cmpeq_ps(x, _mm_setzero_ps())) != 0; }
+};
+
+template <>
+struct SimdSse2<double> {
+    using Reg = __m128d;
+    static constexpr size_t width = 2;
+    MATRIX_SIMD_TARGET("sse2") static Reg load(const double* p) { return _mm_loadu_pd(p); }
+    MATRIX_SIMD_TARGET("sse2") static void store(double* p, Reg x) { _mm_storeu_pd(p, x); }
+    MATRIX_SIMD_TARGET("sse2") static Reg broadcast(double value) { return _mm_set1_pd(value); }
+    MATRIX_SIMD_TARGET("sse2") static Reg add(Reg x, Reg y) { return _mm_add_pd(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg sub(Reg x, Reg y) { return _mm_sub_pd(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg mul(Reg x, Reg y) { return _mm_mul_pd(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg div(Reg x, Reg y) { return _mm_div_pd(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static bool hasZero(Reg x) { return _mm_movemask_pd(_mm_cmpeq_pd(x, _mm_setzero_pd())) != 0; }
+};
+
+template <>
+struct SimdSse2<int32_t> {
+    using Reg = __m128i;
+    static constexpr size_t width = 4;
+    MATRIX_SIMD_TARGET("sse2") static Reg load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    MATRIX_SIMD_TARGET("sse2") static void store(int32_t* p, Reg x) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x); }
+    MATRIX_SIMD_TARGET("sse2") static Reg broadcast(int32_t value) { return _mm_set1_epi32(value); }
+    MATRIX_SIMD_TARGET("sse2") static Reg add(Reg x, Reg y) { return _mm_add_epi32(x, y); }
+    MATRIX_SIMD_TARGET("sse2") static Reg sub(Reg x, Reg y) { return _mm_sub_epi32(x, y); }
+    // В SSE2 нет умножения 32-битных целых: чётные и нечётные элементы
+    // перемножаются отдельно, младшие половины произведений собираются обратно
+    MATRIX_SIMD_TARGET("sse2") static Reg mul(Reg x, Reg y) {
+        __m128i even = _mm_mul_epu32(x, y);
+        __m128i odd = _mm_mul_epu32(_mm_srli_si128(x, 4), _mm_srli_si128(y, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    MATRIX_SIMD_TARGET("sse2") static Reg div(Reg x, Reg y) {
+        __m128i low = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(x), _mm_cvtepi32_pd(y)));
+        __m128i high = _mm_cvttpd_epi32(_mm_div_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))),
+                                                   _mm_cvtepi32_pd(_mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2)))));
+        return _mm_unpacklo_epi64(low, high);
+    }
+    MATRIX_SIMD_TARGET("sse2") static bool hasZero(Reg x) { return _mm_movemask_epi8(_mm_cmpeq_epi32(x, _mm_setzero_si128())) != 0; }
+};
+
+template <>
+struct SimdAvx2<float> {
+    using Reg = __m256;
+    static constexpr size_t width = 8;
+    MATRIX_SIMD_TARGET("avx2") static Reg load(const float* p) { return _mm256_loadu_ps(p); }
+    MATRIX_SIMD_TARGET("avx2") static void store(float* p, Reg x) { _mm256_storeu_ps(p, x); }
+    MATRIX_SIMD_TARGET("avx2") static Reg broadcast(float value) { return _mm256_set1_ps(value); }
+    MATRIX_SIMD_TARGET("avx2") static Reg add(Reg x, Reg y) { return _mm256_add_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg sub(Reg x, Reg y) { return _mm256_sub_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg mul(Reg x, Reg y) { return _mm256_mul_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg div(Reg x, Reg y) { return _mm256_div_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static bool hasZero(Reg x) { return _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ)) != 0; }
+};
+
+template <>
+struct SimdAvx2<double> {
+    using Reg = __m256d;
+    static constexpr size_t width = 4;
+    MATRIX_SIMD_TARGET("avx2") static Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    MATRIX_SIMD_TARGET("avx2") static void store(double* p, Reg x) { _mm256_storeu_pd(p, x); }
+    MATRIX_SIMD_TARGET("avx2") static Reg broadcast(double value) { return _mm256_set1_pd(value); }
+    MATRIX_SIMD_TARGET("avx2") static Reg add(Reg x, Reg y) { return _mm256_add_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg sub(Reg x, Reg y) { return _mm256_sub_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg mul(Reg x, Reg y) { return _mm256_mul_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg div(Reg x, Reg y) { return _mm256_div_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static bool hasZero(Reg x) { return _mm256_movemask_pd(_mm256_cmp_pd(x, _mm256_setzero_pd(), _CMP_EQ_OQ)) != 0; }
+};
+
+template <>
+struct SimdAvx2<int32_t> {
+    using Reg = __m256i;
+    static constexpr size_t width = 8;
+    MATRIX_SIMD_TARGET("avx2") static Reg load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    MATRIX_SIMD_TARGET("avx2") static void store(int32_t* p, Reg x) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x); }
+    MATRIX_SIMD_TARGET("avx2") static Reg broadcast(int32_t value) { return _mm256_set1_epi32(value); }
+    MATRIX_SIMD_TARGET("avx2") static Reg add(Reg x, Reg y) { return _mm256_add_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg sub(Reg x, Reg y) { return _mm256_sub_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg mul(Reg x, Reg y) { return _mm256_mullo_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx2") static Reg div(Reg x, Reg y) {
+        __m128i low = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(x)),
+                                                        _mm256_cvtepi32_pd(_mm256_castsi256_si128(y))));
+        __m128i high = _mm256_cvttpd_epi32(_mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(x, 1)),
+                                                         _mm256_cvtepi32_pd(_mm256_extracti128_si256(y, 1))));
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+    }
+    MATRIX_SIMD_TARGET("avx2") static bool hasZero(Reg x) { return _mm256_movemask_epi8(_mm256_cmpeq_epi32(x, _mm256_setzero_si256())) != 0; }
+};
+
+template <>
+struct SimdAvx512<float> {
+    using Reg = __m512;
+    static constexpr size_t width = 16;
+    MATRIX_SIMD_TARGET("avx512f") static Reg load(const float* p) { return _mm512_loadu_ps(p); }
+    MATRIX_SIMD_TARGET("avx512f") static void store(float* p, Reg x) { _mm512_storeu_ps(p, x); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg broadcast(float value) { return _mm512_set1_ps(value); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg add(Reg x, Reg y) { return _mm512_add_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg sub(Reg x, Reg y) { return _mm512_sub_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg mul(Reg x, Reg y) { return _mm512_mul_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg div(Reg x, Reg y) { return _mm512_div_ps(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static bool hasZero(Reg x) { return _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_EQ_OQ) != 0; }
+};
+
+template <>
+struct SimdAvx512<double> {
+    using Reg = __m512d;
+    static constexpr size_t width = 8;
+    MATRIX_SIMD_TARGET("avx512f") static Reg load(const double* p) { return _mm512_loadu_pd(p); }
+    MATRIX_SIMD_TARGET("avx512f") static void store(double* p, Reg x) { _mm512_storeu_pd(p, x); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg broadcast(double value) { return _mm512_set1_pd(value); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg add(Reg x, Reg y) { return _mm512_add_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg sub(Reg x, Reg y) { return _mm512_sub_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg mul(Reg x, Reg y) { return _mm512_mul_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg div(Reg x, Reg y) { return _mm512_div_pd(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static bool hasZero(Reg x) { return _mm512_cmp_pd_mask(x, _mm512_setzero_pd(), _CMP_EQ_OQ) != 0; }
+};
+
+template <>
+struct SimdAvx512<int32_t> {
+    using Reg = __m512i;
+    static constexpr size_t width = 16;
+    MATRIX_SIMD_TARGET("avx512f") static Reg load(const int32_t* p) { return _mm512_loadu_si512(p); }
+    MATRIX_SIMD_TARGET("avx512f") static void store(int32_t* p, Reg x) { _mm512_storeu_si512(p, x); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg broadcast(int32_t value) { return _mm512_set1_epi32(value); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg add(Reg x, Reg y) { return _mm512_add_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg sub(Reg x, Reg y) { return _mm512_sub_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg mul(Reg x, Reg y) { return _mm512_mullo_epi32(x, y); }
+    MATRIX_SIMD_TARGET("avx512f") static Reg div(Reg x, Reg y) {
+        __m256i low = _mm512_cvttpd_epi32(_mm512_div_pd(_mm512_cvtepi32_pd(_mm512_castsi512_si256(x)),
+                                                        _mm512_cvtepi32_pd(_mm512_castsi512_si256(y))));
+        __m256i high = _mm512_cvttpd_epi32(_mm512_div_pd(_mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(x, 1)),
+                                                         _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(y, 1))));
+        return _mm512_inserti64x4(_mm512_castsi256_si512(low), high, 1);
+    }
+    MATRIX_SIMD_TARGET("avx512f") static bool hasZero(Reg x) { return _mm512_cmpeq_epi32_mask(x, _mm512_setzero_si512()) != 0; }
+};
+
+// Циклы по буферу для одного набора инструкций; хвост короче регистра обрабатывается скалярно
+#define MATRIX_SIMD_LOOPS(Name, Traits, isa)                                                     \
+    template <typename Op, typename T>                                                           \
+    MATRIX_SIMD_TARGET(isa) static void apply##Name(const T* a, const T* b, T* c, size_t count) { \
+        using V = Traits<T>;                                                                     \
+        size_t k = 0;                                                                            \
+        for (; k + V::width <= count; k += V::width) {                                           \
+            typename V::Reg x = V::load(a + k), y = V::load(b + k);                              \
+            switch (Op::code) {                                                                  \
+            case MatrixSimdOp::Add: V::store(c + k, V::add(x, y)); break;                        \
+            case MatrixSimdOp::Sub: V::store(c + k, V::sub(x, y)); break;                        \
+            case MatrixSimdOp::Mul: V::store(c + k, V::mul(x, y)); break;                        \
+            case MatrixSimdOp::Div: V::store(c + k, V::div(x, y)); break;                        \
+            }                                                                                    \
+        }                                                                                        \
+        for (; k < count; ++k) {                                                                 \
+            c[k] = Op()(a[k], b[k]);                                                             \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    template <typename T>                                                                        \
+    MATRIX_SIMD_TARGET(isa) static bool hasZero##Name(const T* values, size_t count) {           \
+        using V = Traits<T>;                                                                     \
+        size_t k = 0;                                                                            \
+        for (; k + V::width <= count; k += V::width) {                                           \
+            if (V::hasZero(V::load(values + k))) {                                               \
+                return true;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+        for (; k < count; ++k) {                                                                 \
+            if (values[k] == T()) {                                                              \
+                return true;                                                                     \
+            }                                                                                    \
+        }                                                                                        \
+        return false;                                                                            \
+    }                                                                                            \
+                                                                                                 \
+    template <typename T>                                                                        \
+    MATRIX_SIMD_TARGET(isa) static void scale##Name(const T* a, T value, T* c, size_t count) {   \
+        using V = Traits<T>;                                                                     \
+        typename V::Reg factor = V::broadcast(value);                                            \
+        size_t k = 0;                                                                            \
+        for (; k + V::width <= count; k += V::width) {                                           \
+            V::store(c + k, V::mul(V::load(a + k), factor));                                     \
+        }                                                                                        \
+        for (; k < count; ++k) {                                                                 \
+            c[k] = a[k] * value;                                                                 \
+        }                                                                                        \
+    }                                                                                            \
+                                                                                                 \
+    template <typename T>                                                                        \
+    MATRIX_SIMD_TARGET(isa) static T dot##Name(const T* a, const T* b, size_t count) {           \
+        using V = Traits<T>;                                                                     \
+        typename V::Reg s0 = V::broadcast(T()), s1 = s0;                                         \
+        size_t k = 0;                                                                            \
+        for (; k + 2 * V::width <= count; k += 2 * V::width) {                                   \
+            s0 = V::add(s0, V::mul(V::load(a + k), V::load(b + k)));                             \
+            s1 = V::add(s1, V::mul(V::load(a + k + V::width), V::load(b + k + V::width)));       \
+        }                                                                                        \
+        for (; k + V::width <= count; k += V::width) {                                           \
+            s0 = V::add(s0, V::mul(V::load(a + k), V::load(b + k)));                             \
+        }                                                                                        \
+        T lanes[V::width];                                                                       \
+        V::store(lanes, V::add(s0, s1));                                                         \
+        T sum = T();                                                                             \
+        for (size_t l = 0; l < V::width; ++l) {                                                  \
+            sum += lanes[l];                                                                     \
+        }                                                                                        \
+        for (; k < count; ++k) {                                                                 \
+            sum += a[k] * b[k];                                                                  \
+        }                                                                                        \
+        return sum;                                                                              \
+    }
+
+#endif
+
+// Векторные ядра поэлементных операций над непрерывными буферами.
+// Для float, double и int32 ядро выбирается по возможностям процессора (CPUID),
+// для остальных типов и не-x86 процессоров используется скалярный цикл
+class MatrixSimd {
+private:
+    static SimdLevel detect() {
+#if defined(MATRIX_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return SimdLevel::SSE2;
+        }
+        return SimdLevel::Scalar;
+#elif defined(MATRIX_SIMD_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+        // Регистры AVX должны сохраняться операционной системой
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        if (maxLeaf >= 7 && (xcr0 & 0x6) == 0x6) {
+            __cpuidex(info, 7, 0);
+            if ((info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6) {
+                return SimdLevel::AVX512;
+            }
+            if ((info[1] & (1 << 5)) != 0) {
+                return SimdLevel::AVX2;
+            }
+        }
+        return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    static SimdLevel detected() {
+        static const SimdLevel level = detect();
+        return level;
+    }
+
+    static std::atomic<int>& active() {
+        static std::atomic<int> level(static_cast<int>(detected()));
+        return level;
+    }
+
+    template <typename T>
+    static constexpr bool vectorized() {
+        return std::is_same<T, float>::value || std::is_same<T, double>::value || std::is_same<T, int32_t>::value;
+    }
+
+#ifdef MATRIX_SIMD_X86
+    MATRIX_SIMD_LOOPS(Sse2, SimdSse2, "sse2")
+    MATRIX_SIMD_LOOPS(Avx2, SimdAvx2, "avx2")
+    MATRIX_SIMD_LOOPS(Avx512, SimdAvx512, "avx512f")
+#endif
+
+public:
+    static SimdLevel level() {
+        return static_cast<SimdLevel>(active().load(std::memory_order_relaxed));
+    }
+
+    // Ограничение набора инструкций (например, для сравнения ядер); уровень выше
+    // поддерживаемого процессором не включается
+    static void setLevel(SimdLevel level) {
+        active().store(static_cast<int>(std::min(level, detected())), std::memory_order_relaxed);
+    }
+
+    // c[k] = op(a[k], b[k]) для k < count; c может совпадать с a или b
+    template <typename Op, typename T>
+    static void apply(Op op, const T* a, const T* b, T* c, size_t count) {
+#ifdef MATRIX_SIMD_X86
+        if constexpr (vectorized<T>() && MatrixSimdKernel<Op>::value) {
+            switch (level()) {
+            case SimdLevel::AVX512: applyAvx512<Op>(a, b, c, count); return;
+            case SimdLevel::AVX2: applyAvx2<Op>(a, b, c, count); return;
+            case SimdLevel::SSE2: applySse2<Op>(a, b, c, count); return;
+            default: break;
+            }
+        }
+#endif
+        for (size_t k = 0; k < count; ++k) {
+            c[k] = op(a[k], b[k]);
+        }
+    }
+
+    // c[k] = a[k] * value для k < count; c может совпадать с a
+    template <typename T>
+    static void scale(const T* a, T value, T* c, size_t count) {
+#ifdef MATRIX_SIMD_X86
+        if constexpr (vectorized<T>()) {
+            switch (level()) {
+            case SimdLevel::AVX512: scaleAvx512(a, value, c, count); return;
+            case SimdLevel::AVX2: scaleAvx2(a, value, c, count); return;
+            case SimdLevel::SSE2: scaleSse2(a, value, c, count); return;
+            default: break;
+            }
+        }
+#endif
+        for (size_t k = 0; k < count; ++k) {
+            c[k] = a[k] * value;
+        }
+    }
+
+    // Скалярное произведение a и b длины count (порядок суммирования зависит от ядра)
+    template <typename T>
+    static T dot(const T* a, const T* b, size_t count) {
+#ifdef MATRIX_SIMD_X86
+        if constexpr (vectorized<T>()) {
+            switch (level()) {
+            case SimdLevel::AVX512: return dotAvx512(a, b, count);
+            case SimdLevel::AVX2: return dotAvx2(a, b, count);
+            case SimdLevel::SSE2: return dotSse2(a, b, count);
+            default: break;
+            }
+        }
+#endif
+        T sum = T();
+        for (size_t k = 0; k < count; ++k) {
+            sum += a[k] * b[k];
+        }
+        return sum;
+    }
+
+    // Есть ли среди count элементов нули
+    template <typename T>
+    static bool hasZero(const T* values, size_t count) {
+#ifdef MATRIX_SIMD_X86
+        if constexpr (vectorized<T>()) {
+            switch (level()) {
+            case SimdLevel::AVX512: return hasZeroAvx512(values, count);
+            case SimdLevel::AVX2: return hasZeroAvx2(values, count);
+            case SimdLevel::SSE2: return hasZeroSse2(values, count);
+            default: break;
+            }
+        }
+#endif
+        return std::find(values, values + count, T()) != values + count;
+    }
+};
+
+#ifdef MATRIX_SIMD_X86
+#undef MATRIX_SIMD_LOOPS
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+#endif
@@ -0,0 +1,748 @@
+#ifndef MATRIXSPARSECSR_H
+#define MATRIXSPARSECSR_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixDiagonal.h"
+#include "MatrixView.h"
+#include "MatrixSimd.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+// Элемент разреженной матрицы для построения по тройкам (строка, столбец, значение)
+template <typename T>
+struct MatrixTriplet {
+    unsigned row;
+    unsigned col;
+    T value;
+};
+
+// Разреженная матрица в формате CSR: для строки i её ненулевые элементы лежат
+// в columns/values на позициях [rowStart[i], rowStart[i + 1]) по возрастанию столбца.
+// Хранятся только ненулевые элементы: нули, получившиеся при построении и в результатах
+// операций, отбрасываются. Строки с разным числом элементов распределяются по потокам
+// отрезками с равным числом элементов (см. forRows).
+// Результаты операций с разреженной и диагональной матрицами разреженные, с плотной
+// и матрицами остальных видов - плотные
+template <typename T = double>
+class MatrixSparseCSR : public Matrix<T> {
+private:
+    unsigned _m, _n;
+    std::vector<size_t> _rowStart;
+    std::vector<unsigned> _columns;
+    std::vector<T> _values;
+
+    // Первая строка отрезка piece из pieces: вес строк до неё (элементы плюс rowCost
+    // на строку) не меньше доли piece / pieces от total; start == nullptr - строки без элементов
+    static unsigned rowAt(const size_t* start, unsigned m, size_t rowCost, size_t piece, size_t pieces, size_t total) {
+        if (piece >= pieces) {
+            return m;
+        }
+        size_t target = piece * total / pieces;
+        unsigned lo = 0, hi = m;
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+            size_t weight = (start ? start[mid] : 0) + static_cast<size_t>(mid) * rowCost;
+            if (weight < target) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // Параллельный обход строк [0, m) отрезками с примерно равным весом; body(from, to)
+    // получает диапазон строк, так что строки с большим числом элементов не собираются у одного потока
+    template <typename Body>
+    static void forRowsOf(const size_t* start, unsigned m, size_t rowCost, Body body) {
+        ThreadPool& pool = ThreadPool::instance();
+        size_t total = (start ? start[m] : 0) + static_cast<size_t>(m) * rowCost;
+        size_t pieces = std::max<size_t>(1, std::min<size_t>(m, static_cast<size_t>(pool.size()) * 4));
+        pool.parallelFor(0, pieces, ThreadPool::rowGrain(total / pieces + 1), [&](size_t from, size_t to) {
+            body(rowAt(start, m, rowCost, from, pieces, total), rowAt(start, m, rowCost, to, pieces, total));
+        });
+    }
+
+    template <typename Body>
+    void forRows(size_t rowCost, Body body) const {
+        forRowsOf(_rowStart.data(), _m, rowCost, body);
+    }
+
+    // Матрица m x n, собранная по строкам в два прохода: count(i) - число элементов строки i,
+    // затем fill(i, columns, values) записывает их, начиная с позиции строки в хранилище.
+    // Строки распределяются по весам start/rowCost (см. forRowsOf)
+    template <typename Count, typename Fill>
+    static MatrixSparseCSR<T> assemble(unsigned m, unsigned n, const size_t* start, size_t rowCost, Count count, Fill fill) {
+        MatrixSparseCSR<T> result(m, n);
+        size_t* offsets = result._rowStart.data();
+        forRowsOf(start, m, rowCost, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                offsets[i + 1] = count(i);
+            }
+        });
+        for (unsigned i = 0; i < m; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        result._columns.resize(offsets[m]);
+        result._values.resize(offsets[m]);
+        forRowsOf(start, m, rowCost, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                fill(i, result._columns.data() + offsets[i], result._values.data() + offsets[i]);
+            }
+        });
+        return result;
+    }
+
+    // Матрица из ненулевых значений f(i, j, v) по элементам this
+    template <typename F>
+    MatrixSparseCSR<T> mapped(F f) const {
+        return assemble(_m, _n, _rowStart.data(), 1, [&](unsigned i) {
+            size_t count = 0;
+            for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                count += f(i, _columns[k], _values[k]) != T();
+            }
+            return count;
+        }, [&](unsigned i, unsigned* columns, T* values) {
+            for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                T value = f(i, _columns[k], _values[k]);
+                if (value != T()) {
+                    *columns++ = _columns[k];
+                    *values++ = value;
+                }
+            }
+        });
+    }
+
+    // Разреженное представление other: разреженная матрица используется как есть,
+    // остальные сжимаются в storage
+    static const MatrixSparseCSR<T>& sparseOf(const Matrix<T>& other, MatrixSparseCSR<T>& storage) {
+        if (other.kind() == MatrixKind::Sparse) {
+            return static_cast<const MatrixSparseCSR<T>&>(other);
+        }
+        storage = MatrixSparseCSR<T>(other);
+        return storage;
+    }
+
+    void checkSize(const Matrix<T>& other, const char* message) const {
+        if (other.rows() != _m || other.cols() != _n) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    // Плотный out = alpha * (this + sign * other) + beta * out: строки out сначала получают
+    // вклад other, затем к ним добавляются элементы this
+    void sumInto(const Matrix<T>& other, MatrixDense<T>& out, T sign, T alpha, T beta) const {
+        checkSize(other, "Размеры матриц должны совпадать для поэлементной операции.");
+        this->checkInto(other, out, _m, _n, false);
+        size_t stride = 0;
+        const T* b = &other == &out ? nullptr : MatrixView<T>::rowStorage(other, stride);
+        T* c = out.rawData();
+        T factor = alpha * sign;
+        forRows(_n, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                T* row = c + static_cast<size_t>(i) * _n;
+                for (unsigned j = 0; j < _n; ++j) {
+                    T value = factor * (b ? b[i * stride + j] : other(i, j));
+                    row[j] = beta == T() ? value : value + beta * row[j];
+                }
+                for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                    row[_columns[k]] += alpha * _values[k];
+                }
+            }
+        });
+    }
+
+    // Новая плотная матрица this + sign * other
+    MatrixDense<T>* denseSum(const Matrix<T>& other, T sign) const {
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        sumInto(other, *result, sign, T(1), T());
+        return result;
+    }
+
+public:
+    // Нулевая матрица m x n
+    MatrixSparseCSR(unsigned m, unsigned n) : _m(m), _n(n), _rowStart(static_cast<size_t>(m) + 1, 0) {}
+
+    // Построение по тройкам в любом порядке: элементы распределяются по строкам подсчётом,
+    // строки упорядочиваются по столбцам параллельно, повторы одного элемента суммируются
+    MatrixSparseCSR(unsigned m, unsigned n, const std::vector<MatrixTriplet<T>>& triplets) : MatrixSparseCSR(m, n) {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::fromTriplets", T, (m, n, triplets.size(), 0), 0, sizeof(T) * 2.0 * triplets.size());
+        std::vector<size_t> start(static_cast<size_t>(m) + 1, 0);
+        for (const MatrixTriplet<T>& t : triplets) {
+            if (t.row >= m || t.col >= n) {
+                throw std::out_of_range("Индекс элемента вне размеров матрицы.");
+            }
+            ++start[t.row + 1];
+        }
+        for (unsigned i = 0; i < m; ++i) {
+            start[i + 1] += start[i];
+        }
+        std::vector<size_t> order(triplets.size());
+        std::vector<size_t> next(start.begin(), start.end() - 1);
+        for (size_t k = 0; k < triplets.size(); ++k) {
+            order[next[triplets[k].row]++] = k;
+        }
+
+        // Повторы суммируются в порядке следования, нулевые суммы не хранятся
+        auto merge = [&](unsigned i, auto emit) {
+            size_t k = start[i], end = start[i + 1];
+            while (k < end) {
+                unsigned col = triplets[order[k]].col;
+                T sum = T();
+                for (; k < end && triplets[order[k]].col == col; ++k) {
+                    sum += triplets[order[k]].value;
+                }
+                if (sum != T()) {
+                    emit(col, sum);
+                }
+            }
+        };
+        *this = assemble(m, n, start.data(), 1, [&](unsigned i) {
+            std::sort(order.begin() + start[i], order.begin() + start[i + 1], [&](size_t a, size_t b) {
+                return triplets[a].col != triplets[b].col ? triplets[a].col < triplets[b].col : a < b;
+            });
+            size_t count = 0;
+            merge(i, [&](unsigned, T) { ++count; });
+            return count;
+        }, [&](unsigned i, unsigned* columns, T* values) {
+            merge(i, [&](unsigned col, T value) {
+                *columns++ = col;
+                *values++ = value;
+            });
+        });
+    }
+
+    // Сжатие матрицы любого вида: сохраняются только ненулевые элементы
+    explicit MatrixSparseCSR(const Matrix<T>& matrix) : MatrixSparseCSR(matrix.rows(), matrix.cols()) {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::compress", T, (matrix.rows(), matrix.cols()), 0, sizeof(T) * matrix.rows() * matrix.cols());
+        if (matrix.kind() == MatrixKind::Sparse) {
+            *this = static_cast<const MatrixSparseCSR<T>&>(matrix);
+            return;
+        }
+        if (matrix.kind() == MatrixKind::Diagonal) {
+            const T* d = static_cast<const MatrixDiagonal<T>&>(matrix).rawData();
+            *this = assemble(_m, _n, nullptr, 1, [&](unsigned i) { return static_cast<size_t>(d[i] != T()); },
+                             [&](unsigned i, unsigned* columns, T* values) {
+                                 if (d[i] != T()) {
+                                     *columns = i;
+                                     *values = d[i];
+                                 }
+                             });
+            return;
+        }
+
+        size_t stride = 0;
+        const T* a = MatrixView<T>::rowStorage(matrix, stride);
+        auto value = [&](unsigned i, unsigned j) { return a ? a[i * stride + j] : matrix(i, j); };
+        *this = assemble(_m, _n, nullptr, _n, [&](unsigned i) {
+            size_t count = 0;
+            for (unsigned j = 0; j < _n; ++j) {
+                count += value(i, j) != T();
+            }
+            return count;
+        }, [&](unsigned i, unsigned* columns, T* values) {
+            for (unsigned j = 0; j < _n; ++j) {
+                T v = value(i, j);
+                if (v != T()) {
+                    *columns++ = j;
+                    *values++ = v;
+                }
+            }
+        });
+    }
+
+    MatrixSparseCSR(const MatrixSparseCSR<T>& other) = default;
+    MatrixSparseCSR(MatrixSparseCSR<T>&& other) noexcept = default;
+    MatrixSparseCSR<T>& operator=(const MatrixSparseCSR<T>& other) = default;
+    MatrixSparseCSR<T>& operator=(MatrixSparseCSR<T>&& other) noexcept = default;
+
+    unsigned rows() const override { return _m; }
+    unsigned cols() const override { return _n; }
+
+    MatrixKind kind() const override { return MatrixKind::Sparse; }
+
+    // Непосредственный доступ к хранилищу: rows() + 1 начал строк, номера столбцов
+    // и значения nonZeros() элементов. Значения можно менять на месте, структуру - нет
+    size_t nonZeros() const { return _values.size(); }
+    const size_t* rowStart() const { return _rowStart.data(); }
+    const unsigned* columnIndex() const { return _columns.data(); }
+    T* values() { return _values.data(); }
+    const T* values() const { return _values.data(); }
+
+    // Доступ к элементам: двоичный поиск в строке
+    T operator()(unsigned i, unsigned j) const override {
+        const unsigned* first = _columns.data() + _rowStart[i];
+        const unsigned* last = _columns.data() + _rowStart[i + 1];
+        const unsigned* found = std::lower_bound(first, last, j);
+        return found != last && *found == j ? _values[found - _columns.data()] : T();
+    }
+
+    // alpha * this + beta * other со структурой объединения; взаимно уничтожившиеся элементы не хранятся
+    MatrixSparseCSR<T> add(const MatrixSparseCSR<T>& other, T alpha = T(1), T beta = T(1)) const {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::add", T, (_m, _n, other._m, other._n), 1.0 * (nonZeros() + other.nonZeros()),
+                           sizeof(T) * 3.0 * (nonZeros() + other.nonZeros()));
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        // Слияние двух упорядоченных строк; emit получает только ненулевые суммы
+        auto merge = [&](unsigned i, auto emit) {
+            size_t a = _rowStart[i], aEnd = _rowStart[i + 1];
+            size_t b = other._rowStart[i], bEnd = other._rowStart[i + 1];
+            while (a < aEnd || b < bEnd) {
+                unsigned col;
+                T value;
+                if (b == bEnd || (a < aEnd && _columns[a] < other._columns[b])) {
+                    col = _columns[a];
+                    value = alpha * _values[a++];
+                } else if (a == aEnd || other._columns[b] < _columns[a]) {
+                    col = other._columns[b];
+                    value = beta * other._values[b++];
+                } else {
+                    col = _columns[a];
+                    value = alpha * _values[a++] + beta * other._values[b++];
+                }
+                if (value != T()) {
+                    emit(col, value);
+                }
+            }
+        };
+        return assemble(_m, _n, _rowStart.data(), 1 + (other.nonZeros() + _m) / (static_cast<size_t>(_m) + 1), [&](unsigned i) {
+            size_t count = 0;
+            merge(i, [&](unsigned, T) { ++count; });
+            return count;
+        }, [&](unsigned i, unsigned* columns, T* values) {
+            merge(i, [&](unsigned col, T value) {
+                *columns++ = col;
+                *values++ = value;
+            });
+        });
+    }
+
+    // diag(d) * this и this * diag(d): масштабирование строк и столбцов
+    MatrixSparseCSR<T> scaleRows(const T* d) const {
+        return mapped([d](unsigned i, unsigned, T v) { return d[i] * v; });
+    }
+
+    MatrixSparseCSR<T> scaleColumns(const T* d) const {
+        return mapped([d](unsigned, unsigned j, T v) { return v * d[j]; });
+    }
+
+    // C = alpha * this * B + beta * C для построчно хранимых B (cols() x p, шаг ldb)
+    // и C (rows() x p, шаг ldc): строка C накапливает строки B, выбранные элементами строки this
+    void multiplyRows(const T* B, size_t ldb, unsigned p, T alpha, T beta, T* C, size_t ldc) const {
+        forRows(p, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                T* c = C + i * ldc;
+                if (beta == T()) {
+                    std::fill(c, c + p, T());
+                } else if (beta != T(1)) {
+                    MatrixSimd::scale(c, beta, c, p);
+                }
+                for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                    const T* b = B + _columns[k] * ldb;
+                    T a = alpha * _values[k];
+                    for (unsigned j = 0; j < p; ++j) {
+                        c[j] += a * b[j];
+                    }
+                }
+            }
+        });
+    }
+
+    // C = alpha * A * this + beta * C для построчно хранимых A (m x rows(), шаг lda)
+    // и C (m x cols(), шаг ldc): к строке C добавляются строки this с весами из строки A
+    void multiplyLeft(const T* A, size_t lda, unsigned m, T alpha, T beta, T* C, size_t ldc) const {
+        ThreadPool::instance().parallelFor(0, m, ThreadPool::rowGrain(nonZeros() + _m), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                const T* a = A + i * lda;
+                T* c = C + i * ldc;
+                if (beta == T()) {
+                    std::fill(c, c + _n, T());
+                } else if (beta != T(1)) {
+                    MatrixSimd::scale(c, beta, c, _n);
+                }
+                for (unsigned r = 0; r < _m; ++r) {
+                    T weight = alpha * a[r];
+                    if (weight == T()) {
+                        continue;
+                    }
+                    for (size_t k = _rowStart[r]; k < _rowStart[r + 1]; ++k) {
+                        c[_columns[k]] += weight * _values[k];
+                    }
+                }
+            }
+        });
+    }
+
+    // Умножение на вектор из Matrix<T> не скрывается перегрузкой ниже
+    using Matrix<T>::multiply;
+
+    // Разреженное произведение this * other в два прохода (алгоритм Густавсона): строка
+    // результата собирается в плотном накопителе, первый проход считает её ненулевые суммы,
+    // второй записывает их. Взаимно сократившиеся суммы не хранятся, как в add и mapped.
+    // Метки, накопитель и список столбцов - буферы потока, переиспользуемые между вызовами
+    MatrixSparseCSR<T> multiply(const MatrixSparseCSR<T>& other) const {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::multiply", T, (_m, _n, other._m, other._n), 4.0 * nonZeros() * (other.nonZeros() / std::max(other._m, 1u)),
+                           sizeof(T) * 2.0 * (nonZeros() + other.nonZeros()));
+        if (_n != other._m) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        unsigned p = other._n;
+        struct Scratch {
+            std::vector<size_t> mark;   // номер строки, последней отметившей столбец
+            std::vector<T> sums;
+            std::vector<unsigned> columns;
+            size_t current = 0;         // номера не повторяются между вызовами
+        };
+        // Суммы строки i в накопителе, её различные столбцы - в scratch.columns.
+        // Оба прохода складывают в одном порядке, поэтому нули в них совпадают
+        auto rowSums = [&](unsigned i) -> Scratch& {
+            thread_local Scratch scratch;
+            if (scratch.mark.size() < p) {
+                scratch.mark.resize(p, 0);
+                scratch.sums.resize(p);
+            }
+            scratch.columns.clear();
+            size_t row = ++scratch.current;
+            for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                unsigned r = _columns[k];
+                T a = _values[k];
+                for (size_t q = other._rowStart[r]; q < other._rowStart[r + 1]; ++q) {
+                    unsigned col = other._columns[q];
+                    if (scratch.mark[col] != row) {
+                        scratch.mark[col] = row;
+                        scratch.sums[col] = T();
+                        scratch.columns.push_back(col);
+                    }
+                    scratch.sums[col] += a * other._values[q];
+                }
+            }
+            return scratch;
+        };
+        size_t rowCost = 1 + other.nonZeros() / (static_cast<size_t>(other._m) + 1);
+
+        return assemble(_m, p, _rowStart.data(), rowCost, [&](unsigned i) {
+            Scratch& scratch = rowSums(i);
+            size_t count = 0;
+            for (unsigned col : scratch.columns) {
+                count += scratch.sums[col] != T();
+            }
+            return count;
+        }, [&](unsigned i, unsigned* columns, T* values) {
+            Scratch& scratch = rowSums(i);
+            std::sort(scratch.columns.begin(), scratch.columns.end());
+            size_t count = 0;
+            for (unsigned col : scratch.columns) {
+                if (scratch.sums[col] != T()) {
+                    columns[count] = col;
+                    values[count++] = scratch.sums[col];
+                }
+            }
+        });
+    }
+
+    // Транспонирование CSR -> CSC: каждый отрезок строк считает свои элементы по столбцам,
+    // по этим счётчикам отрезки получают непересекающиеся места в строках результата
+    MatrixSparseCSR<T> transposed() const {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::transpose", T, (_m, _n), 0, 2.0 * sizeof(T) * nonZeros());
+        MatrixSparseCSR<T> result(_n, _m);
+        ThreadPool& pool = ThreadPool::instance();
+        size_t pieces = std::max<size_t>(1, std::min<size_t>({static_cast<size_t>(pool.size()), static_cast<size_t>(_m), nonZeros() / 32768}));
+        size_t total = nonZeros() + _m;
+        std::vector<unsigned> bounds(pieces + 1);
+        for (size_t piece = 0; piece <= pieces; ++piece) {
+            bounds[piece] = rowAt(_rowStart.data(), _m, 1, piece, pieces, total);
+        }
+
+        std::vector<size_t> offsets(pieces * _n, 0);
+        pool.parallelFor(0, pieces, 1, [&](size_t from, size_t to) {
+            for (size_t piece = from; piece < to; ++piece) {
+                size_t* count = offsets.data() + piece * _n;
+                for (size_t k = _rowStart[bounds[piece]]; k < _rowStart[bounds[piece + 1]]; ++k) {
+                    ++count[_columns[k]];
+                }
+            }
+        });
+        size_t position = 0;
+        for (unsigned j = 0; j < _n; ++j) {
+            result._rowStart[j] = position;
+            for (size_t piece = 0; piece < pieces; ++piece) {
+                size_t count = offsets[piece * _n + j];
+                offsets[piece * _n + j] = position;
+                position += count;
+            }
+        }
+        result._rowStart[_n] = position;
+
+        result._columns.resize(nonZeros());
+        result._values.resize(nonZeros());
+        pool.parallelFor(0, pieces, 1, [&](size_t from, size_t to) {
+            for (size_t piece = from; piece < to; ++piece) {
+                size_t* next = offsets.data() + piece * _n;
+                for (unsigned i = bounds[piece]; i < bounds[piece + 1]; ++i) {
+                    for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                        size_t target = next[_columns[k]]++;
+                        result._columns[target] = i;
+                        result._values[target] = _values[k];
+                    }
+                }
+            }
+        });
+        return result;
+    }
+
+    // Операции с матрицами: изменение на месте заменяет структуру результатом сложения
+    Matrix<T>& operator+=(const Matrix<T>& other) override {
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        MatrixSparseCSR<T> storage(0, 0);
+        *this = add(sparseOf(other, storage));
+        return *this;
+    }
+
+    Matrix<T>& operator-=(const Matrix<T>& other) override {
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        MatrixSparseCSR<T> storage(0, 0);
+        *this = add(sparseOf(other, storage), T(1), T(-1));
+        return *this;
+    }
+
+    // Оператор сложения
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        if (other.kind() == MatrixKind::Sparse || other.kind() == MatrixKind::Diagonal) {
+            MatrixSparseCSR<T> storage(0, 0);
+            return new MatrixSparseCSR<T>(add(sparseOf(other, storage)));
+        }
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::operator+", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 2.0 * sizeof(T) * rows() * cols());
+        return denseSum(other, T(1));
+    }
+
+    // Оператор вычитания
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        if (other.kind() == MatrixKind::Sparse || other.kind() == MatrixKind::Diagonal) {
+            MatrixSparseCSR<T> storage(0, 0);
+            return new MatrixSparseCSR<T>(add(sparseOf(other, storage), T(1), T(-1)));
+        }
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::operator-", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 2.0 * sizeof(T) * rows() * cols());
+        return denseSum(other, T(-1));
+    }
+
+    // Матричное умножение
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (other.kind() == MatrixKind::Sparse) {
+            return new MatrixSparseCSR<T>(multiply(static_cast<const MatrixSparseCSR<T>&>(other)));
+        }
+        if (other.kind() == MatrixKind::Diagonal) {
+            return new MatrixSparseCSR<T>(scaleColumns(static_cast<const MatrixDiagonal<T>&>(other).rawData()));
+        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+        multiplyInto(other, *result);
+        return result;
+    }
+
+    // Почленное умножение: структура результата - подмножество структуры this
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::elemMult", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * nonZeros(), 3.0 * sizeof(T) * nonZeros());
+        checkSize(other, "Размеры матриц должны совпадать для почленного умножения.");
+        return new MatrixSparseCSR<T>(mapped([&other](unsigned i, unsigned j, T v) { return v * other(i, j); }));
+    }
+
+    // Почленное деление: нули other вне структуры this тоже считаются делением на ноль
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::elemDiv", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * nonZeros(), 3.0 * sizeof(T) * nonZeros());
+        checkSize(other, "Размеры матриц должны совпадать для почленного деления.");
+        if (hasZeroElement(other)) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+        }
+        return new MatrixSparseCSR<T>(mapped([&other](unsigned i, unsigned j, T v) { return v / other(i, j); }));
+    }
+
+    // Транспонирование
+    MatrixSparseCSR<T>* transpose() const override {
+        return new MatrixSparseCSR<T>(transposed());
+    }
+
+    // Операции с результатом в готовой матрице (см. Matrix<T>::multiplyInto)
+
+    // Построчно хранимый other - накопление его строк, иначе доступ к элементам other
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::multiplyInto", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * nonZeros() * other.cols(),
+                           sizeof(T) * (1.0 * nonZeros() + 1.0 * other.rows() * other.cols() + 2.0 * rows() * other.cols()));
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, _m, other.cols(), true);
+        unsigned p = other.cols();
+        size_t stride = 0;
+        if (const T* b = MatrixView<T>::rowStorage(other, stride)) {
+            multiplyRows(b, stride, p, alpha, beta, out.rawData(), p);
+            return;
+        }
+        T* c = out.rawData();
+        forRows(p, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                T* row = c + static_cast<size_t>(i) * p;
+                for (unsigned j = 0; j < p; ++j) {
+                    row[j] = beta == T() ? T() : beta * row[j];
+                }
+                for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                    T a = alpha * _values[k];
+                    for (unsigned j = 0; j < p; ++j) {
+                        row[j] += a * other(_columns[k], j);
+                    }
+                }
+            }
+        });
+    }
+
+    void addInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        sumInto(other, out, T(1), alpha, beta);
+    }
+
+    void subtractInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        sumInto(other, out, T(-1), alpha, beta);
+    }
+
+    // Вне структуры this результат нулевой: out там только масштабируется на beta
+    void elemMultInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        checkSize(other, "Размеры матриц должны совпадать для поэлементной операции.");
+        this->checkInto(other, out, _m, _n, false);
+        T* c = out.rawData();
+        forRows(_n, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                T* row = c + static_cast<size_t>(i) * _n;
+                // Значения читаются до того, как out (возможно, это other) будет изменён
+                size_t k = _rowStart[i];
+                for (unsigned j = 0; j < _n; ++j) {
+                    T value = k < _rowStart[i + 1] && _columns[k] == j ? alpha * _values[k++] * other(i, j) : T();
+                    row[j] = beta == T() ? value : value + beta * row[j];
+                }
+            }
+        });
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        this->checkInto(*this, out, _n, _m, true);
+        T* c = out.rawData();
+        ThreadPool::instance().parallelFor(0, out.rows(), ThreadPool::rowGrain(_m), [&](size_t from, size_t to) {
+            for (size_t j = from; j < to; ++j) {
+                T* row = c + j * _m;
+                if (beta == T()) {
+                    std::fill(row, row + _m, T());
+                } else {
+                    MatrixSimd::scale(row, beta, row, _m);
+                }
+            }
+        });
+        // Каждый элемент out получает не больше одного элемента this
+        forRows(1, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                    c[static_cast<size_t>(_columns[k]) * _m + i] += alpha * _values[k];
+                }
+            }
+        });
+    }
+
+    // y = alpha * A * x + beta * y: строки распределяются по потокам по числу элементов
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::gemv", T, (rows(), cols(), x.size(), 1), 2.0 * nonZeros(),
+                           sizeof(T) * (2.0 * nonZeros() + x.size() + 2.0 * y.size()));
+        this->checkGemv(x, y);
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        forRows(1, [&](unsigned from, unsigned to) {
+            for (unsigned i = from; i < to; ++i) {
+                T sum = T();
+                for (size_t k = _rowStart[i]; k < _rowStart[i + 1]; ++k) {
+                    sum += _values[k] * xs[_columns[k]];
+                }
+                ys[i] = beta == T() ? alpha * sum : alpha * sum + beta * ys[i];
+            }
+        });
+    }
+
+    // Y = alpha * A * X + beta * Y: все векторы X обрабатываются за один проход по элементам A
+    void gemvBatch(T alpha, const MatrixDense<T>& X, T beta, MatrixDense<T>& Y) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::gemvBatch", T, (rows(), cols(), X.rows(), X.cols()), 2.0 * nonZeros() * X.cols(),
+                           sizeof(T) * (1.0 * nonZeros() + 1.0 * X.rows() * X.cols() + 2.0 * Y.rows() * Y.cols()));
+        this->checkGemvBatch(X, Y);
+        multiplyRows(X.rawData(), X.cols(), X.cols(), alpha, beta, Y.rawData(), Y.cols());
+    }
+
+    // Импорт из файла: начала строк, номера столбцов и значения
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::importFromFile", T, (0, 0), 0, 0);
+        MatrixTextReader reader(filename);
+
+        if (reader.line() != "MatrixSparseCSR") {
+            throw std::runtime_error("Файл не содержит данные MatrixSparseCSR.");
+        }
+
+        unsigned m = reader.value<unsigned>();
+        unsigned n = reader.value<unsigned>();
+        size_t count = reader.value<size_t>();
+
+        MatrixSparseCSR<T> loaded(m, n);
+        loaded._columns.resize(count);
+        loaded._values.resize(count);
+        reader.values(loaded._rowStart.data(), static_cast<size_t>(m) + 1);
+        reader.values(loaded._columns.data(), count);
+        reader.values(loaded._values.data(), count);
+
+        // Структура проверяется, чтобы доступ к элементам не вышел за хранилище
+        bool valid = loaded._rowStart[0] == 0 && loaded._rowStart[m] == count;
+        for (unsigned i = 0; valid && i < m; ++i) {
+            valid = loaded._rowStart[i] <= loaded._rowStart[i + 1] && loaded._rowStart[i + 1] <= count;
+            for (size_t k = loaded._rowStart[i]; valid && k < loaded._rowStart[i + 1]; ++k) {
+                valid = loaded._columns[k] < n && (k == loaded._rowStart[i] || loaded._columns[k - 1] < loaded._columns[k]);
+            }
+        }
+        if (!valid) {
+            throw std::runtime_error("Повреждённый текстовый файл MatrixSparseCSR.");
+        }
+        *this = std::move(loaded);
+        MATRIX_TRACE_UPDATE((rows(), cols()), 0, sizeof(T) * nonZeros());
+    }
+
+    // Экспорт в файл: размеры и число элементов, затем начала строк, столбцы и значения - по строке
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixSparseCSR::exportToFile", T, (rows(), cols()), 0, sizeof(T) * nonZeros());
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixSparseCSR\n" + std::to_string(_m) + " " + std::to_string(_n) + " " + std::to_string(nonZeros()) + "\n");
+        writer.values(_rowStart.data(), _rowStart.size());
+        writer.text("\n");
+        writer.values(_columns.data(), _columns.size());
+        writer.text("\n");
+        writer.values(_values.data(), _values.size());
+        writer.text("\n");
+
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        for (unsigned i = 0; i < _m; ++i) {
+            size_t k = _rowStart[i];
+            for (unsigned j = 0; j < _n; ++j) {
+                if (k < _rowStart[i + 1] && _columns[k] == j) {
+                    os << _values[k++] << "\t";
+                } else {
+                    os << T() << "\t";
+                }
+            }
+            os << "\n";
+        }
+    }
+};
+
+#endif
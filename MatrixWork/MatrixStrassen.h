@@ -0,0 +1,281 @@
+#ifndef MATRIXSTRASSEN_H
+#define MATRIXSTRASSEN_H
+
+#include "MatrixGemm.h"
+#include "MatrixSimd.h"
+#include "MatrixAllocator.h"
+#include "ThreadPool.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <atomic>
+
+// Умножение квадратных матриц по схеме Штрассена-Винограда (7 умножений и
+// 15 сложений на уровень). Рекурсия продолжается до размера crossover(),
+// дальше работает блочное ядро MatrixGemm. Размер дополняется нулями до
+// c * 2^L (c <= crossover), поэтому деление пополам всегда точное.
+// Для float и double погрешность немного выше, чем у классического умножения.
+template <typename T = double>
+class MatrixStrassen {
+private:
+    static std::atomic<unsigned>& thresholdValue() {
+        static std::atomic<unsigned> value(4096);
+        return value;
+    }
+
+    static std::atomic<unsigned>& crossoverValue() {
+        static std::atomic<unsigned> value(512);
+        return value;
+    }
+
+    // Буфер рабочей памяти, выделяемый один раз на всё умножение
+    struct Buffer {
+        T* data;
+        size_t count;
+        explicit Buffer(size_t size) : data(MatrixStorage<T>::allocate(size, false)), count(size) {}
+        ~Buffer() { MatrixStorage<T>::deallocate(data, count); }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+    };
+
+    // Z = op(X, Y) для квадрантов h x h с шагами строк ldx, ldy, ldz
+    template <typename Op>
+    static void combine(unsigned h, const T* X, size_t ldx, const T* Y, size_t ldy, T* Z, size_t ldz, Op op) {
+        ThreadPool::instance().parallelFor(0, h, ThreadPool::rowGrain(h), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                MatrixSimd::apply(op, X + i * ldx, Y + i * ldy, Z + i * ldz, h);
+            }
+        });
+    }
+
+    static void add(unsigned h, const T* X, size_t ldx, const T* Y, size_t ldy, T* Z, size_t ldz) {
+        combine(h, X, ldx, Y, ldy, Z, ldz, MatrixSimdAdd());
+    }
+
+    static void sub(unsigned h, const T* X, size_t ldx, const T* Y, size_t ldy, T* Z, size_t ldz) {
+        combine(h, X, ldx, Y, ldy, Z, ldz, MatrixSimdSub());
+    }
+
+    static bool isLeaf(unsigned n, unsigned cross) {
+        return n <= cross || n % 2 != 0;
+    }
+
+    // Объём рабочей памяти последовательной рекурсии для размера n
+    static size_t workspace(unsigned n, unsigned cross) {
+        size_t size = 0;
+        for (; !isLeaf(n, cross); n /= 2) {
+            size += 2 * static_cast<size_t>(n / 2) * (n / 2);
+        }
+        return size;
+    }
+
+    static void leaf(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc) {
+        MatrixGemm<T>::multiply(n, n, n, T(1), A, static_cast<unsigned>(lda), B, static_cast<unsigned>(ldb),
+                                T(), C, static_cast<unsigned>(ldc));
+    }
+
+    // Последовательная рекурсия с двумя временными квадрантами на уровень
+    // (X - под операнды из A, Y - из B); остальные промежуточные
+    // произведения хранятся в квадрантах C. Порядок шагов - по схеме
+    // Boyer-Dumas-Pernet-Zhou для C = A * B.
+    static void recurse(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, T* work, unsigned cross) {
+        if (isLeaf(n, cross)) {
+            leaf(n, A, lda, B, ldb, C, ldc);
+            return;
+        }
+
+        unsigned h = n / 2;
+        const T* A11 = A;
+        const T* A12 = A + h;
+        const T* A21 = A + h * lda;
+        const T* A22 = A21 + h;
+        const T* B11 = B;
+        const T* B12 = B + h;
+        const T* B21 = B + h * ldb;
+        const T* B22 = B21 + h;
+        T* C11 = C;
+        T* C12 = C + h;
+        T* C21 = C + h * ldc;
+        T* C22 = C21 + h;
+        T* X = work;
+        T* Y = work + static_cast<size_t>(h) * h;
+        T* next = Y + static_cast<size_t>(h) * h;
+
+        sub(h, A11, lda, A21, lda, X, h);           // S3 = A11 - A21
+        sub(h, B22, ldb, B12, ldb, Y, h);           // T3 = B22 - B12
+        recurse(h, X, h, Y, h, C21, ldc, next, cross);     // P7 = S3 * T3
+        add(h, A21, lda, A22, lda, X, h);           // S1 = A21 + A22
+        sub(h, B12, ldb, B11, ldb, Y, h);           // T1 = B12 - B11
+        recurse(h, X, h, Y, h, C22, ldc, next, cross);     // P5 = S1 * T1
+        sub(h, X, h, A11, lda, X, h);               // S2 = S1 - A11
+        sub(h, B22, ldb, Y, h, Y, h);               // T2 = B22 - T1
+        recurse(h, X, h, Y, h, C12, ldc, next, cross);     // P6 = S2 * T2
+        sub(h, A12, lda, X, h, X, h);               // S4 = A12 - S2
+        sub(h, Y, h, B21, ldb, Y, h);               // T4 = T2 - B21
+        recurse(h, X, h, B22, ldb, C11, ldc, next, cross); // P3 = S4 * B22
+        recurse(h, A11, lda, B11, ldb, X, h, next, cross); // P1 = A11 * B11
+        add(h, X, h, C12, ldc, C12, ldc);           // U2 = P1 + P6
+        add(h, C12, ldc, C21, ldc, C21, ldc);       // U3 = U2 + P7
+        add(h, C12, ldc, C22, ldc, C12, ldc);       // U4 = U2 + P5
+        add(h, C21, ldc, C22, ldc, C22, ldc);       // U7 = U3 + P5 = C22
+        add(h, C12, ldc, C11, ldc, C12, ldc);       // U5 = U4 + P3 = C12
+        recurse(h, A22, lda, Y, h, C11, ldc, next, cross); // P4 = A22 * T4
+        sub(h, C21, ldc, C11, ldc, C21, ldc);       // U6 = U3 - P4 = C21
+        recurse(h, A12, lda, B21, ldb, C11, ldc, next, cross); // P2 = A12 * B21
+        add(h, X, h, C11, ldc, C11, ldc);           // U1 = P1 + P2 = C11
+    }
+
+    // Число уровней рекурсии, на которых семь произведений порождаются задачами:
+    // 7^levels задач не меньше числа потоков, иначе часть потоков простаивала бы,
+    // пока листовые ядра внутри задач работают последовательно
+    static unsigned taskLevels(unsigned n, unsigned cross) {
+        unsigned threads = ThreadPool::instance().size(), levels = 0;
+        for (size_t tasks = 1; tasks < threads && !isLeaf(n, cross); tasks *= 7, n /= 2) {
+            ++levels;
+        }
+        return levels;
+    }
+
+    // Произведение внутри задачи: следующий уровень задач или последовательная
+    // рекурсия со своей рабочей памятью
+    static void product(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, unsigned cross, unsigned levels) {
+        if (isLeaf(n, cross)) {
+            leaf(n, A, lda, B, ldb, C, ldc);
+        } else if (levels > 0) {
+            parallelLevel(n, A, lda, B, ldb, C, ldc, cross, levels);
+        } else {
+            Buffer work(workspace(n, cross));
+            recurse(n, A, lda, B, ldb, C, ldc, work.data, cross);
+        }
+    }
+
+    // Уровень рекурсии с параллельным вычислением семи произведений через планировщик
+    // задач; каждое произведение рекурсивно порождает ещё levels - 1 уровней задач
+    static void parallelLevel(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, unsigned cross, unsigned levels) {
+        unsigned h = n / 2;
+        size_t quadrant = static_cast<size_t>(h) * h;
+        Buffer buffer(11 * quadrant);
+
+        const T* A11 = A;
+        const T* A12 = A + h;
+        const T* A21 = A + h * lda;
+        const T* A22 = A21 + h;
+        const T* B11 = B;
+        const T* B12 = B + h;
+        const T* B21 = B + h * ldb;
+        const T* B22 = B21 + h;
+        T* C11 = C;
+        T* C12 = C + h;
+        T* C21 = C + h * ldc;
+        T* C22 = C21 + h;
+
+        T* S1 = buffer.data;
+        T* S2 = S1 + quadrant;
+        T* S3 = S2 + quadrant;
+        T* S4 = S3 + quadrant;
+        T* T1 = S4 + quadrant;
+        T* T2 = T1 + quadrant;
+        T* T3 = T2 + quadrant;
+        T* T4 = T3 + quadrant;
+        T* P1 = T4 + quadrant;
+        T* P2 = P1 + quadrant;
+        T* P4 = P2 + quadrant;
+
+        // Суммы S1..S4, T1..T4 и произведения - задачи с зависимостями: каждое
+        // произведение начинается, как только готовы его множители
+        TaskGroup group;
+        TaskHandle s1 = group.spawn([=] { add(h, A21, lda, A22, lda, S1, h); });
+        TaskHandle s2 = group.spawn([=] { sub(h, S1, h, A11, lda, S2, h); }, {s1});
+        TaskHandle s3 = group.spawn([=] { sub(h, A11, lda, A21, lda, S3, h); });
+        TaskHandle s4 = group.spawn([=] { sub(h, A12, lda, S2, h, S4, h); }, {s2});
+        TaskHandle t1 = group.spawn([=] { sub(h, B12, ldb, B11, ldb, T1, h); });
+        TaskHandle t2 = group.spawn([=] { sub(h, B22, ldb, T1, h, T2, h); }, {t1});
+        TaskHandle t3 = group.spawn([=] { sub(h, B22, ldb, B12, ldb, T3, h); });
+        TaskHandle t4 = group.spawn([=] { sub(h, T2, h, B21, ldb, T4, h); }, {t2});
+
+        // P3, P5, P6, P7 пишутся сразу в квадранты C
+        group.spawn([=] { product(h, A11, lda, B11, ldb, P1, h, cross, levels - 1); });
+        group.spawn([=] { product(h, A12, lda, B21, ldb, P2, h, cross, levels - 1); });
+        group.spawn([=] { product(h, S4, h, B22, ldb, C11, ldc, cross, levels - 1); }, {s4});
+        group.spawn([=] { product(h, A22, lda, T4, h, P4, h, cross, levels - 1); }, {t4});
+        group.spawn([=] { product(h, S1, h, T1, h, C22, ldc, cross, levels - 1); }, {s1, t1});
+        group.spawn([=] { product(h, S2, h, T2, h, C12, ldc, cross, levels - 1); }, {s2, t2});
+        group.spawn([=] { product(h, S3, h, T3, h, C21, ldc, cross, levels - 1); }, {s3, t3});
+        group.sync();
+
+        // На верхнем уровне суммы выполняются пулом, во вложенных - внутри своей задачи
+        add(h, P1, h, C12, ldc, C12, ldc);          // U2 = P1 + P6
+        add(h, C12, ldc, C21, ldc, C21, ldc);       // U3 = U2 + P7
+        add(h, C12, ldc, C22, ldc, C12, ldc);       // U4 = U2 + P5
+        add(h, C21, ldc, C22, ldc, C22, ldc);       // U7 = U3 + P5 = C22
+        add(h, C12, ldc, C11, ldc, C12, ldc);       // U5 = U4 + P3 = C12
+        sub(h, C21, ldc, P4, h, C21, ldc);          // U6 = U3 - P4 = C21
+        add(h, P1, h, P2, h, C11, ldc);             // U1 = P1 + P2 = C11
+    }
+
+    static void run(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc, unsigned cross) {
+        if (isLeaf(n, cross)) {
+            leaf(n, A, lda, B, ldb, C, ldc);
+        } else if (ThreadPool::instance().size() > 1) {
+            parallelLevel(n, A, lda, B, ldb, C, ldc, cross, taskLevels(n, cross));
+        } else {
+            Buffer work(workspace(n, cross));
+            recurse(n, A, lda, B, ldb, C, ldc, work.data, cross);
+        }
+    }
+
+public:
+    // Минимальный размер, с которого MatrixDense::operator* использует эту схему
+    static unsigned threshold() { return thresholdValue().load(std::memory_order_relaxed); }
+    static void setThreshold(unsigned n) { thresholdValue().store(n, std::memory_order_relaxed); }
+
+    // Размер, на котором рекурсия передаёт работу классическому ядру
+    static unsigned crossover() { return crossoverValue().load(std::memory_order_relaxed); }
+    static void setCrossover(unsigned n) { crossoverValue().store(std::max(1u, n), std::memory_order_relaxed); }
+
+    // C = A * B для квадратных матриц n x n; C не должна пересекаться с A и B
+    static void multiply(unsigned n, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc) {
+        unsigned cross = crossover();
+
+        // Размер с дополнением: c * 2^L, где c <= cross
+        unsigned size = n, levels = 0;
+        while (size > cross) {
+            size = (size + 1) / 2;
+            ++levels;
+        }
+        unsigned padded = size << levels;
+
+        if (padded == n) {
+            run(n, A, lda, B, ldb, C, ldc, cross);
+            return;
+        }
+
+        // Копии операндов, дополненные нулями справа и снизу
+        size_t count = static_cast<size_t>(padded) * padded;
+        Buffer Ap(count), Bp(count), Cp(count);
+        ThreadPool::instance().parallelFor(0, padded, ThreadPool::rowGrain(padded), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                T* a = Ap.data + i * padded;
+                T* b = Bp.data + i * padded;
+                if (i < n) {
+                    std::copy(A + i * lda, A + i * lda + n, a);
+                    std::copy(B + i * ldb, B + i * ldb + n, b);
+                    std::fill(a + n, a + padded, T());
+                    std::fill(b + n, b + padded, T());
+                } else {
+                    std::fill(a, a + padded, T());
+                    std::fill(b, b + padded, T());
+                }
+            }
+        });
+
+        run(padded, Ap.data, padded, Bp.data, padded, Cp.data, padded, cross);
+
+        ThreadPool::instance().parallelFor(0, n, ThreadPool::rowGrain(n), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                std::copy(Cp.data + i * padded, Cp.data + i * padded + n, C + i * ldc);
+            }
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,346 @@
+#ifndef MATRIXTEXT_H
+#define MATRIXTEXT_H
+
+#include "ThreadPool.h"
+#include "MatrixBinary.h"
+#include <charconv>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+
+// Разбор и форматирование чисел текстового формата без iostream: std::from_chars и
+// std::to_chars не зависят от локали и не копируют данные. Вывод совпадает с
+// operator<< потока по умолчанию (%g с точностью 6). Однобайтовые и неарифметические
+// типы обрабатываются потоками, как раньше
+struct MatrixTextValue {
+    template <typename T>
+    static constexpr bool direct() {
+        return std::is_arithmetic<T>::value && sizeof(T) > 1;
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Разбор одного токена [begin, end) целиком
+    template <typename T>
+    static bool parse(const char* begin, const char* end, T& value) {
+        if constexpr (direct<T>()) {
+            // from_chars не принимает явный знак '+', который допускает operator>>
+            if (begin != end && *begin == '+' && end - begin > 1 && begin[1] != '-') {
+                ++begin;
+            }
+            std::from_chars_result result = std::from_chars(begin, end, value);
+            return result.ec == std::errc() && result.ptr == end;
+        } else {
+            std::istringstream stream(std::string(begin, end));
+            return static_cast<bool>(stream >> value);
+        }
+    }
+
+    // Значение и разделитель-пробел в конец buffer
+    template <typename T>
+    static void append(std::string& buffer, T value) {
+        if constexpr (direct<T>()) {
+            char text[64];
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point<T>::value) {
+                result = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, 6);
+            } else {
+                result = std::to_chars(text, text + sizeof(text), value);
+            }
+            *result.ptr++ = ' ';
+            buffer.append(text, result.ptr);
+        } else {
+            std::ostringstream stream;
+            stream << value << ' ';
+            buffer += stream.str();
+        }
+    }
+};
+
+// Чтение текстового файла матрицы: файл отображается в память (или читается
+// целиком, если отображение невозможно), числа разбираются параллельно по кускам,
+// границы кусков сдвигаются к ближайшему концу строки
+class MatrixTextReader {
+private:
+    std::unique_ptr<MappedFile> mapping;
+    std::vector<char> buffer;
+    const char* pos = nullptr;
+    const char* end = nullptr;
+
+    // Куски меньше этого размера разбираются одним потоком
+    static constexpr size_t minChunk = size_t(1) << 18;
+
+    void skipSpace() {
+        while (pos != end && MatrixTextValue::isSpace(*pos)) {
+            ++pos;
+        }
+    }
+
+    // Граница куска не раньше from: следующий конец строки, в длинной строке - пробел
+    const char* boundary(const char* from, size_t limit) const {
+        if (from >= end) {
+            return end;
+        }
+        const char* stop = std::min(end, from + limit);
+        const char* newline = std::find(from, stop, '\n');
+        if (newline != stop) {
+            return newline + 1;
+        }
+        while (from != end && !MatrixTextValue::isSpace(*from)) {
+            ++from;
+        }
+        return from;
+    }
+
+    static size_t countTokens(const char* begin, const char* stop) {
+        size_t count = 0;
+        bool inside = false;
+        for (const char* p = begin; p != stop; ++p) {
+            bool space = MatrixTextValue::isSpace(*p);
+            count += (!space && !inside);
+            inside = !space;
+        }
+        return count;
+    }
+
+    // Разбор не более limit токенов с текущей позиции в out (limit = SIZE_MAX - до конца файла);
+    // возвращает число разобранных токенов и переставляет позицию за последний из них
+    template <typename T>
+    size_t parseTokens(T* out, size_t limit, std::vector<T>* grow) {
+        skipSpace();
+        size_t bytes = static_cast<size_t>(end - pos);
+        ThreadPool& pool = ThreadPool::instance();
+        size_t pieces = std::max<size_t>(1, std::min<size_t>(static_cast<size_t>(pool.size()) * 4, bytes / minChunk));
+
+        // Куски по границам строк
+        std::vector<const char*> starts{pos};
+        size_t step = (bytes + pieces - 1) / std::max<size_t>(pieces, 1);
+        for (size_t k = 1; k < pieces; ++k) {
+            const char* next = boundary(std::max(starts.back(), pos + k * step), step);
+            if (next >= end) {
+                break;
+            }
+            starts.push_back(next);
+        }
+        starts.push_back(end);
+        size_t chunks = starts.size() - 1;
+
+        // Первый проход - число токенов в каждом куске, чтобы знать, куда писать значения
+        std::vector<size_t> first(chunks + 1, 0);
+        if (chunks > 1) {
+            pool.parallelFor(0, chunks, 1, [&](size_t from, size_t to) {
+                for (size_t c = from; c < to; ++c) {
+                    first[c + 1] = countTokens(starts[c], starts[c + 1]);
+                }
+            });
+            for (size_t c = 0; c < chunks; ++c) {
+                first[c + 1] += first[c];
+            }
+        } else {
+            first[1] = limit;
+        }
+
+        size_t total = chunks > 1 ? std::min(first[chunks], limit) : limit;
+        if (grow) {
+            if (chunks == 1) {
+                total = countTokens(starts[0], starts[1]);
+            }
+            grow->resize(total);
+            out = grow->data();
+        }
+
+        std::vector<const char*> stops(chunks, nullptr);
+        std::vector<size_t> parsed(chunks, 0);
+        auto parseChunk = [&](size_t c) {
+            const char* p = starts[c];
+            const char* stop = starts[c + 1];
+            size_t index = first[c];
+            while (index < total) {
+                while (p != stop && MatrixTextValue::isSpace(*p)) {
+                    ++p;
+                }
+                if (p == stop) {
+                    break;
+                }
+                const char* token = p;
+                while (p != stop && !MatrixTextValue::isSpace(*p)) {
+                    ++p;
+                }
+                if (!MatrixTextValue::parse(token, p, out[index])) {
+                    throw std::runtime_error("Не удалось разобрать число \"" + std::string(token, p) + "\" в текстовом файле матрицы.");
+                }
+                ++index;
+                stops[c] = p;
+            }
+            parsed[c] = index - first[c];
+        };
+        if (chunks > 1) {
+            pool.parallelFor(0, chunks, 1, [&](size_t from, size_t to) {
+                for (size_t c = from; c < to; ++c) {
+                    parseChunk(c);
+                }
+            });
+        } else {
+            parseChunk(0);
+        }
+
+        size_t count = 0;
+        for (size_t c = 0; c < chunks; ++c) {
+            count += parsed[c];
+            if (stops[c]) {
+                pos = stops[c];
+            }
+        }
+        return count;
+    }
+
+public:
+    explicit MatrixTextReader(const std::string& filename) {
+        try {
+            mapping.reset(new MappedFile(filename));
+            pos = mapping->data();
+            end = pos + mapping->size();
+            return;
+        } catch (const std::runtime_error&) {
+            // Пустой файл или отображение недоступно - обычное чтение
+        }
+        std::ifstream infile(filename, std::ios::binary);
+        if (!infile) {
+            throw std::runtime_error("Не удалось открыть файл для чтения.");
+        }
+        buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+        pos = buffer.data();
+        end = pos + buffer.size();
+    }
+
+    // Строка до конца строки (как std::getline); файл читается без преобразования
+    // переводов строк, поэтому '\r' от CRLF (файлы, записанные в Windows) отбрасывается
+    std::string line() {
+        const char* stop = std::find(pos, end, '\n');
+        std::string text(pos, stop);
+        pos = stop == end ? end : stop + 1;
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+        return text;
+    }
+
+    // Одно значение (например, размер из заголовка)
+    template <typename T>
+    T value() {
+        skipSpace();
+        const char* token = pos;
+        while (pos != end && !MatrixTextValue::isSpace(*pos)) {
+            ++pos;
+        }
+        T result{};
+        if (token == pos || !MatrixTextValue::parse(token, pos, result)) {
+            throw std::runtime_error("Повреждённый заголовок текстового файла матрицы.");
+        }
+        return result;
+    }
+
+    // Следующие count значений в out
+    template <typename T>
+    void values(T* out, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        if (parseTokens(out, count, static_cast<std::vector<T>*>(nullptr)) != count) {
+            throw std::runtime_error("В текстовом файле матрицы меньше чисел, чем требуется.");
+        }
+    }
+
+    // Все значения до конца файла
+    template <typename T>
+    std::vector<T> rest() {
+        std::vector<T> result;
+        parseTokens(static_cast<T*>(nullptr), static_cast<size_t>(-1), &result);
+        return result;
+    }
+};
+
+// Запись текстового файла матрицы: единицы вывода (строки, блоки) форматируются
+// параллельно в буферы кусков и записываются по порядку. Вывод идёт партиями,
+// чтобы буферы не превышали batchBytes. Файл открывается в текстовом режиме, как
+// и прежний вывод через ofstream: перевод строки - принятый на платформе (CRLF в Windows)
+class MatrixTextWriter {
+private:
+    std::ofstream outfile;
+
+    static constexpr size_t batchBytes = size_t(64) << 20;
+
+public:
+    explicit MatrixTextWriter(const std::string& filename) : outfile(filename) {
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+    }
+
+    void text(const std::string& value) {
+        outfile << value;
+    }
+
+    // Вывод units единиц; format(unit, buffer) дописывает текст единицы в buffer,
+    // unitBytes - оценка длины одной единицы для деления на партии
+    template <typename Format>
+    void units(size_t units, size_t unitBytes, Format format) {
+        ThreadPool& pool = ThreadPool::instance();
+        size_t perBatch = std::max<size_t>(1, batchBytes / std::max<size_t>(unitBytes, 1));
+        size_t pieces = static_cast<size_t>(pool.size()) * 4;
+
+        for (size_t batch = 0; batch < units; batch += perBatch) {
+            size_t count = std::min(perBatch, units - batch);
+            size_t chunks = std::max<size_t>(1, std::min(pieces, count * unitBytes / (size_t(1) << 16)));
+            chunks = std::min(chunks, count);
+            size_t chunkSize = (count + chunks - 1) / chunks;
+
+            std::vector<std::string> buffers(chunks);
+            pool.parallelFor(0, chunks, 1, [&](size_t from, size_t to) {
+                for (size_t c = from; c < to; ++c) {
+                    size_t first = batch + c * chunkSize;
+                    size_t last = std::min(batch + count, first + chunkSize);
+                    if (first >= last) {
+                        continue;
+                    }
+                    buffers[c].reserve((last - first) * unitBytes);
+                    for (size_t unit = first; unit < last; ++unit) {
+                        format(unit, buffers[c]);
+                    }
+                }
+            });
+            for (const std::string& buffer : buffers) {
+                outfile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            }
+        }
+    }
+
+    // Значения values[0..count) через пробел в конце каждого, по частям длиной piece
+    template <typename T>
+    void values(const T* values, size_t count, size_t piece = 4096) {
+        size_t pieces = (count + piece - 1) / piece;
+        units(pieces, piece * 14, [&](size_t unit, std::string& buffer) {
+            size_t from = unit * piece, to = std::min(count, from + piece);
+            for (size_t k = from; k < to; ++k) {
+                MatrixTextValue::append(buffer, values[k]);
+            }
+        });
+    }
+
+    void close() {
+        outfile.close();
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef MATRIXTRACE_H
+#define MATRIXTRACE_H
+
+// Трассировка выполнения операций матриц в формате Chrome trace (JSON), файл
+// открывается в Perfetto или chrome://tracing. Включается макросом MATRIX_ENABLE_TRACE
+// (опция CMake MATRIX_TRACE); без него MATRIX_TRACE_SCOPE раскрывается в пустоту
+// и аргументы не вычисляются.
+//
+// MATRIX_TRACE_SCOPE(name, T, (m, n[, p, q]), flops, bytes) в начале функции
+// записывает событие длительностью до выхода из области видимости: имя операции,
+// тип элементов, размеры операндов, оценку числа операций и объёма данных, поток.
+// MATRIX_TRACE_UPDATE((m, n[, p, q]), flops, bytes) уточняет их позже в той же функции.
+
+#ifdef MATRIX_ENABLE_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+struct MatrixTraceShape {
+    unsigned dims[4];
+
+    MatrixTraceShape(unsigned m, unsigned n, unsigned p = 0, unsigned q = 0) : dims{m, n, p, q} {}
+};
+
+struct MatrixTraceEvent {
+    const char* name;
+    const char* type;
+    unsigned dims[4];
+    double flops;
+    double bytes;
+    uint64_t begin;
+    uint64_t end;
+};
+
+// Буфер событий одного потока: пишет только поток-владелец, без блокировок.
+// События хранятся кусками; счётчик куска публикуется с release, поэтому dump()
+// из другого потока видит только полностью записанные события
+class MatrixTraceBuffer {
+private:
+    struct Chunk {
+        static constexpr size_t capacity = 4096;
+        MatrixTraceEvent events[capacity];
+        std::atomic<size_t> count{0};
+        std::atomic<Chunk*> next{nullptr};
+    };
+
+    // Не больше maxChunks кусков на поток, дальше события отбрасываются
+    static constexpr size_t maxChunks = 256;
+
+    Chunk* head;
+    Chunk* tail;
+    size_t chunks = 1;
+    std::atomic<size_t> _dropped{0};
+    unsigned _thread;
+
+public:
+    explicit MatrixTraceBuffer(unsigned thread) : head(new Chunk()), tail(head), _thread(thread) {}
+
+    ~MatrixTraceBuffer() {
+        while (head) {
+            Chunk* next = head->next.load(std::memory_order_relaxed);
+            delete head;
+            head = next;
+        }
+    }
+
+    MatrixTraceBuffer(const MatrixTraceBuffer&) = delete;
+    MatrixTraceBuffer& operator=(const MatrixTraceBuffer&) = delete;
+
+    unsigned thread() const { return _thread; }
+    size_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    void record(const MatrixTraceEvent& event) {
+        size_t count = tail->count.load(std::memory_order_relaxed);
+        if (count == Chunk::capacity) {
+            if (chunks == maxChunks) {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            Chunk* chunk = new Chunk();
+            tail->next.store(chunk, std::memory_order_release);
+            tail = chunk;
+            ++chunks;
+            count = 0;
+        }
+        tail->events[count] = event;
+        tail->count.store(count + 1, std::memory_order_release);
+    }
+
+    // Обход опубликованных событий
+    template <typename Visit>
+    void forEach(Visit visit) const {
+        for (const Chunk* chunk = head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+            size_t count = chunk->count.load(std::memory_order_acquire);
+            for (size_t k = 0; k < count; ++k) {
+                visit(chunk->events[k]);
+            }
+        }
+    }
+};
+
+class MatrixTrace {
+private:
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::atomic<bool> _enabled{true};
+    // События раньше этой отметки не попадают в dump() (см. clear())
+    std::atomic<uint64_t> since{0};
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MatrixTraceBuffer>> buffers;
+
+    MatrixTraceBuffer* attach() {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.push_back(std::make_unique<MatrixTraceBuffer>(static_cast<unsigned>(buffers.size() + 1)));
+        return buffers.back().get();
+    }
+
+    // Микросекунды с дробной частью, как требует формат
+    static std::string micros(uint64_t nanoseconds) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(nanoseconds / 1000),
+                      static_cast<unsigned>(nanoseconds % 1000));
+        return text;
+    }
+
+    static void writeEscaped(std::ofstream& out, const char* text) {
+        for (; *text; ++text) {
+            if (*text == '"' || *text == '\\') {
+                out << '\\';
+            }
+            out << *text;
+        }
+    }
+
+public:
+    // Объект не разрушается при завершении программы: потоки пула могут
+    // записывать события, пока уничтожаются статические объекты
+    static MatrixTrace& instance() {
+        static MatrixTrace* trace = new MatrixTrace();
+        return *trace;
+    }
+
+    static bool enabled() {
+        return instance()._enabled.load(std::memory_order_relaxed);
+    }
+
+    static void setEnabled(bool value) {
+        instance()._enabled.store(value, std::memory_order_relaxed);
+    }
+
+    // Наносекунды от начала трассировки
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - instance().epoch).count());
+    }
+
+    static void record(const MatrixTraceEvent& event) {
+        thread_local MatrixTraceBuffer* buffer = instance().attach();
+        buffer->record(event);
+    }
+
+    // Отбрасывание записанных событий; новые события записываются как обычно
+    static void clear() {
+        instance().since.store(now(), std::memory_order_relaxed);
+    }
+
+    // Запись всех событий в файл Chrome trace JSON
+    static void dump(const std::string& filename) {
+        MatrixTrace& trace = instance();
+        std::ofstream outfile(filename);
+        if (!outfile) {
+            throw std::runtime_error("Не удалось открыть файл для записи.");
+        }
+
+        uint64_t from = trace.since.load(std::memory_order_relaxed);
+        size_t dropped = 0;
+        bool first = true;
+        outfile << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        for (const std::unique_ptr<MatrixTraceBuffer>& buffer : trace.buffers) {
+            unsigned thread = buffer->thread();
+            outfile << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread
+                    << ", \"args\": {\"name\": \"thread " << thread << "\"}}";
+            first = false;
+            dropped += buffer->dropped();
+
+            buffer->forEach([&](const MatrixTraceEvent& event) {
+                if (event.begin < from) {
+                    return;
+                }
+                outfile << ",\n{\"name\": \"";
+                writeEscaped(outfile, event.name);
+                outfile << "\", \"cat\": \"matrix\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread
+                        << ", \"ts\": " << micros(event.begin) << ", \"dur\": " << micros(event.end - event.begin)
+                        << ", \"args\": {\"type\": \"";
+                writeEscaped(outfile, event.type);
+                outfile << "\", \"shape\": \"" << event.dims[0] << "x" << event.dims[1];
+                if (event.dims[2] || event.dims[3]) {
+                    outfile << ", " << event.dims[2] << "x" << event.dims[3];
+                }
+                outfile << "\", \"flops\": " << event.flops << ", \"bytes\": " << event.bytes << "}}";
+            });
+        }
+
+        outfile << "\n], \"otherData\": {\"droppedEvents\": " << dropped << "}}\n";
+        outfile.close();
+        if (!outfile) {
+            throw std::runtime_error("Не удалось записать файл.");
+        }
+    }
+};
+
+// Имя типа элементов для событий
+template <typename T>
+const char* matrixTraceType() {
+    if constexpr (std::is_same<T, double>::value) {
+        return "double";
+    } else if constexpr (std::is_same<T, float>::value) {
+        return "float";
+    } else if constexpr (std::is_same<T, long double>::value) {
+        return "long double";
+    } else if constexpr (std::is_same<T, int>::value) {
+        return "int";
+    } else if constexpr (std::is_same<T, unsigned>::value) {
+        return "unsigned";
+    } else if constexpr (std::is_same<T, long>::value) {
+        return "long";
+    } else if constexpr (std::is_same<T, long long>::value) {
+        return "long long";
+    } else {
+        return typeid(T).name();
+    }
+}
+
+// Событие от создания до разрушения объекта
+class MatrixTraceScope {
+private:
+    MatrixTraceEvent event;
+    bool active;
+
+public:
+    MatrixTraceScope(const char* name, const char* type, const MatrixTraceShape& shape, double flops, double bytes)
+        : active(MatrixTrace::enabled()) {
+        if (!active) {
+            return;
+        }
+        event = MatrixTraceEvent{name, type, {shape.dims[0], shape.dims[1], shape.dims[2], shape.dims[3]},
+                                 flops, bytes, MatrixTrace::now(), 0};
+    }
+
+    // Размеры, известные только после начала операции (например, при импорте)
+    void update(const MatrixTraceShape& shape, double flops, double bytes) {
+        std::copy(shape.dims, shape.dims + 4, event.dims);
+        event.flops = flops;
+        event.bytes = bytes;
+    }
+
+    ~MatrixTraceScope() {
+        if (active) {
+            event.end = MatrixTrace::now();
+            MatrixTrace::record(event);
+        }
+    }
+
+    MatrixTraceScope(const MatrixTraceScope&) = delete;
+    MatrixTraceScope& operator=(const MatrixTraceScope&) = delete;
+};
+
+#define MATRIX_TRACE_SCOPE(name, T, shape, flops, bytes) \
+    MatrixTraceScope matrixTraceScope(name, matrixTraceType<T>(), MatrixTraceShape shape, \
+                                      static_cast<double>(flops), static_cast<double>(bytes))
+#define MATRIX_TRACE_UPDATE(shape, flops, bytes) \
+    matrixTraceScope.update(MatrixTraceShape shape, static_cast<double>(flops), static_cast<double>(bytes))
+
+#else
+
+#define MATRIX_TRACE_SCOPE(name, T, shape, flops, bytes) ((void)0)
+#define MATRIX_TRACE_UPDATE(shape, flops, bytes) ((void)0)
+
+#endif
+
+#endif
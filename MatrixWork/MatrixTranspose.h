@@ -0,0 +1,230 @@
+#ifndef MATRIXTRANSPOSE_H
+#define MATRIXTRANSPOSE_H
+
+#include "ThreadPool.h"
+#include "MatrixSimd.h"
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#ifdef MATRIX_SIMD_X86
+
+// Транспонирование микротайла в регистрах: строки src (шаг ls) становятся
+// столбцами dst (шаг ld). Все строки загружаются до первой записи, поэтому
+// src и dst могут совпадать
+MATRIX_SIMD_TARGET("sse2") inline void transposeTile4x4f(const float* src, size_t ls, float* dst, size_t ld) {
+    __m128 r0 = _mm_loadu_ps(src);
+    __m128 r1 = _mm_loadu_ps(src + ls);
+    __m128 r2 = _mm_loadu_ps(src + 2 * ls);
+    __m128 r3 = _mm_loadu_ps(src + 3 * ls);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ld, r1);
+    _mm_storeu_ps(dst + 2 * ld, r2);
+    _mm_storeu_ps(dst + 3 * ld, r3);
+}
+
+MATRIX_SIMD_TARGET("avx2") inline void transposeTile8x8f(const float* src, size_t ls, float* dst, size_t ld) {
+    __m256 r[8], t[8];
+    for (unsigned i = 0; i < 8; ++i) {
+        r[i] = _mm256_loadu_ps(src + i * ls);
+    }
+    // Перестановка пар, четвёрок и половин регистра
+    for (unsigned i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (unsigned i = 0; i < 8; i += 4) {
+        r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (unsigned i = 0; i < 4; ++i) {
+        t[i] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x20);
+        t[i + 4] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x31);
+    }
+    for (unsigned i = 0; i < 8; ++i) {
+        _mm256_storeu_ps(dst + i * ld, t[i]);
+    }
+}
+
+MATRIX_SIMD_TARGET("avx2") inline void transposeTile4x4d(const double* src, size_t ls, double* dst, size_t ld) {
+    __m256d r0 = _mm256_loadu_pd(src);
+    __m256d r1 = _mm256_loadu_pd(src + ls);
+    __m256d r2 = _mm256_loadu_pd(src + 2 * ls);
+    __m256d r3 = _mm256_loadu_pd(src + 3 * ls);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+    __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+    __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ld, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ld, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ld, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+#endif
+
+// Кэш-независимое транспонирование в построчном хранении: B (n x m) = A^T, A - m x n.
+// Матрица рекурсивно делится пополам по большей стороне, пока кусок не станет
+// листом Leaf x Leaf; лист обрабатывается микротайлами в регистрах. Перестановка
+// только битов, поэтому 4- и 8-байтовые типы используют ядра float и double
+template <typename T = double>
+class MatrixTranspose {
+private:
+    static constexpr unsigned Leaf = 32;
+    // Сторона куска, который обрабатывает одна задача пула
+    static constexpr unsigned Task = 256;
+
+    using Micro = void (*)(const T*, size_t, T*, size_t);
+
+#ifdef MATRIX_SIMD_X86
+    static void micro8x8f(const T* src, size_t ls, T* dst, size_t ld) {
+        transposeTile8x8f(reinterpret_cast<const float*>(src), ls, reinterpret_cast<float*>(dst), ld);
+    }
+
+    static void micro4x4f(const T* src, size_t ls, T* dst, size_t ld) {
+        transposeTile4x4f(reinterpret_cast<const float*>(src), ls, reinterpret_cast<float*>(dst), ld);
+    }
+
+    static void micro4x4d(const T* src, size_t ls, T* dst, size_t ld) {
+        transposeTile4x4d(reinterpret_cast<const double*>(src), ls, reinterpret_cast<double*>(dst), ld);
+    }
+#endif
+
+    // Микроядро для типа и процессора; step = 0, если векторного ядра нет
+    static Micro microKernel(unsigned& step) {
+        step = 0;
+#ifdef MATRIX_SIMD_X86
+        if (!std::is_trivially_copyable<T>::value) {
+            return nullptr;
+        }
+        SimdLevel level = MatrixSimd::level();
+        if (sizeof(T) == 4 && level >= SimdLevel::AVX2) {
+            step = 8;
+            return &micro8x8f;
+        }
+        if (sizeof(T) == 4 && level >= SimdLevel::SSE2) {
+            step = 4;
+            return &micro4x4f;
+        }
+        if (sizeof(T) == 8 && level >= SimdLevel::AVX2) {
+            step = 4;
+            return &micro4x4d;
+        }
+#endif
+        return nullptr;
+    }
+
+    static void leaf(unsigned m, unsigned n, const T* A, size_t lda, T* B, size_t ldb, Micro micro, unsigned step) {
+        unsigned mv = step ? m / step * step : 0;
+        unsigned nv = step ? n / step * step : 0;
+        for (unsigned i = 0; i < mv; i += step) {
+            for (unsigned j = 0; j < nv; j += step) {
+                micro(A + i * lda + j, lda, B + j * ldb + i, ldb);
+            }
+        }
+        // Края, не покрытые микротайлами
+        for (unsigned i = 0; i < m; ++i) {
+            for (unsigned j = i < mv ? nv : 0; j < n; ++j) {
+                B[j * ldb + i] = A[i * lda + j];
+            }
+        }
+    }
+
+    static void recurse(unsigned m, unsigned n, const T* A, size_t lda, T* B, size_t ldb, Micro micro, unsigned step) {
+        if (m <= Leaf && n <= Leaf) {
+            leaf(m, n, A, lda, B, ldb, micro, step);
+        } else if (m >= n) {
+            unsigned h = m / 2;
+            recurse(h, n, A, lda, B, ldb, micro, step);
+            recurse(m - h, n, A + h * lda, lda, B + h, ldb, micro, step);
+        } else {
+            unsigned h = n / 2;
+            recurse(m, h, A, lda, B, ldb, micro, step);
+            recurse(m, n - h, A + h, lda, B + h * ldb, ldb, micro, step);
+        }
+    }
+
+    // Обмен X (m x n) и Y (n x m) с транспонированием: X = Y^T, Y = X^T
+    static void swapRecurse(unsigned m, unsigned n, T* X, T* Y, size_t ld, Micro micro, unsigned step) {
+        if (m <= Leaf && n <= Leaf) {
+            T buffer[Leaf * Leaf];
+            leaf(m, n, X, ld, buffer, m, micro, step);
+            leaf(n, m, Y, ld, X, ld, micro, step);
+            for (unsigned j = 0; j < n; ++j) {
+                std::copy(buffer + j * m, buffer + (j + 1) * m, Y + j * ld);
+            }
+        } else if (m >= n) {
+            unsigned h = m / 2;
+            swapRecurse(h, n, X, Y, ld, micro, step);
+            swapRecurse(m - h, n, X + h * ld, Y + h, ld, micro, step);
+        } else {
+            unsigned h = n / 2;
+            swapRecurse(m, h, X, Y, ld, micro, step);
+            swapRecurse(m, n - h, X + h, Y + h * ld, ld, micro, step);
+        }
+    }
+
+    // Транспонирование диагонального квадрата n x n на месте
+    static void inPlaceRecurse(unsigned n, T* A, size_t lda, Micro micro, unsigned step) {
+        if (n <= Leaf) {
+            T buffer[Leaf * Leaf];
+            leaf(n, n, A, lda, buffer, n, micro, step);
+            for (unsigned i = 0; i < n; ++i) {
+                std::copy(buffer + i * n, buffer + (i + 1) * n, A + i * lda);
+            }
+            return;
+        }
+        unsigned h = n / 2;
+        inPlaceRecurse(h, A, lda, micro, step);
+        inPlaceRecurse(n - h, A + h * lda + h, lda, micro, step);
+        swapRecurse(h, n - h, A + h, A + h * lda, lda, micro, step);
+    }
+
+public:
+    static void transpose(unsigned m, unsigned n, const T* A, size_t lda, T* B, size_t ldb) {
+        unsigned step;
+        Micro micro = microKernel(step);
+        unsigned taskRows = (m + Task - 1) / Task;
+        unsigned taskCols = (n + Task - 1) / Task;
+
+        ThreadPool::instance().parallelFor(0, static_cast<size_t>(taskRows) * taskCols, 1, [&](size_t from, size_t to) {
+            for (size_t task = from; task < to; ++task) {
+                unsigned i = static_cast<unsigned>(task / taskCols) * Task;
+                unsigned j = static_cast<unsigned>(task % taskCols) * Task;
+                recurse(std::min(Task, m - i), std::min(Task, n - j), A + i * lda + j, lda, B + j * ldb + i, ldb, micro, step);
+            }
+        });
+    }
+
+    // Транспонирование квадратной матрицы n x n на месте: диагональные куски
+    // транспонируются сами по себе, симметричные пары кусков обмениваются
+    static void transposeInPlace(unsigned n, T* A, size_t lda) {
+        unsigned step;
+        Micro micro = microKernel(step);
+        unsigned tasks = (n + Task - 1) / Task;
+
+        // Задача - пара кусков (I, J), I <= J; пары пронумерованы построчно в верхнем треугольнике
+        ThreadPool::instance().parallelFor(0, static_cast<size_t>(tasks) * (tasks + 1) / 2, 1, [&](size_t from, size_t to) {
+            for (size_t task = from; task < to; ++task) {
+                unsigned I = 0;
+                size_t first = 0;
+                while (first + (tasks - I) <= task) {
+                    first += tasks - I;
+                    ++I;
+                }
+                unsigned J = I + static_cast<unsigned>(task - first);
+                unsigned i = I * Task, j = J * Task;
+                if (I == J) {
+                    inPlaceRecurse(std::min(Task, n - i), A + i * lda + i, lda, micro, step);
+                } else {
+                    swapRecurse(std::min(Task, n - i), std::min(Task, n - j), A + i * lda + j, A + j * lda + i, lda, micro, step);
+                }
+            }
+        });
+    }
+};
+
+#endif
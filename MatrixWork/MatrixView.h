@@ -0,0 +1,366 @@
+#ifndef MATRIXVIEW_H
+#define MATRIXVIEW_H
+
+#include "Matrix.h"
+#include "MatrixDense.h"
+#include "MatrixGemm.h"
+#include "MatrixSimd.h"
+#include "MatrixTranspose.h"
+#include "MatrixText.h"
+#include "MatrixTrace.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+
+// Представление части чужого хранилища без копирования: элемент (i, j) лежит по адресу
+// data + i * rowStride + j * colStride. Подматрица, строка, столбец и диагональ MatrixDense
+// (MatrixDense::view, rowView, columnView, diagonalView) - частные случаи.
+// Представление не владеет памятью: источник должен жить дольше представления, а запись
+// через представление изменяет источник. Копия представления ссылается на те же элементы.
+// При единичном шаге столбцов строки лежат подряд, и операции используют векторные ядра
+// и MatrixGemm с шагом строк как ведущей размерностью
+template <typename T = double>
+class MatrixView : public Matrix<T> {
+private:
+    unsigned _m, _n;
+    T* data;
+    size_t _rowStride, _colStride;
+
+    T* at(unsigned i, unsigned j) const {
+        return data + i * _rowStride + j * _colStride;
+    }
+
+    void checkSize(const Matrix<T>& other, const char* message) const {
+        if (other.rows() != _m || other.cols() != _n) {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    void checkRange(unsigned row, unsigned col, unsigned m, unsigned n) const {
+        if (row > _m || col > _n || m > _m - row || n > _n - col) {
+            throw std::out_of_range("Представление выходит за границы матрицы.");
+        }
+    }
+
+    // out = op(this, other) поэлементно, out - представление того же размера (в том числе само
+    // представление). Перекрывающиеся, но не совпадающие this/other и out дают неопределённый результат
+    template <typename Op>
+    void combine(const Matrix<T>& other, const MatrixView<T>& out, Op op) const {
+        size_t stride = 0;
+        const T* b = rowStorage(other, stride);
+        bool rowwise = b && _colStride == 1 && out._colStride == 1;
+        ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                if (rowwise) {
+                    MatrixSimd::apply(op, at(i, 0), b + i * stride, out.at(i, 0), _n);
+                    continue;
+                }
+                for (unsigned j = 0; j < _n; ++j) {
+                    *out.at(i, j) = op(*at(i, j), b ? b[i * stride + j] : other(i, j));
+                }
+            }
+        });
+    }
+
+    // Представление всего хранилища плотной матрицы
+    static MatrixView<T> whole(MatrixDense<T>& dense) {
+        return MatrixView<T>(dense.rows(), dense.cols(), dense.rawData(), dense.cols());
+    }
+
+public:
+    // Представление m x n над values с шагами строк и столбцов
+    MatrixView(unsigned m, unsigned n, T* values, size_t rowStride, size_t colStride = 1)
+        : _m(m), _n(n), data(values), _rowStride(rowStride), _colStride(colStride) {}
+
+    unsigned rows() const override { return _m; }
+    unsigned cols() const override { return _n; }
+
+    MatrixKind kind() const override { return MatrixKind::View; }
+
+    // Первый элемент и шаги для передачи в ядра (MatrixGemm, MatrixTranspose, MatrixSimd)
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+    size_t rowStride() const { return _rowStride; }
+    size_t colStride() const { return _colStride; }
+
+    // Лежат ли все элементы подряд построчно, как в MatrixDense того же размера
+    bool isContiguous() const {
+        return (_colStride == 1 || _n <= 1) && (_rowStride == _n || _m <= 1);
+    }
+
+    // Построчное хранилище matrix и шаг его строк, если элементы каждой строки лежат подряд
+    // (плотная матрица или представление с единичным шагом столбцов); иначе nullptr
+    static const T* rowStorage(const Matrix<T>& matrix, size_t& stride) {
+        if (matrix.kind() == MatrixKind::Dense) {
+            const MatrixDense<T>& dense = static_cast<const MatrixDense<T>&>(matrix);
+            stride = dense.cols();
+            return dense.rawData();
+        }
+        if (matrix.kind() == MatrixKind::View) {
+            const MatrixView<T>& view = static_cast<const MatrixView<T>&>(matrix);
+            if (view._colStride == 1 || view._n <= 1) {
+                stride = view._rowStride;
+                return view.data;
+            }
+        }
+        return nullptr;
+    }
+
+    // Доступ к элементам
+    T& operator()(unsigned i, unsigned j) {
+        return *at(i, j);
+    }
+
+    T operator()(unsigned i, unsigned j) const override {
+        return *at(i, j);
+    }
+
+    // Вложенные представления: подматрица m x n с углом (row, col), строка, столбец
+    // и главная диагональ (столбец из min(rows, cols) элементов); у константного
+    // представления - только для чтения
+    MatrixView<T> view(unsigned row, unsigned col, unsigned m, unsigned n) {
+        checkRange(row, col, m, n);
+        return MatrixView<T>(m, n, at(row, col), _rowStride, _colStride);
+    }
+
+    const MatrixView<T> view(unsigned row, unsigned col, unsigned m, unsigned n) const {
+        return const_cast<MatrixView<T>*>(this)->view(row, col, m, n);
+    }
+
+    MatrixView<T> rowView(unsigned i) {
+        return view(i, 0, 1, _n);
+    }
+
+    const MatrixView<T> rowView(unsigned i) const {
+        return view(i, 0, 1, _n);
+    }
+
+    MatrixView<T> columnView(unsigned j) {
+        checkRange(0, j, _m, 1);
+        return MatrixView<T>(_m, 1, at(0, j), _rowStride);
+    }
+
+    const MatrixView<T> columnView(unsigned j) const {
+        return const_cast<MatrixView<T>*>(this)->columnView(j);
+    }
+
+    MatrixView<T> diagonalView() {
+        return MatrixView<T>(std::min(_m, _n), 1, data, _rowStride + _colStride);
+    }
+
+    const MatrixView<T> diagonalView() const {
+        return const_cast<MatrixView<T>*>(this)->diagonalView();
+    }
+
+    // Копирование элементов other того же размера в представление
+    void assign(const Matrix<T>& other) {
+        checkSize(other, "Размеры матриц должны совпадать для присваивания.");
+        combine(other, *this, [](T, T b) { return b; });
+    }
+
+    void fill(T value) {
+        for (unsigned i = 0; i < _m; ++i) {
+            for (unsigned j = 0; j < _n; ++j) {
+                *at(i, j) = value;
+            }
+        }
+    }
+
+    // Копия элементов в новую плотную матрицу
+    MatrixDense<T>* materialize() const {
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        whole(*result).assign(*this);
+        return result;
+    }
+
+    // this = alpha * A * B + beta * this: произведение сразу в участок матрицы без промежуточной
+    // копии; при beta == 0 прежнее содержимое не читается. this не должно перекрываться с A и B
+    void gemm(T alpha, const Matrix<T>& A, const Matrix<T>& B, T beta = T(1)) {
+        MATRIX_TRACE_SCOPE("MatrixView::gemm", T, (A.rows(), A.cols(), B.rows(), B.cols()), 2.0 * A.rows() * A.cols() * B.cols(),
+                           sizeof(T) * (1.0 * A.rows() * A.cols() + 1.0 * B.rows() * B.cols() + 2.0 * rows() * cols()));
+        if (A.cols() != B.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        if (A.rows() != _m || B.cols() != _n) {
+            throw std::invalid_argument("Размеры матрицы результата не совпадают с размерами результата операции.");
+        }
+
+        size_t lda = 0, ldb = 0;
+        const T* a = rowStorage(A, lda);
+        const T* b = rowStorage(B, ldb);
+        if (a && b && _colStride == 1) {
+            MatrixGemm<T>::multiply(_m, _n, A.cols(), alpha, a, static_cast<unsigned>(lda), b, static_cast<unsigned>(ldb),
+                                    beta, data, static_cast<unsigned>(_rowStride));
+            return;
+        }
+
+        unsigned inner = A.cols();
+        ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(static_cast<size_t>(inner) * _n), [&](size_t from, size_t to) {
+            for (unsigned i = static_cast<unsigned>(from); i < to; ++i) {
+                for (unsigned j = 0; j < _n; ++j) {
+                    T sum = T();
+                    for (unsigned k = 0; k < inner; ++k) {
+                        sum += A(i, k) * B(k, j);
+                    }
+                    T* c = at(i, j);
+                    *c = beta == T() ? alpha * sum : alpha * sum + beta * *c;
+                }
+            }
+        });
+    }
+
+    // Операции с матрицами; изменяющие операции пишут в источник представления,
+    // результаты остальных - новые плотные матрицы
+    Matrix<T>& operator+=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixView::operator+=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        combine(other, *this, MatrixSimdAdd());
+        return *this;
+    }
+
+    Matrix<T>& operator-=(const Matrix<T>& other) override {
+        MATRIX_TRACE_SCOPE("MatrixView::operator-=", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        combine(other, *this, MatrixSimdSub());
+        return *this;
+    }
+
+    // Оператор сложения
+    Matrix<T>* operator+(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::operator+", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для сложения.");
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, whole(*result), MatrixSimdAdd());
+        return result;
+    }
+
+    // Оператор вычитания
+    Matrix<T>* operator-(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::operator-", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для вычитания.");
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, whole(*result), MatrixSimdSub());
+        return result;
+    }
+
+    // Матричное умножение
+    Matrix<T>* operator*(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::operator*", T, (rows(), cols(), other.rows(), other.cols()), 2.0 * rows() * cols() * other.cols(),
+                           sizeof(T) * (1.0 * rows() * cols() + 1.0 * other.rows() * other.cols() + 1.0 * rows() * other.cols()));
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, other.cols(), MatrixUninitialized());
+        whole(*result).gemm(T(1), *this, other, T());
+        return result;
+    }
+
+    // Почленное умножение
+    Matrix<T>* elemMult(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::elemMult", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для почленного умножения.");
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, whole(*result), MatrixSimdMul());
+        return result;
+    }
+
+    // Почленное деление
+    Matrix<T>* elemDiv(const Matrix<T>& other) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::elemDiv", T, (rows(), cols(), other.rows(), other.cols()), 1.0 * rows() * cols(), 3.0 * sizeof(T) * rows() * cols());
+        checkSize(other, "Размеры матриц должны совпадать для почленного деления.");
+        if (hasZeroElement(other)) {
+            throw std::runtime_error("Деление на ноль при почленном делении матриц.");
+        }
+        MatrixDense<T>* result = new MatrixDense<T>(_m, _n, MatrixUninitialized());
+        combine(other, whole(*result), MatrixSimdDiv());
+        return result;
+    }
+
+    // Транспонирование
+    MatrixDense<T>* transpose() const override {
+        MATRIX_TRACE_SCOPE("MatrixView::transpose", T, (rows(), cols()), 0, 2.0 * sizeof(T) * rows() * cols());
+        MatrixDense<T>* result = new MatrixDense<T>(_n, _m, MatrixUninitialized());
+        transposeInto(*result);
+        return result;
+    }
+
+    // out = alpha * this * other + beta * out через gemm над всем out
+    void multiplyInto(const Matrix<T>& other, MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        if (_n != other.rows()) {
+            throw std::invalid_argument("Внутренние размеры матриц должны совпадать для умножения.");
+        }
+        this->checkInto(other, out, _m, other.cols(), true);
+        whole(out).gemm(alpha, *this, other, beta);
+    }
+
+    void transposeInto(MatrixDense<T>& out, T alpha = T(1), T beta = T()) const override {
+        this->checkInto(*this, out, _n, _m, true);
+        if (alpha != T(1) || beta != T()) {
+            Matrix<T>::transposeInto(out, alpha, beta);
+        } else if (_colStride == 1) {
+            MatrixTranspose<T>::transpose(_m, _n, data, _rowStride, out.rawData(), _m);
+        } else {
+            // Представление с переставленными шагами - транспонированная матрица без копирования
+            whole(out).assign(MatrixView<T>(_n, _m, data, _colStride, _rowStride));
+        }
+    }
+
+    // y = alpha * A * x + beta * y; строки с единичным шагом - векторным скалярным произведением
+    void gemv(T alpha, const Vector<T>& x, T beta, Vector<T>& y) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::gemv", T, (rows(), cols(), x.size(), 1), 2.0 * rows() * cols(), sizeof(T) * (1.0 * rows() * cols() + x.size() + 2.0 * y.size()));
+        this->checkGemv(x, y);
+        if (_colStride != 1) {
+            Matrix<T>::gemv(alpha, x, beta, y);
+            return;
+        }
+        const T* xs = x.rawData();
+        T* ys = y.rawData();
+        ThreadPool::instance().parallelFor(0, _m, ThreadPool::rowGrain(_n), [&](size_t from, size_t to) {
+            for (size_t i = from; i < to; ++i) {
+                T sum = alpha * MatrixSimd::dot(data + i * _rowStride, xs, _n);
+                ys[i] = beta == T() ? sum : sum + beta * ys[i];
+            }
+        });
+    }
+
+    // Импорт из файла формата MatrixDense в элементы источника; размеры должны совпадать
+    void importFromFile(const std::string& filename) override {
+        MATRIX_TRACE_SCOPE("MatrixView::importFromFile", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        MatrixDense<T> loaded(0, 0);
+        loaded.importFromFile(filename);
+        if (loaded.rows() != _m || loaded.cols() != _n) {
+            throw std::runtime_error("Размеры матрицы в файле не совпадают с размерами представления.");
+        }
+        assign(loaded);
+    }
+
+    // Экспорт в файл формата MatrixDense
+    void exportToFile(const std::string& filename) const override {
+        MATRIX_TRACE_SCOPE("MatrixView::exportToFile", T, (rows(), cols()), 0, sizeof(T) * rows() * cols());
+        MatrixTextWriter writer(filename);
+
+        writer.text("MatrixDense\n" + std::to_string(_m) + " " + std::to_string(_n) + "\n");
+        writer.units(_m, static_cast<size_t>(_n) * 14 + 1, [this](size_t i, std::string& buffer) {
+            for (unsigned j = 0; j < _n; ++j) {
+                MatrixTextValue::append(buffer, *at(static_cast<unsigned>(i), j));
+            }
+            buffer += '\n';
+        });
+
+        writer.close();
+    }
+
+    // Метод для печати матрицы
+    void print(std::ostream& os = std::cout) const override {
+        for (unsigned i = 0; i < _m; ++i) {
+            for (unsigned j = 0; j < _n; ++j) {
+                os << *at(i, j) << "\t";
+            }
+            os << "\n";
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include "ThreadPool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <exception>
+#include <initializer_list>
+
+// Планировщик задач с перехватом работы (work stealing) для неравномерной работы:
+// блочных операций с разной заполненностью строк и рекурсивных ядер.
+// У каждого потока своя очередь: свои задачи берутся с конца (последняя порождённая),
+// свободные потоки забирают самые старые задачи из начала чужих очередей.
+// Задачи группируются в TaskGroup (spawn/sync) и могут зависеть от других задач.
+// Число потоков совпадает с размером ThreadPool; внутри задач parallelFor пула
+// выполняется последовательно, распределением занимается планировщик.
+
+class TaskGroup;
+
+struct TaskNode {
+    std::function<void()> body;
+    TaskGroup* group = nullptr;
+    // Незавершённые предшественники и одна ссылка, снимаемая после регистрации в spawn
+    std::atomic<unsigned> waiting{1};
+    std::mutex mutex;
+    bool finished = false;
+    std::vector<std::shared_ptr<TaskNode>> successors;
+};
+
+// Задача, от которой могут зависеть другие задачи той же группы
+using TaskHandle = std::shared_ptr<TaskNode>;
+
+class TaskScheduler {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<TaskHandle> tasks;
+    };
+
+    // queues[0..workers) - очереди рабочих потоков, последняя - для задач из остальных потоков
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> inFlight{0};
+    std::atomic<unsigned> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::mutex resizeMutex;
+    unsigned _threads = 0;
+
+    // Номер очереди текущего потока; -1 для потоков вне планировщика
+    static int& workerIndex() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    void start(unsigned threads) {
+        _threads = threads == 0 ? 1 : threads;
+        stopping = false;
+        // Вызывающий поток выполняет задачи в sync(), поэтому рабочих на один меньше
+        for (unsigned t = 0; t < _threads; ++t) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (unsigned t = 0; t + 1 < _threads; ++t) {
+            workers.emplace_back([this, t] { workerLoop(static_cast<int>(t)); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        queues.clear();
+    }
+
+    Queue& injection() {
+        return *queues.back();
+    }
+
+    TaskHandle popBack(Queue& queue) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return nullptr;
+        }
+        TaskHandle task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return task;
+    }
+
+    TaskHandle popFront(Queue& queue) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return nullptr;
+        }
+        TaskHandle task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return task;
+    }
+
+    // Своя очередь, затем общая, затем перехват у других потоков начиная со случайного
+    TaskHandle find(int self) {
+        if (queued.load() == 0) {
+            return nullptr;
+        }
+        TaskHandle task;
+        if (self >= 0) {
+            task = popBack(*queues[self]);
+        }
+        if (!task) {
+            task = popFront(injection());
+        }
+        if (!task) {
+            thread_local unsigned seed = 0x9e3779b9u ^ static_cast<unsigned>(self + 1);
+            seed = seed * 1664525u + 1013904223u;
+            size_t victims = queues.size() - 1;
+            for (size_t k = 0; k < victims && !task; ++k) {
+                size_t victim = (seed + k) % victims;
+                if (static_cast<int>(victim) != self) {
+                    task = popFront(*queues[victim]);
+                }
+            }
+        }
+        if (task) {
+            queued.fetch_sub(1);
+        }
+        return task;
+    }
+
+    void workerLoop(int index) {
+        workerIndex() = index;
+        ThreadPool::SerialScope serial;
+        for (;;) {
+            if (TaskHandle task = find(index)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            wake.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+            sleeping.fetch_sub(1);
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    void push(TaskHandle task);
+    void execute(const TaskHandle& task);
+
+    friend class TaskGroup;
+
+public:
+    TaskScheduler() {
+        start(ThreadPool::instance().size());
+    }
+
+    ~TaskScheduler() {
+        stop();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    static TaskScheduler& instance() {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    unsigned size() const { return _threads; }
+
+    // Приведение числа потоков к размеру ThreadPool; выполняется только
+    // вне задач, когда ни одна задача не выполняется
+    void synchronizeSize() {
+        unsigned threads = ThreadPool::instance().size();
+        if (threads == _threads || workerIndex() >= 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(resizeMutex);
+        if (threads != _threads && inFlight.load() == 0) {
+            stop();
+            start(threads);
+        }
+    }
+
+    // Параллельный цикл по [begin, end): диапазон рекурсивно делится пополам до grain,
+    // половины становятся задачами, и свободные потоки забирают их. В отличие от
+    // ThreadPool::parallelFor, стоимость итераций может сильно различаться
+    template <typename Body>
+    static void parallelFor(size_t begin, size_t end, size_t grain, const Body& body);
+};
+
+class TaskGroup {
+private:
+    TaskScheduler& scheduler;
+    std::atomic<size_t> pending{0};
+    std::atomic<bool> _failed{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    friend class TaskScheduler;
+
+    void fail(std::exception_ptr exception) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+            error = exception;
+        }
+        _failed = true;
+    }
+
+    // Ожидание всех задач группы; ожидающий поток сам выполняет задачи
+    void wait() {
+        int self = TaskScheduler::workerIndex();
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (TaskHandle task = scheduler.find(self)) {
+                scheduler.execute(task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    TaskGroup() : scheduler(TaskScheduler::instance()) {
+        scheduler.synchronizeSize();
+    }
+
+    // Задачи ссылаются на группу, поэтому группа дожидается их и при исключении
+    ~TaskGroup() {
+        wait();
+    }
+
+    // Данные, которые используют задачи, должны быть объявлены до группы
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Признак исключения в одной из задач; задачи, не начавшиеся до него, не выполняются
+    bool failed() const { return _failed.load(); }
+
+    // Задача body, начинающаяся после завершения всех задач after
+    template <typename Body>
+    TaskHandle spawn(Body&& body, std::initializer_list<TaskHandle> after = {}) {
+        return spawnAfter(std::forward<Body>(body), after.begin(), after.end());
+    }
+
+    template <typename Body>
+    TaskHandle spawn(Body&& body, const std::vector<TaskHandle>& after) {
+        return spawnAfter(std::forward<Body>(body), after.data(), after.data() + after.size());
+    }
+
+    // Ожидание всех порождённых задач; первое исключение задачи пробрасывается
+    void sync() {
+        wait();
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            std::swap(exception, error);
+            _failed = false;
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+
+private:
+    template <typename Body>
+    TaskHandle spawnAfter(Body&& body, const TaskHandle* first, const TaskHandle* last) {
+        TaskHandle task = std::make_shared<TaskNode>();
+        task->body = std::forward<Body>(body);
+        task->group = this;
+        pending.fetch_add(1);
+        scheduler.inFlight.fetch_add(1);
+        for (const TaskHandle* dependency = first; dependency != last; ++dependency) {
+            if (!*dependency) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock((*dependency)->mutex);
+            if (!(*dependency)->finished) {
+                task->waiting.fetch_add(1);
+                (*dependency)->successors.push_back(task);
+            }
+        }
+        if (task->waiting.fetch_sub(1) == 1) {
+            scheduler.push(task);
+        }
+        return task;
+    }
+};
+
+inline void TaskScheduler::push(TaskHandle task) {
+    int self = workerIndex();
+    Queue& queue = self >= 0 ? *queues[self] : injection();
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+inline void TaskScheduler::execute(const TaskHandle& task) {
+    TaskGroup* group = task->group;
+    if (!group->failed()) {
+        ThreadPool::SerialScope serial;
+        try {
+            task->body();
+        } catch (...) {
+            group->fail(std::current_exception());
+        }
+    }
+    task->body = nullptr;
+
+    std::vector<TaskHandle> ready;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->finished = true;
+        ready.swap(task->successors);
+    }
+    for (TaskHandle& successor : ready) {
+        if (successor->waiting.fetch_sub(1) == 1) {
+            push(std::move(successor));
+        }
+    }
+
+    // Последнее обращение к группе: после него sync() может завершиться
+    inFlight.fetch_sub(1);
+    group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+template <typename Body>
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain, const Body& body) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    if (end - begin <= grain || ThreadPool::instance().size() == 1) {
+        body(begin, end);
+        return;
+    }
+
+    ThreadPool::SerialScope serial;
+    TaskGroup group;
+    std::function<void(size_t, size_t)> split = [&](size_t from, size_t to) {
+        while (to - from > grain) {
+            size_t middle = from + (to - from) / 2;
+            group.spawn([&split, middle, to] { split(middle, to); });
+            to = middle;
+        }
+        body(from, to);
+    };
+    try {
+        split(begin, end);
+    } catch (...) {
+        // Порождённые задачи ссылаются на split, поэтому сначала дожидаемся их
+        group.fail(std::current_exception());
+    }
+    group.sync();
+}
+
+#endif
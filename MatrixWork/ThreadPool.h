@@ -0,0 +1,209 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+// Общий пул потоков для параллельных операций над матрицами
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    bool stopping = false;
+    unsigned _threads = 1;
+
+    // Признак того, что текущий поток уже выполняет часть параллельной операции:
+    // вложенные parallelFor в этом случае выполняются последовательно
+    static bool& insideParallel() {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void start(unsigned threads) {
+        _threads = threads == 0 ? 1 : threads;
+        stopping = false;
+        // Вызывающий поток тоже участвует в parallelFor, поэтому рабочих на один меньше
+        for (unsigned t = 1; t < _threads; ++t) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+        queueCondition.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void workerLoop() {
+        insideParallel() = true;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    static unsigned defaultThreads() {
+        unsigned hardware = std::thread::hardware_concurrency();
+        return hardware == 0 ? 1 : hardware;
+    }
+
+public:
+    // Размер пула - общее число потоков, включая вызывающий; 0 - hardware_concurrency
+    explicit ThreadPool(unsigned threads = 0) {
+        start(threads == 0 ? defaultThreads() : threads);
+    }
+
+    ~ThreadPool() {
+        stop();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return _threads; }
+
+    // На время жизни объекта parallelFor в текущем потоке выполняется последовательно:
+    // для кода, который распределяет работу по потокам сам (см. TaskScheduler)
+    class SerialScope {
+    private:
+        bool previous;
+
+    public:
+        SerialScope() : previous(insideParallel()) { insideParallel() = true; }
+        ~SerialScope() { insideParallel() = previous; }
+
+        SerialScope(const SerialScope&) = delete;
+        SerialScope& operator=(const SerialScope&) = delete;
+    };
+
+    // Изменение размера пула; не должно вызываться во время выполнения операций
+    void resize(unsigned threads) {
+        stop();
+        start(threads == 0 ? defaultThreads() : threads);
+    }
+
+    // Постановка задачи в очередь
+    void submit(std::function<void()> task) {
+        if (workers.empty()) {
+            task();
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.push_back(std::move(task));
+        }
+        queueCondition.notify_one();
+    }
+
+    // Разбиение диапазона [begin, end) на отрезки не короче grain и их параллельная обработка;
+    // body(from, to) вызывается для каждого отрезка, первое исключение пробрасывается вызывающему
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body&& body) {
+        if (begin >= end) {
+            return;
+        }
+        size_t count = end - begin;
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = std::min<size_t>((count + grain - 1) / grain, static_cast<size_t>(_threads) * 4);
+
+        if (chunks <= 1 || workers.empty() || insideParallel()) {
+            body(begin, end);
+            return;
+        }
+
+        struct State {
+            std::atomic<size_t> next{0};
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t pendingHelpers = 0;
+            std::exception_ptr error;
+        } state;
+
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        auto runChunks = [&]() {
+            for (;;) {
+                size_t chunk = state.next.fetch_add(1);
+                if (chunk >= chunks) {
+                    break;
+                }
+                size_t from = begin + chunk * chunkSize;
+                size_t to = std::min(end, from + chunkSize);
+                if (from >= to) {
+                    continue;
+                }
+                try {
+                    body(from, to);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state.mutex);
+                    if (!state.error) {
+                        state.error = std::current_exception();
+                    }
+                    state.next.store(chunks);
+                }
+            }
+        };
+
+        size_t helpers = std::min<size_t>(workers.size(), chunks - 1);
+        state.pendingHelpers = helpers;
+        for (size_t h = 0; h < helpers; ++h) {
+            submit([&state, &runChunks]() {
+                runChunks();
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (--state.pendingHelpers == 0) {
+                    state.done.notify_one();
+                }
+            });
+        }
+
+        insideParallel() = true;
+        runChunks();
+        insideParallel() = false;
+
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.done.wait(lock, [&state] { return state.pendingHelpers == 0; });
+        if (state.error) {
+            std::rethrow_exception(state.error);
+        }
+    }
+
+    // Число строк на отрезок, чтобы на один поток приходилось не меньше minElements элементов
+    static size_t rowGrain(size_t cols, size_t minElements = 32768) {
+        return std::max<size_t>(1, minElements / std::max<size_t>(cols, 1));
+    }
+
+    // Общий пул, используемый всеми матричными операциями
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static void setThreadCount(unsigned threads) {
+        instance().resize(threads);
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include "MatrixAllocator.h"
+#include <iostream>
+#include <vector>
+#include <initializer_list>
+#include <algorithm>
+
+// Плотный вектор-столбец для умножения матрицы на вектор (Matrix<T>::gemv).
+// Хранилище берётся из того же пула, что и у MatrixDense
+template <typename T = double>
+class Vector {
+private:
+    unsigned _n;
+    T* data;
+
+public:
+    // Конструктор (элементы обнуляются)
+    explicit Vector(unsigned n = 0) : _n(n) {
+        data = MatrixStorage<T>::allocate(_n);
+    }
+
+    Vector(unsigned n, T value) : _n(n) {
+        data = MatrixStorage<T>::allocate(_n, false);
+        std::fill(data, data + _n, value);
+    }
+
+    Vector(std::initializer_list<T> values) : _n(static_cast<unsigned>(values.size())) {
+        data = MatrixStorage<T>::allocate(_n, false);
+        std::copy(values.begin(), values.end(), data);
+    }
+
+    explicit Vector(const std::vector<T>& values) : _n(static_cast<unsigned>(values.size())) {
+        data = MatrixStorage<T>::allocate(_n, false);
+        std::copy(values.begin(), values.end(), data);
+    }
+
+    // Конструктор копирования
+    Vector(const Vector<T>& other) : _n(other._n) {
+        data = MatrixStorage<T>::allocate(_n, false);
+        std::copy(other.data, other.data + _n, data);
+    }
+
+    // Конструктор перемещения
+    Vector(Vector<T>&& other) noexcept : _n(other._n), data(other.data) {
+        other.data = nullptr;
+        other._n = 0;
+    }
+
+    // Деструктор
+    ~Vector() {
+        MatrixStorage<T>::deallocate(data, _n);
+    }
+
+    // Оператор присваивания
+    Vector<T>& operator=(const Vector<T>& other) {
+        if (this != &other) {
+            if (_n != other._n) {
+                MatrixStorage<T>::deallocate(data, _n);
+                _n = other._n;
+                data = MatrixStorage<T>::allocate(_n, false);
+            }
+            std::copy(other.data, other.data + _n, data);
+        }
+        return *this;
+    }
+
+    // Оператор перемещающего присваивания
+    Vector<T>& operator=(Vector<T>&& other) noexcept {
+        if (this != &other) {
+            MatrixStorage<T>::deallocate(data, _n);
+            _n = other._n;
+            data = other.data;
+            other.data = nullptr;
+            other._n = 0;
+        }
+        return *this;
+    }
+
+    unsigned size() const { return _n; }
+
+    // Непосредственный доступ к хранилищу
+    T* rawData() { return data; }
+    const T* rawData() const { return data; }
+
+    // Доступ к элементам
+    T& operator[](unsigned i) { return data[i]; }
+    T operator[](unsigned i) const { return data[i]; }
+
+    // Метод для печати вектора (в одну строку)
+    void print(std::ostream& os = std::cout) const {
+        for (unsigned i = 0; i < _n; ++i) {
+            os << data[i] << "\t";
+        }
+        os << "\n";
+    }
+};
+
+#endif
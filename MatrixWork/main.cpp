@@ -1,6 +1,7 @@
 #include "MatrixDense.h"
 #include "MatrixDiagonal.h"
 #include "MatrixBlock.h"
+#include "MatrixFixed.h"
 #include <iostream>
 #include <fstream>
 #include <random>
@@ -131,10 +132,10 @@ int main() {
         MatrixBlock<int> B1(5, 5, 2, 2); // 5x5 блоков, каждый размером 2x2
         for (unsigned i = 0; i < 5; ++i) {
             for (unsigned j = 0; j < 5; ++j) {
-                auto block = std::make_shared<MatrixDense<int>>(2, 2);
+                MatrixFixed<int, 2, 2> block;
                 for (unsigned m = 0; m < 2; ++m) {
                     for (unsigned n = 0; n < 2; ++n) {
-                        block->operator()(m, n) = dis(gen);
+                        block(m, n) = dis(gen);
                     }
                 }
                 B1.setBlock(i, j, block);
@@ -145,10 +146,10 @@ int main() {
         MatrixBlock<int> B2(5, 5, 2, 2); // 5x5 блоков, каждый размером 2x2
         for (unsigned i = 0; i < 5; ++i) {
             for (unsigned j = 0; j < 5; ++j) {
-                auto block = std::make_shared<MatrixDense<int>>(2, 2);
+                MatrixFixed<int, 2, 2> block;
                 for (unsigned m = 0; m < 2; ++m) {
                     for (unsigned n = 0; n < 2; ++n) {
-                        block->operator()(m, n) = dis(gen);
+                        block(m, n) = dis(gen);
                     }
                 }
                 B2.setBlock(i, j, block);